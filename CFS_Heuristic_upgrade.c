@@ -15,23 +15,218 @@
 #include <math.h>
 #include <limits.h>
 #include <sys/time.h>
+#include <sys/timerfd.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <linux/ioprio.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <pthread.h>
 
-#define MAX_PROCESSES 10
+#include "cfs_model.h"        // generated by train_model.py
+#include "cfs_trace.h"        // binary trace format (-T)
+#include "cfs_stats.h"        // shared-memory stats page (-K)
+#include "cfs_ring.h"         // snapshot ring file (-Y)
+#include "cfs_arrow.h"        // columnar results (-o)
+#include "cfs_workload.h"     // binary workload format (-f)
+
+#if defined(CFS_PROFILE) && (defined(__x86_64__) || defined(__i386__))
+#include <x86intrin.h>
+#endif
+
+/* usdt probes (provider "cfs") for perf and bpftrace, three signed 64-bit
+   arguments each: task id, vruntime (ns) and an event-specific value. an
+   unattached probe is a single nop. sys/sdt.h is used when installed; on
+   x86-64 without it the same .note.stapsdt records are emitted here, and
+   elsewhere the probes compile to nothing. -DCFS_NO_PROBES drops them */
+#if !defined(CFS_NO_PROBES) && defined(__has_include)
+#if __has_include(<sys/sdt.h>)
+#include <sys/sdt.h>
+#define CFS_PROBE3(name, a, b, c) STAP_PROBE3(cfs, name, (long)(a), (long)(b), (long)(c))
+#endif
+#endif
+
+#if !defined(CFS_PROBE3) && !defined(CFS_NO_PROBES) && defined(__x86_64__)
+#define CFS_PROBE3(name, a, b, c)                                                    \
+    __asm__ __volatile__("990: nop\n"                                               \
+                         ".pushsection .note.stapsdt,\"?\",\"note\"\n"              \
+                         ".balign 4\n"                                              \
+                         ".4byte 992f-991f, 994f-993f, 3\n"                         \
+                         "991: .asciz \"stapsdt\"\n"                                \
+                         "992: .balign 4\n"                                         \
+                         "993: .8byte 990b\n"                                       \
+                         ".8byte _.stapsdt.base\n"                                  \
+                         ".8byte 0\n"                                               \
+                         ".asciz \"cfs\"\n"                                         \
+                         ".asciz \"" #name "\"\n"                                    \
+                         ".asciz \"-8@%0 -8@%1 -8@%2\"\n"                            \
+                         "994: .balign 4\n"                                         \
+                         ".popsection\n"                                            \
+                         ".ifndef _.stapsdt.base\n"                                 \
+                         ".pushsection .stapsdt.base,\"aG\",\"progbits\",.stapsdt.base,comdat\n" \
+                         ".weak _.stapsdt.base\n"                                   \
+                         ".hidden _.stapsdt.base\n"                                 \
+                         "_.stapsdt.base: .space 1\n"                               \
+                         ".size _.stapsdt.base, 1\n"                                \
+                         ".popsection\n"                                            \
+                         ".endif\n"                                                 \
+                         :: "nor"((long)(a)), "nor"((long)(b)), "nor"((long)(c)))
+#endif
+
+#ifndef CFS_PROBE3
+#define CFS_PROBE3(name, a, b, c) ((void)0)
+#endif
+
+#define MAX_PROCESSES 64
 #define TIME_QUANTUM_MS 10
 #define MIN_GRANULARITY_MS 5
 #define SCHEDULER_TICK_US 1000
 #define CFS_WEIGHT_NICE_0 1024
 #define MAX_WAIT_THRESHOLD_MS 100
 #define INTERACTIVE_THRESHOLD_MS 50
+#define CRITICAL_PATH_BIAS_NS 1000000LL  // score bonus per ms of predicted downstream DAG path
+#define CRITICAL_PATH_MAX_BIAS_NS (2LL * TIME_QUANTUM_MS * 1000000)  // never more than two quanta ahead
+#define MAX_LINE_LEN 512
+
+// slo feedback control
+#define SLO_WINDOW 64                    // latency samples kept per task
+#define SLO_HIST_BUCKETS 128             // 1 ms buckets, last one catches overflow
+#define SLO_CONTROL_PERIOD_MS 20
+#define SLO_KP 20                        // per-mille weight change per ms of error
+#define SLO_KI 4                         // per-mille per accumulated ms of error
+#define SLO_INTEGRAL_LIMIT 200           // anti-windup clamp (ms)
+#define SLO_MAX_STEP_PERMILLE 250        // at most +/-25% weight change per period
+
+// decayed historical fair share
+#define MAX_GROUPS 16
+#define GROUP_NAME_LEN 32
+#define FAIRSHARE_HALF_LIFE_S 3600.0
+#define FAIRSHARE_MAX_DEBIT_NS 50000000LL    // start debit for a group far over its share
+#define FAIRSHARE_MIN_WEIGHT_PERMILLE 250    // over-share groups keep at least 25% weight
+
+// placement of new and waking tasks
+#define SCHED_LATENCY_MS 20
+#define SLEEPER_CREDIT_NS (SCHED_LATENCY_MS * 1000000LL / 2)
+
+// learned scoring model (-L), see cfs_model.h
+#define MODEL_BUDGET_NS 50               // max inference cost per candidate, unoptimized build
+#define MODEL_BENCH_ROUNDS 200000
+
+// per-task quantum bandit (-A)
+#define QUANTUM_ARMS 4                   // 1/2, 1, 2 and 4x TIME_QUANTUM_MS
+#define BANDIT_CONTEXTS 2                // latency-sensitive tasks present or not
+#define BANDIT_EXPLORE 0.3
+#define BANDIT_LATENCY_COST 1.0          // reward lost per sched latency a sensitive task waits
+#define WARM_GAP_MS 1                    // child: resumed after this long = switched out
+
+// shadow policy evaluation (-S)
+#define SHADOW_RING_SIZE 4096            // events, power of two
+#define SHADOW_IDLE_US 500               // consumer poll interval when the ring is empty
+
+// regime-switching meta-scheduler (-M)
+#define MAX_POLICIES 8
+#define REGIME_WINDOW_MS 250             // arrivals considered by the classifier
+#define REGIME_PERIOD_MS 25
+#define REGIME_HOLD 2                    // consecutive votes needed to switch
+#define REGIME_INTERACTIVE_PCT 40        // interactive share of live tasks -> rr
+#define REGIME_SIZE_CV 0.75              // burst-size variation -> srtf
+#define REGIME_MIN_ARRIVALS 2
+#define REGIME_LOG 32
+
+// bounded-wait guarantee (-W)
+#define WATCHDOG_MARGIN_PCT 75           // force a dispatch once a wait reaches this share of the bound
+#define WATCHDOG_TICKS 8                 // timer periods per bound
+#define WAIT_BANDS 10                    // dispatch waits reported in 10% bands of the bound
+
+// slice extension for workers inside a critical section (-X)
+#define SLICE_EXT_MS 2                   // extra cpu granted at slice expiry
+#define SLICE_EXT_POLL_US 100
+#define SLICE_EXT_BUDGET_PCT 10          // extensions may add at most this share of the burst
+#define SLICE_EXT_MAX_OVERRUNS 3         // extensions run out while still holding -> revoked
+
+// real disk i/o in the sleep phase (disk=) and i/o priority coordination (-I)
+#define DISK_DIR "."                     // scratch files, unlinked right after open
+#define DISK_CHUNK_KB 64
+#define DISK_POLL_US 200
+
+// memory-pressure control (-R): psi trigger, per-task rss and major faults
+#define PSI_MEMORY_PATH "/proc/pressure/memory"
+#define PSI_CPU_PATH "/proc/pressure/cpu"
+#define PSI_STALL_US 100000              // trigger: 100 ms of "some" stall ...
+#define PSI_WINDOW_US 2000000            // ... per 2 s window (unprivileged minimum)
+#define PSI_AVG10_PCT 10.0               // fallback threshold when triggers are unavailable
+#define MEM_SAMPLE_PERIOD_MS 50
+#define MEM_CALM_MS 2000                 // pressure-free time before the active set grows again
+#define MEM_TOUCH_PAGES 32               // pages a mem= worker touches per work step
+
+// dominant resource fairness across groups (-D), memory capacity (-m)
+#define DRF_HALF_LIFE_MS 1000.0          // cpu share decays so a group alone earlier is not starved later
+
+// overload admission control (-O)
+#define ADMIT_QUEUE_MAX 8                // submissions held while the predicted p99 wait is over target
+#define ADMIT_RATE_PERIOD_MS 100         // delivered cpu rate re-estimated over busy windows this long
+#define ADMIT_RATE_ALPHA 0.3
+
+// binary trace (-T), format in cfs_trace.h
+#define TRACE_BENCH_EVENTS 30000000      // events written by -B -T
+
+// shared-memory stats page (-K), layout in cfs_stats.h
+#define STATS_BENCH_PUBLISHES 200000     // full-page publishes by -B -K
+#define STATS_BENCH_SAMPLES 200000       // reader snapshots timed
+#define STATS_BENCH_SECONDS 10           // stop sampling here even if the reader is short
+
+// snapshot ring file (-Y), layout in cfs_ring.h
+#define RING_RECORDS 262144              // slots per file, 8 MiB of records
+#define RING_INTERVAL_MS 100             // default snapshot interval (-y)
+
+// self-profiling, compiled in with -DCFS_PROFILE
+#define PROFILE_BUCKETS 40               // log2(ns) histogram buckets per phase
+#define PROFILE_CALIBRATE_US 20000       // tsc rate measured against CLOCK_MONOTONIC over this long
 
 typedef enum {
     PROC_READY,
     PROC_RUNNING,
     PROC_STOPPED,
     PROC_COMPLETED,
-    PROC_WAITING_ARRIVAL
+    PROC_WAITING_ARRIVAL,
+    PROC_WAITING_DEPS,            // blocked until all parent tasks complete
+    PROC_SLEEPING                 // emulated blocking between cpu bursts
 } proc_state_t;
 
+// admission decision for a submitted task, published on the shared page
+typedef enum {
+    ADMIT_PENDING,                // not submitted yet (arrival time or parents)
+    ADMIT_OK,
+    ADMIT_QUEUED,                 // predicted p99 wait over target, waiting to be admitted
+    ADMIT_HELD_MEMORY,            // -D: memory demand does not fit
+    ADMIT_REJECT_QUEUE_FULL,
+    ADMIT_REJECT_TIMEOUT,         // queued until its wait alone passed the target
+    ADMIT_REJECT_PARENT,          // a task it depends on was rejected
+    ADMIT_REASONS
+} admit_reason_t;
+
+// third argument of the cfs:throttle probe
+typedef enum {
+    THROTTLE_MEM_PARK = 1,        // parked under memory pressure (-R)
+    THROTTLE_ADMIT_QUEUE,         // queued by admission control (-O)
+    THROTTLE_DRF_HOLD,            // memory does not fit (-D)
+    THROTTLE_REJECT               // rejected at admission
+} throttle_cause_t;
+
+static const char *admit_reason_names[ADMIT_REASONS] = {
+    "pending", "admitted", "queued", "held for memory",
+    "rejected: queue full", "rejected: timed out", "rejected: parent rejected"
+};
+
+typedef enum {
+    PLACE_LEGACY,                 // new tasks at min_vruntime, wakeups untouched
+    PLACE_DEBIT,                  // start debit for new tasks, bounded sleeper credit
+    PLACE_LAG                     // eevdf-style: lag to the average preserved across sleep
+} placement_t;
+
 // process control block
 typedef struct {
     pid_t pid;
@@ -53,38 +248,554 @@ typedef struct {
     // heuristic fields
     long last_schedule_time_ms;
     long total_wait_time_ms;
+    long run_time_ms;             // cpu charged so far
     int estimated_burst_ms;
     int interactivity_score;
     int aging_boost;
 
+    // dependency tracking (DAG workloads)
+    int num_children;
+    int children[MAX_PROCESSES];
+    int pending_parents;          // parents not yet completed
+    long upward_rank_ms;          // longest path from this task to a sink
+
+    // slo feedback control (slo_target_ms == 0 means throughput only)
+    int slo_target_ms;            // p99 dispatch latency target
+    int base_weight;              // weight from nice before slo adjustment
+    long ready_since_ms;          // when the task last became runnable
+    int latency_window[SLO_WINDOW];
+    int latency_hist[SLO_HIST_BUCKETS];
+    long latency_samples;
+    long latency_met;             // samples within slo_target_ms
+    long slo_integral;
+
+    int group_idx;                // fair-share group (user/tenant)
+    int arrived;                  // placed on the run queue at least once
+
+    // emulated blocking: sleep io_sleep_ms after every io_run_ms of cpu
+    int io_run_ms;
+    int io_sleep_ms;
+    int ran_since_wake_ms;
+    long wake_time_ms;
+    long total_sleep_ms;
+    long lag_ns;                  // avg_vruntime - vruntime when it went to sleep
+
+    // cache refill after being switched in: the first warm_ms of cpu make no progress
+    int warm_ms;
+    int warm_owed_ms;
+
+    // quantum bandit: ucb1 per context, updated at every slice end
+    long bandit_pulls[BANDIT_CONTEXTS][QUANTUM_ARMS];
+    double bandit_value[BANDIT_CONTEXTS][QUANTUM_ARMS];
+    long arm_pulls[QUANTUM_ARMS];
+    int slice_context;
+    int slice_arm;
+
+    long max_dispatch_wait_ms;    // longest runnable stretch without the cpu
+    int forced_dispatches;        // picks overridden by the wait watchdog
+
+    // shared-lock worker: hold the lock for lock_hold_ms of cpu every lock_period_ms
+    int lock_hold_ms;
+    int lock_period_ms;
+    long spin_seen_ms;            // lock spin already taken out of progress
+    int lock_stops;               // slice-end stops
+    int lock_preempted;           // ... of which while holding the lock
+    int ext_granted;
+    int ext_denied;
+    int ext_overruns;
+    long ext_ms;
+    int ext_revoked;
+
+    // disk worker: the sleep phase writes disk_kb KiB and syncs instead of idling
+    int disk_kb;
+    int disk_phases;
+    long disk_ms;                 // time spent in disk phases
+    int io_level;                 // best-effort i/o priority level set, -1 = untouched
+    int io_updates;
+
+    // memory worker: keeps mem_mb MiB of file-backed pages hot
+    int mem_mb;
+    int mem_active;               // in the active set of memory-heavy tasks
+    int mem_parked;               // times dropped from the active set under pressure
+    long rss_kb;
+    long peak_rss_kb;
+    long maj_faults;
+    long cpu_seen_ms;             // worker cpu already counted as progress
+
+    // dominant resource fairness: memory charged to the group while admitted
+    int drf_mem_mb;
+    long eligible_ms;             // first time admission was tried, 0 = not yet
+    int drf_deferred;             // held back because its memory did not fit
+
+    admit_reason_t admission;     // last admission decision
+
     proc_state_t state;
     int time_slice_remaining_ms;
 } process_t;
 
+// per-user/group cpu usage, exponentially decayed so old work is forgiven
+typedef struct {
+    char name[GROUP_NAME_LEN];
+    double usage_ms;              // decayed usage as of last_update_s
+    double last_update_s;         // wall clock, so history survives restarts
+    int num_tasks;                // tasks in the current workload
+
+    // dominant resource fairness within this run
+    double drf_cpu_ms;            // cpu, decayed with DRF_HALF_LIFE_MS
+    long drf_update_ms;
+    int mem_held_mb;              // memory of admitted, unfinished tasks
+    long contended_cpu_ms;        // while two or more groups had work
+    double contended_mem_mb_ms;
+    int deferred;                 // admissions held back for memory
+    long deferred_ms;
+} group_t;
+
 typedef struct {
     process_t processes[MAX_PROCESSES];
     int num_processes;
     int current_process_idx;
     unsigned long min_vruntime_ns;
+    long slices;                  // slices run
+    long dispatches;              // switch-ins
     long scheduler_start_time_ms;
     long current_time_ms;
     int completed_count;
+    long makespan_ms;
+    long last_slo_control_ms;
+
+    group_t groups[MAX_GROUPS];
+    int num_groups;
+    double total_usage_ms;        // sum of all group usage, decayed in lockstep
+    double total_update_s;
+
+    // dominant resource fairness: decayed total cpu, memory held, contended time
+    double drf_cpu_ms;
+    long drf_update_ms;
+    int drf_mem_used_mb;
+    long drf_contended_ms;
+    long drf_last_ms;
+
+    // admission control: delivered cpu rate (progress per wall ms) and decisions
+    double admit_rate;
+    long rate_start_ms;
+    long rate_progress_ms;
+    int rate_idle;                // the current rate window saw an idle tick
+    int admit_queued;
+    long admit_counts[ADMIT_REASONS];
+    long admit_p99_ms;            // predicted p99 wait at the last decision
+
+    int cache_owner;              // task whose working set the cpu holds, -1 = none
+    uint64_t ready_mask;          // candidates at the last pick, bit per task (64 at most)
+
+    // meta-scheduler: active registered policy and its switch history
+    int active_policy;
+    int pending_policy;
+    int pending_votes;
+    long last_regime_ms;
+    long policy_time_ms[MAX_POLICIES];
+    int num_switches;
+    long switch_time_ms[REGIME_LOG];
+    int switch_policy[REGIME_LOG];
+
+    // wait watchdog: timerfd ticks, the task it wants dispatched next, -1 = none
+    int watchdog_fd;
+    int forced_idx;
+    long watchdog_fires;
+    long forced_total;
+    long wait_samples;
+    long wait_violations;
+    long wait_bands[WAIT_BANDS + 1];  // last band: over the bound
+
+    // memory pressure: psi trigger fd (-1 = polling avg10), active-set limit
+    int psi_fd;
+    long psi_events;
+    long mem_pressure_ms;         // last time pressure was seen
+    long mem_last_sample_ms;
+    int mem_limit;
+    int mem_limit_min;
+    double psi_mem_peak;          // avg10 peaks over the run
+    double psi_cpu_peak;
+
+    // pick explanations (-E): heuristic picks seen, records written
+    long explain_picks;
+    long explain_records;
 } scheduler_t;
 
+// runtime options (set from the command line)
+typedef struct {
+    const char *workload_path;    // NULL = built-in test workload
+    int critical_path;            // bias picks toward the longest remaining DAG path
+    int slo_control;              // adjust weights toward per-task latency targets
+    const char *fairshare_path;   // persisted group usage, NULL = none
+    double fairshare_half_life_s;
+    placement_t placement;
+    int learned_model;            // score candidates with cfs_model.h instead of heuristics
+    int adaptive_quantum;         // per-task quantum picked by a bandit
+    unsigned shadow_mask;         // shadow policies to evaluate, bit per policies[] entry
+    int meta_policy;              // switch between registered policies by workload regime
+    int max_wait_ms;              // hard bound on a runnable task's wait, 0 = none
+    int slice_ext;                // extend slices of workers inside a critical section
+    int io_priority;              // tie each task's i/o priority to its effective weight
+    int mem_control;              // shrink the active set of memory-heavy tasks under pressure
+    int drf;                      // pick and admit by dominant share across groups
+    int mem_capacity_mb;          // memory for dominant shares, 0 = physical memory
+    int admit_target_ms;          // p99 wait target for admission control, 0 = admit everything
+    const char *trace_path;       // binary event trace, NULL = none
+    int explain_every;            // trace the score breakdown of one heuristic pick in N, 0 = none
+    const char *stats_name;       // shared-memory stats page for monitors, NULL = none
+    const char *ring_path;        // per-task snapshot history, NULL = none
+    int ring_interval_ms;
+    const char *results_dir;      // arrow ipc export of the run, NULL = none
+} config_t;
+
+// registered pick policies, used by shadows (-S) and the meta-scheduler (-M)
+typedef long long (*policy_score_fn)(process_t *proc, long current_time);
+
+typedef struct {
+    const char *name;
+    policy_score_fn score;        // lowest runs next
+} policy_t;
+
+/* shadow evaluation: the dispatch loop pushes events into a lock-free
+   single-producer/single-consumer ring and a separate thread replays them
+   against alternative policies. shadows never touch the live task table */
+typedef enum {
+    EV_ARRIVE,                    // task admitted: a = placed vruntime
+    EV_PICK,                      // live dispatch: mask = ready set at the pick
+    EV_RAN,                       // slice ended: a = vruntime, b = remaining
+    EV_COMPLETE,
+    EV_DONE                       // live run finished, drain and stop
+} shadow_event_type_t;
+
+typedef struct {
+    int type;
+    int task;
+    long time_ms;                 // since scheduler start
+    long a;
+    long b;
+    uint64_t mask;                // candidate set, bit per task
+} shadow_event_t;
+
+// ready_mask and shadow_event_t.mask hold one bit per task
+_Static_assert(MAX_PROCESSES <= 64, "candidate masks are 64 bits: widen them before raising MAX_PROCESSES");
+
+// one alternative policy replaying its own virtual timeline
+typedef struct {
+    process_t tasks[MAX_PROCESSES];
+    long clock_ms;
+    int current;                  // task holding the virtual cpu, -1 = none
+    int slice_left_ms;
+    int cache_owner;
+    int completed;
+    long picks;
+    long disagreements;
+} shadow_t;
+
+// one slice of the dispatch loop, kept for the columnar export (-o)
+typedef struct {
+    long start_ms;                // since the scheduler started
+    long end_ms;
+    unsigned long vruntime_ns;    // at the pick
+    long dispatch_wait_ms;        // -1 when the task kept the cpu
+    int task;
+    int runnable;                 // tasks on the run queue at the pick
+    int slice_ms;                 // slice granted
+    int policy;
+} decision_t;
+
 scheduler_t scheduler;
+config_t config = {
+    .critical_path = 1,
+    .slo_control = 1,
+    .fairshare_half_life_s = FAIRSHARE_HALF_LIFE_S,
+    .placement = PLACE_DEBIT,
+    .ring_interval_ms = RING_INTERVAL_MS,
+};
+
+/* page shared with the children, mapped before the forks. a worker raises
+   in_critical while it holds the shared lock (rseq-style: a plain store the
+   scheduler reads at slice expiry). after an extension it clears the flag,
+   releases the lock and sets yielded so the scheduler stops it right away */
+typedef struct {
+    atomic_int in_critical;
+    atomic_int extended;          // set by the scheduler while an extension runs
+    atomic_int yielded;
+    atomic_long spin_ms;          // cpu burned waiting for the lock, no progress
+    atomic_long sections;         // critical sections completed
+    atomic_int io_request;        // disk phases requested by the scheduler
+    atomic_int io_done;           // ... written and synced by the worker
+    atomic_int io_release;        // ... ended by the scheduler, the worker may compute again
+    atomic_long cpu_ms;           // mem workers: cpu used so far, refault waits are not cpu
+    atomic_int admission;         // admit_reason_t of the latest decision on this task
+} slice_page_t;
+
+/* the admit_* fields are the backpressure signal for submitters: level 0
+   admits, 1 queues, 2 rejects; retry_ms is how far the predicted p99 wait
+   is over target, a hint for when to resubmit */
+typedef struct {
+    atomic_int lock;              // 0 = free, else holder task index + 1
+    atomic_int admit_level;
+    atomic_long admit_p99_ms;
+    atomic_long admit_retry_ms;
+    atomic_int admit_queued;
+    atomic_long admit_rejected;
+    slice_page_t tasks[MAX_PROCESSES];
+} shared_page_t;
+
+shared_page_t *shared_page;
+
+static const int quantum_arms_ms[QUANTUM_ARMS] = {
+    TIME_QUANTUM_MS / 2, TIME_QUANTUM_MS, TIME_QUANTUM_MS * 2, TIME_QUANTUM_MS * 4
+};
 
-void child_worker(int task_id, int burst_time_ms);
+void child_worker(const process_t *proc);
+void map_shared_page(void);
 long get_time_ms(void);
+long get_cpu_time_ms(void);
 void stop_process(pid_t pid);
 void continue_process(pid_t pid);
 void initialize_scheduler(void);
+process_t *add_task(int arrival_ms, int burst_ms, int nice);
+void add_dependency(int parent_id, int child_id);
+void load_workload_file(const char *path);
+void load_workload_binary(const char *path);
+void load_default_workload(void);
+void compute_upward_ranks(void);
+void release_dependents(process_t *proc, long current_time);
+void record_dispatch_latency(process_t *proc, long current_time);
+void watchdog_start(void);
+int watchdog_tick(long current_time);
+void run_slice(int slice_ms);
+void record_bounded_wait(process_t *proc, long current_time);
+void grant_slice_extension(process_t *proc, int idx);
+void sync_io_priority(process_t *proc);
+void memory_start(void);
+int psi_poll(void);
+void run_memory_control(long current_time, int psi_fired);
+int memory_parked(process_t *proc);
+int latency_percentile(process_t *proc, int pct);
+void slo_control_step(process_t *proc);
+void run_slo_controller(long current_time);
+double get_wall_time_s(void);
+int find_or_add_group(const char *name);
+void group_decay(group_t *group, double now_s);
+double fairshare_factor(group_t *group, double now_s);
+long fairshare_adjust(process_t *proc, double now_s);
+void fairshare_charge(process_t *proc, long executed_time_ms);
+void load_fairshare_state(const char *path);
+void save_fairshare_state(const char *path);
+double drf_dominant_share(group_t *group, long current_time);
+int drf_admit(process_t *proc, long current_time);
+void drf_release(process_t *proc);
+void drf_charge(process_t *proc, long executed_time_ms, long current_time);
+void drf_account(long current_time);
+long predict_p99_wait(process_t *cand, long current_time);
+int admission_control(process_t *proc, long current_time);
+void admission_track(long progress_ms, long current_time);
+void admit_arrivals(long current_time);
+void update_min_vruntime(void);
+long avg_vruntime(void);
+long vslice_ns(process_t *proc);
+void place_task(process_t *proc, int wakeup, long fairshare_debit);
+void put_to_sleep(process_t *proc, long current_time);
+void estimate_burst(process_t *proc);
 void compute_heuristic_metrics(process_t *proc, long current_time);
+long long heuristic_score(process_t *proc);
+long long heuristic_terms(process_t *proc, long long *terms);
+void model_features(process_t *proc, long current_time, int32_t *features);
+long long model_score(process_t *proc, long current_time);
+int benchmark_scoring(void);
+int latency_sensitive(process_t *proc);
+int bandit_context(process_t *proc);
+int bandit_pick(process_t *proc, int context);
+void bandit_update(process_t *proc, long executed_ms, long progress_ms, long current_time);
 int select_next_process_cfs_heuristic(void);
+int policy_index(const char *name);
+void migrate_run_queue(int to_policy);
+void run_regime_classifier(long current_time);
+void shadow_emit(int type, int task, long current_time, long a, long b, uint64_t mask);
+void shadow_start(void);
+void shadow_stop(long current_time);
+void *shadow_thread(void *arg);
+void trace_open(const char *path, int streams);
+void trace_emit(int type, int task, long arg);
+void trace_explain(process_t *winner, process_t *rival, int flags, unsigned long base_vruntime);
+void trace_close(void);
+int benchmark_trace(void);
+void stats_open(const char *name);
+void stats_publish(long current_time);
+void stats_close(void);
+int benchmark_stats(void);
+void ring_open(const char *path);
+void ring_snapshot(long current_time);
+void ring_close(void);
+void results_record(process_t *proc, long exec_start, long exec_end, long dispatch_wait);
+void results_export(const char *dir);
 void update_vruntime(process_t *proc, long executed_time_ms);
 void schedule_processes(void);
 void print_process_table(void);
 void print_scheduling_trace(void);
 void print_final_statistics(void);
+void print_slo_report(void);
+void print_fairshare_report(void);
+void print_quantum_report(void);
+void print_shadow_report(void);
+void print_regime_report(void);
+void print_wait_report(void);
+void print_lock_report(void);
+void print_disk_report(void);
+void print_memory_report(void);
+void print_drf_report(void);
+void print_admission_report(void);
+void print_trace_report(void);
+
+/* ---- self-profiling ---- */
+
+/* with -DCFS_PROFILE every decision in schedule_processes() is split into
+   phases by laps: PROFILE_LAP(phase) charges the time since the previous lap
+   to phase. the per-decision sums go into log2 histograms. timestamps come
+   from rdtscp where available, clock_gettime otherwise. without the flag the
+   macros are empty */
+#ifdef CFS_PROFILE
+typedef enum {
+    PH_WAIT,                      // idle ticks and the running slice
+    PH_METRICS,                   // arrivals, controllers, per-candidate heuristics
+    PH_PICK,
+    PH_SIGNAL,                    // kill(SIGSTOP / SIGCONT)
+    PH_CONFIRM,                   // settle time after a signal
+    PH_ACCOUNT,                   // runtime, vruntime, shares, completion checks
+    PH_TRACE,                     // trace lines and shadow events
+    PH_COUNT
+} profile_phase_t;
+
+// phase names live in cfs_stats.h, which also carries the histograms to monitors
+_Static_assert(PH_COUNT == CFS_STATS_PHASES, "stats page phases out of sync with profile_phase_t");
+_Static_assert(PROFILE_BUCKETS == CFS_STATS_PHASE_BUCKETS, "stats page buckets out of sync with PROFILE_BUCKETS");
+
+static struct {
+    uint64_t last;                // previous lap, 0 = not profiling
+    uint64_t cur[PH_COUNT];       // ticks in the current decision
+    uint64_t total_ns[PH_COUNT];
+    uint64_t max_ns[PH_COUNT];
+    long samples[PH_COUNT];       // decisions that spent time in the phase
+    long hist[PH_COUNT][PROFILE_BUCKETS];
+    long decisions;
+    double ticks_per_ns;
+    double lap_ns;                // cost of one lap
+} profile;
+
+static inline uint64_t profile_clock(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    unsigned aux;
+    return __rdtscp(&aux);
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+#endif
+}
+
+static inline void profile_lap(profile_phase_t phase) {
+    if (!profile.last) return;
+    uint64_t now = profile_clock();
+    profile.cur[phase] += now - profile.last;
+    profile.last = now;
+}
+
+// calibrates ticks against the monotonic clock and the cost of a lap, then starts
+static void profile_start(void) {
+    struct timespec a, b;
+    clock_gettime(CLOCK_MONOTONIC, &a);
+    uint64_t t0 = profile_clock();
+    usleep(PROFILE_CALIBRATE_US);
+    uint64_t t1 = profile_clock();
+    clock_gettime(CLOCK_MONOTONIC, &b);
+    profile.ticks_per_ns = (t1 - t0) / ((b.tv_sec - a.tv_sec) * 1e9 + (b.tv_nsec - a.tv_nsec));
+
+    profile.last = profile_clock();
+    uint64_t c0 = profile.last;
+    for (int i = 0; i < 1000; i++) profile_lap(PH_WAIT);
+    profile.lap_ns = (profile.last - c0) / profile.ticks_per_ns / 1000;
+
+    memset(profile.cur, 0, sizeof(profile.cur));
+    profile.last = profile_clock();
+}
+
+// closes the current decision: each phase it touched gets one histogram sample
+static void profile_decision(void) {
+    if (!profile.last) return;
+
+    int any = 0;
+    for (int ph = 0; ph < PH_COUNT; ph++) {
+        if (profile.cur[ph] == 0) continue;
+        uint64_t ns = (uint64_t)(profile.cur[ph] / profile.ticks_per_ns);
+        int bucket = 63 - __builtin_clzll(ns | 1);
+        if (bucket >= PROFILE_BUCKETS) bucket = PROFILE_BUCKETS - 1;
+
+        profile.hist[ph][bucket]++;
+        profile.total_ns[ph] += ns;
+        if (ns > profile.max_ns[ph]) profile.max_ns[ph] = ns;
+        profile.samples[ph]++;
+        profile.cur[ph] = 0;
+        any = 1;
+    }
+    if (any) profile.decisions++;
+}
+
+// upper bound of the bucket holding the pct-th percentile, in us
+static double profile_percentile_us(int ph, int pct) {
+    long rank = (profile.samples[ph] * pct + 99) / 100;
+    long seen = 0;
+    for (int b = 0; b < PROFILE_BUCKETS; b++) {
+        seen += profile.hist[ph][b];
+        if (seen >= rank) return (double)(1ULL << (b + 1)) / 1000.0;
+    }
+    return (double)(1ULL << PROFILE_BUCKETS) / 1000.0;
+}
+
+static void profile_report(void) {
+    uint64_t all = 0;
+    for (int ph = 0; ph < PH_COUNT; ph++) all += profile.total_ns[ph];
+    if (all == 0) all = 1;
+
+    printf("\n");
+    printf("╔════════════════════════════════════════════════════════════════════╗\n");
+    printf("║        SCHEDULER SELF-PROFILE (%8ld decisions, %-6s)         ║\n",
+           profile.decisions,
+#if defined(__x86_64__) || defined(__i386__)
+           "rdtscp"
+#else
+           "clock"
+#endif
+           );
+    printf("╠══════════════╦══════════╦══════════╦══════════╦══════════╦═════════╣\n");
+    printf("║ Phase        ║ Samples  ║ Mean us  ║ p50 us<= ║ p99 us<= ║ Share   ║\n");
+    printf("╠══════════════╬══════════╬══════════╬══════════╬══════════╬═════════╣\n");
+    for (int ph = 0; ph < PH_COUNT; ph++) {
+        long n = profile.samples[ph];
+        printf("║ %-12s ║ %8ld ║ %8.1f ║ %8.1f ║ %8.1f ║ %5.1f%%  ║\n",
+               cfs_stats_phase_names[ph], n, n ? profile.total_ns[ph] / 1000.0 / n : 0.0,
+               n ? profile_percentile_us(ph, 50) : 0.0, n ? profile_percentile_us(ph, 99) : 0.0,
+               100.0 * profile.total_ns[ph] / all);
+    }
+    printf("╠══════════════╩══════════╩══════════╩══════════╩══════════╩═════════╣\n");
+    printf("║  Scheduler time / decision: %8.1f us (excluding event wait)     ║\n",
+           profile.decisions ? (all - profile.total_ns[PH_WAIT]) / 1000.0 / profile.decisions : 0.0);
+    printf("║  Cost of one lap          : %8.1f ns                            ║\n", profile.lap_ns);
+    printf("║  Tick rate                : %8.3f ticks/ns                      ║\n", profile.ticks_per_ns);
+    printf("╚════════════════════════════════════════════════════════════════════╝\n");
+}
+
+#define PROFILE_START() profile_start()
+#define PROFILE_LAP(phase) profile_lap(phase)
+#define PROFILE_DECISION() profile_decision()
+#define PROFILE_REPORT() profile_report()
+#else
+#define PROFILE_START() ((void)0)
+#define PROFILE_LAP(phase) ((void)0)
+#define PROFILE_DECISION() ((void)0)
+#define PROFILE_REPORT() ((void)0)
+#endif
 
 // monotonic clock time in ms
 long get_time_ms(void) {
@@ -96,35 +807,216 @@ long get_time_ms(void) {
 void stop_process(pid_t pid) {
     if (pid > 0) {
         kill(pid, SIGSTOP);
+        PROFILE_LAP(PH_SIGNAL);
         usleep(100);
+        PROFILE_LAP(PH_CONFIRM);
     }
 }
 
 void continue_process(pid_t pid) {
     if (pid > 0) {
         kill(pid, SIGCONT);
+        PROFILE_LAP(PH_SIGNAL);
         usleep(100);
+        PROFILE_LAP(PH_CONFIRM);
+    }
+}
+
+// wall clock in seconds, used where state must outlive the process
+double get_wall_time_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// cpu time consumed by the calling process in ms
+long get_cpu_time_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return (ts.tv_sec * 1000LL) + (ts.tv_nsec / 1000000LL);
+}
+
+static volatile sig_atomic_t child_resumed;
+
+static void on_sigcont(int sig) {
+    (void)sig;
+    child_resumed = 1;
+}
+
+/* one disk phase of a disk= worker: disk_kb KiB written over the same region
+   of a private scratch file, then fdatasync. the file is unlinked as soon as
+   it is opened so nothing is left behind */
+static void disk_write(int disk_kb) {
+    static int fd = -1;
+    static char chunk[DISK_CHUNK_KB * 1024];
+
+    if (fd < 0) {
+        char path[64];
+        snprintf(path, sizeof(path), "%s/cfs_disk.%d.tmp", DISK_DIR, (int)getpid());
+        fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0600);
+        if (fd < 0) {
+            perror(path);
+            exit(1);
+        }
+        unlink(path);
+        memset(chunk, getpid() & 0xff, sizeof(chunk));
+    }
+
+    for (int kb = 0; kb < disk_kb; kb += DISK_CHUNK_KB) {
+        int len = (disk_kb - kb < DISK_CHUNK_KB ? disk_kb - kb : DISK_CHUNK_KB) * 1024;
+        if (pwrite(fd, chunk, len, (off_t)kb * 1024) != len) {
+            perror("disk write");
+            exit(1);
+        }
+    }
+    fdatasync(fd);
+}
+
+/* working set of a mem= worker: a shared mapping of an unlinked scratch file.
+   file-backed so that under pressure the kernel can evict it (no swap
+   needed) and the worker refaults it from disk: real major faults */
+static volatile char *mem_map(int mem_mb) {
+    char path[64];
+    snprintf(path, sizeof(path), "%s/cfs_mem.%d.tmp", DISK_DIR, (int)getpid());
+    int fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0600);
+    if (fd < 0) {
+        perror(path);
+        exit(1);
+    }
+    unlink(path);
+
+    size_t len = (size_t)mem_mb << 20;
+    if (ftruncate(fd, len) < 0) {
+        perror("ftruncate");
+        exit(1);
     }
+    char *mem = mmap(NULL, len, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (mem == MAP_FAILED) {
+        perror("mmap working set");
+        exit(1);
+    }
+    close(fd);
+    return mem;
 }
 
 // busy-wait loop to simulate CPU-bound work
-void child_worker(int task_id, int burst_time_ms) {
-    long start = get_time_ms();
-    long target_end = start + burst_time_ms;
+// counts cpu time so the burst is only consumed while the scheduler lets it run.
+// after every real switch-out (SIGCONT after a gap) it burns warm_ms more,
+// standing in for a cache refill. lock workers take the shared lock for
+// lock_hold_ms every lock_period_ms; spinning on it extends the burst.
+// disk workers are resumed during their sleep phase to write and sync disk_kb.
+// mem workers dirty MEM_TOUCH_PAGES pages of their working set per step
+void child_worker(const process_t *proc) {
+    int task_id = proc->task_id;
+    int warm_ms = proc->warm_ms;
+    int lock_hold_ms = proc->lock_hold_ms;
+    int lock_period_ms = proc->lock_period_ms;
+    int disk_kb = proc->disk_kb;
+
+    long start = get_cpu_time_ms();
+    long target_end = start + proc->burst_time_ms;
+    long last_seen = get_time_ms();
+    long last_release = start;
+    long section_end = 0;
+    slice_page_t *page = &shared_page->tasks[task_id];
     volatile long counter = 0;
 
-    while (get_time_ms() < target_end) {
+    volatile char *mem = proc->mem_mb > 0 ? mem_map(proc->mem_mb) : NULL;
+    size_t mem_len = (size_t)proc->mem_mb << 20;
+    size_t touch = 0;
+
+    if (warm_ms > 0) {
+        signal(SIGCONT, on_sigcont);
+    }
+
+    while (get_cpu_time_ms() < target_end) {
         for (int i = 0; i < 10000; i++) {
             counter += i;
         }
+        long now = get_time_ms();
+        if (child_resumed) {
+            child_resumed = 0;
+            if (now - last_seen > WARM_GAP_MS) {
+                target_end += warm_ms;
+            }
+        }
+        last_seen = now;
+
+        if (mem) {
+            for (int i = 0; i < MEM_TOUCH_PAGES; i++) {
+                mem[touch]++;
+                touch = (touch + 4096) % mem_len;
+            }
+            atomic_store(&page->cpu_ms, get_cpu_time_ms() - start);
+        }
+
+        int phase = atomic_load(&page->io_request);
+        if (disk_kb > 0 && phase != atomic_load(&page->io_done)) {
+            // cpu used by the write path is not part of the burst
+            long cpu = get_cpu_time_ms();
+            disk_write(disk_kb);
+            atomic_store(&page->io_done, phase);
+            while (atomic_load(&page->io_release) != phase) {
+                usleep(DISK_POLL_US);
+            }
+            target_end += get_cpu_time_ms() - cpu;
+            last_seen = get_time_ms();
+            continue;
+        }
+
+        if (lock_hold_ms == 0) continue;
+
+        long cpu = get_cpu_time_ms();
+        if (section_end == 0 && cpu - last_release >= lock_period_ms) {
+            long spin_base = atomic_load(&page->spin_ms);
+            int expected = 0;
+            while (!atomic_compare_exchange_weak(&shared_page->lock, &expected, task_id + 1)) {
+                expected = 0;
+                for (int i = 0; i < 1000; i++) {
+                    counter += i;
+                }
+                atomic_store(&page->spin_ms, spin_base + get_cpu_time_ms() - cpu);
+            }
+            long spun = get_cpu_time_ms() - cpu;
+            atomic_store(&page->spin_ms, spin_base + spun);
+            target_end += spun;
+
+            atomic_store(&page->in_critical, 1);
+            section_end = cpu + spun + lock_hold_ms;
+        } else if (section_end != 0 && cpu >= section_end) {
+            atomic_store(&page->in_critical, 0);
+            atomic_store(&shared_page->lock, 0);
+            atomic_fetch_add(&page->sections, 1);
+            section_end = 0;
+            last_release = cpu;
+            if (atomic_exchange(&page->extended, 0)) {
+                atomic_store(&page->yielded, 1);
+            }
+        }
     }
 
+    if (section_end != 0) {
+        atomic_store(&page->in_critical, 0);
+        atomic_store(&shared_page->lock, 0);
+    }
+    atomic_store(&page->io_done, atomic_load(&page->io_request));    // no disk phase waits on an exited worker
     exit(0);
 }
 
+void map_shared_page(void) {
+    shared_page = mmap(NULL, sizeof(shared_page_t), PROT_READ | PROT_WRITE,
+                       MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (shared_page == MAP_FAILED) {
+        perror("mmap shared page");
+        exit(1);
+    }
+}
+
 void initialize_scheduler(void) {
     memset(&scheduler, 0, sizeof(scheduler_t));
     scheduler.current_process_idx = -1;
+    scheduler.cache_owner = -1;
+    scheduler.admit_rate = 1.0;
     scheduler.min_vruntime_ns = 0;
     scheduler.scheduler_start_time_ms = get_time_ms();
 }
@@ -139,7 +1031,7 @@ int nice_to_weight(int nice) {
         3121, 2501, 1991, 1586, 1277,
         1024, 820, 655, 526, 423,
         335, 272, 215, 172, 137,
-        110, 87, 70, 56, 45, 36, 29, 23
+        110, 87, 70, 56, 45, 36, 29, 23, 18, 15
     };
 
     int idx = nice + 20;
@@ -149,172 +1041,2761 @@ int nice_to_weight(int nice) {
     return weights[idx];
 }
 
-/* heuristic layer - computes dynamic scheduling metrics:
-   1. aging boost for long-waiting processes
-   2. burst estimation using exponential moving avg
-   3. interactivity score to favor short tasks */
-void compute_heuristic_metrics(process_t *proc, long current_time) {
-    if (proc->state == PROC_READY || proc->state == PROC_STOPPED) {
-        long wait_delta = current_time - proc->last_schedule_time_ms;
-        if (wait_delta > 0) {
-            proc->total_wait_time_ms += wait_delta;
-        }
+// appends a task to the process table (pid is filled in at fork time)
+process_t *add_task(int arrival_ms, int burst_ms, int nice) {
+    if (scheduler.num_processes >= MAX_PROCESSES) {
+        fprintf(stderr, "too many tasks (max %d)\n", MAX_PROCESSES);
+        exit(1);
     }
 
-    // aging boost to prevent starvation
-    if (proc->total_wait_time_ms > MAX_WAIT_THRESHOLD_MS) {
-        proc->aging_boost = (proc->total_wait_time_ms - MAX_WAIT_THRESHOLD_MS) / 10;
-        if (proc->aging_boost > 10) proc->aging_boost = 10;
-    } else {
-        proc->aging_boost = 0;
-    }
+    int i = scheduler.num_processes++;
+    process_t *proc = &scheduler.processes[i];
 
-    // burst estimation
-    if (proc->estimated_burst_ms == 0) {
-        proc->estimated_burst_ms = proc->remaining_time_ms / 4;
-        if (proc->estimated_burst_ms < TIME_QUANTUM_MS) {
-            proc->estimated_burst_ms = TIME_QUANTUM_MS;
-        }
+    proc->task_id = i;
+    proc->arrival_time_ms = arrival_ms;
+    proc->burst_time_ms = burst_ms;
+    proc->remaining_time_ms = burst_ms;
+    proc->nice_value = nice;
+    proc->weight = nice_to_weight(nice);
+    proc->base_weight = proc->weight;
+    proc->vruntime_ns = scheduler.min_vruntime_ns;
+    proc->state = PROC_READY;
+    proc->first_run = 0;
+    proc->estimated_burst_ms = 0;
+    proc->aging_boost = 0;
+    proc->interactivity_score = 100;
+    proc->last_schedule_time_ms = scheduler.scheduler_start_time_ms;
+    proc->ready_since_ms = scheduler.scheduler_start_time_ms + arrival_ms;
+    proc->io_level = -1;
+    proc->group_idx = find_or_add_group("default");
+    scheduler.groups[proc->group_idx].num_tasks++;
+
+    return proc;
+}
+
+// parent must be listed before child, which keeps every workload acyclic
+void add_dependency(int parent_id, int child_id) {
+    if (parent_id < 0 || parent_id >= child_id) {
+        fprintf(stderr, "task %d: dependency on %d must name an earlier task\n",
+                child_id, parent_id);
+        exit(1);
     }
 
-    // interactivity - shorter remaining = less interactive
-    if (proc->burst_time_ms > 0) {
-        proc->interactivity_score =
-            (proc->remaining_time_ms * 100) / proc->burst_time_ms;
-        if (proc->estimated_burst_ms < INTERACTIVE_THRESHOLD_MS) {
-            proc->interactivity_score += 20;
-        }
+    process_t *parent = &scheduler.processes[parent_id];
+    process_t *child = &scheduler.processes[child_id];
+
+    for (int i = 0; i < parent->num_children; i++) {
+        if (parent->children[i] == child_id) return;
     }
 
-    proc->last_schedule_time_ms = current_time;
+    parent->children[parent->num_children++] = child_id;
+    child->pending_parents++;
+    child->state = PROC_WAITING_DEPS;
 }
 
-// vruntime update: vruntime += (exec_time * 1024) / weight
-void update_vruntime(process_t *proc, long executed_time_ms) {
-    unsigned long executed_ns = executed_time_ms * 1000000UL;
-    unsigned long delta_vruntime =
-        (executed_ns * CFS_WEIGHT_NICE_0) / proc->weight;
+/* rules every task must meet, whichever format it was loaded from. where
+   prefixes the message: "file:line" for text, "file: record N" for binary */
+static void check_task(const char *where, process_t *proc) {
+    const char *err = NULL;
 
-    proc->vruntime_ns += delta_vruntime;
+    if (proc->arrival_time_ms < 0) err = "arrival must not be negative";
+    else if (proc->burst_time_ms <= 0) err = "burst must be positive";
+    else if (proc->nice_value < -20 || proc->nice_value > 19) err = "nice must be in -20..19";
+    else if (proc->disk_kb > 0 && proc->io_run_ms == 0) err = "disk= needs io=";
 
-    if (proc->vruntime_ns < scheduler.min_vruntime_ns ||
-        scheduler.min_vruntime_ns == 0) {
-        scheduler.min_vruntime_ns = proc->vruntime_ns;
+    if (err) {
+        fprintf(stderr, "%s: %s\n", where, err);
+        exit(1);
     }
 }
 
-// picks process with lowest score (vruntime adjusted by heuristics)
-int select_next_process_cfs_heuristic(void) {
-    int best_idx = -1;
-    long long best_score = LLONG_MAX;
-    long current_time = get_time_ms();
-
-    for (int i = 0; i < scheduler.num_processes; i++) {
-        process_t *proc = &scheduler.processes[i];
+/* workload file format, one task per line:
+     <arrival_ms> <burst_ms> <nice> [key=value ...]
+   keys:
+     deps=1,2   task ids (0-based line order) that must complete first
+     slo=N      p99 dispatch latency target in ms
+     group=NAME fair-share group (user or tenant), default "default"
+     io=R:S     emulated blocking: sleep S ms after every R ms of cpu
+     warm=N     cache refill: N ms of cpu without progress after each switch-in
+     lock=H:P   hold the shared lock for H ms of cpu after every P ms outside it
+     disk=K     with io=: write and sync K KiB in every sleep phase, waking when done
+     mem=M      keep an M MiB file-backed working set hot while running
+   '#' starts a comment. files written by wlconvert are detected by their
+   magic and loaded by load_workload_binary() */
+void load_workload_file(const char *path) {
+    if (wl_is_binary(path)) {
+        load_workload_binary(path);
+        return;
+    }
 
-        if (proc->state != PROC_READY && proc->state != PROC_STOPPED) {
-            continue;
-        }
+    FILE *fp = fopen(path, "r");
+    if (!fp) {
+        perror(path);
+        exit(1);
+    }
 
-        long elapsed = current_time - scheduler.scheduler_start_time_ms;
-        if (elapsed < proc->arrival_time_ms) {
-            continue;
-        }
+    char line[MAX_LINE_LEN];
+    int line_no = 0;
 
-        compute_heuristic_metrics(proc, current_time);
+    while (fgets(line, sizeof(line), fp)) {
+        line_no++;
 
-        long long score = proc->vruntime_ns;
+        char *hash = strchr(line, '#');
+        if (hash) *hash = '\0';
 
-        // aging: reduce score so starved processes get picked
-        score -= (proc->aging_boost * 100000000LL);
+        char *save;
+        char *tok = strtok_r(line, " \t\r\n", &save);
+        if (!tok) continue;
 
-        // interactive bonus
-        if (proc->estimated_burst_ms < INTERACTIVE_THRESHOLD_MS) {
-            score -= 50000000LL;
+        int fields[3];
+        for (int f = 0; f < 3; f++) {
+            char *end;
+            if (!tok) {
+                fprintf(stderr, "%s:%d: expected <arrival> <burst> <nice>\n", path, line_no);
+                exit(1);
+            }
+            fields[f] = (int)strtol(tok, &end, 10);
+            if (*end != '\0') {
+                fprintf(stderr, "%s:%d: bad number '%s'\n", path, line_no, tok);
+                exit(1);
+            }
+            tok = strtok_r(NULL, " \t\r\n", &save);
         }
 
-        // slight penalty for very long processes
-        if (proc->remaining_time_ms > 100) {
-            score += 10000000LL;
-        }
+        process_t *proc = add_task(fields[0], fields[1], fields[2]);
 
-        if (score < best_score) {
-            best_score = score;
-            best_idx = i;
+        for (; tok; tok = strtok_r(NULL, " \t\r\n", &save)) {
+            if (strncmp(tok, "deps=", 5) == 0) {
+                char *p = tok + 5;
+                while (*p) {
+                    char *end;
+                    long parent = strtol(p, &end, 10);
+                    if (end == p) {
+                        fprintf(stderr, "%s:%d: bad deps list '%s'\n", path, line_no, tok);
+                        exit(1);
+                    }
+                    add_dependency((int)parent, proc->task_id);
+                    p = (*end == ',') ? end + 1 : end;
+                }
+            } else if (strncmp(tok, "slo=", 4) == 0) {
+                proc->slo_target_ms = atoi(tok + 4);
+            } else if (strncmp(tok, "io=", 3) == 0) {
+                if (sscanf(tok + 3, "%d:%d", &proc->io_run_ms, &proc->io_sleep_ms) != 2 ||
+                    proc->io_run_ms <= 0 || proc->io_sleep_ms < 0) {
+                    fprintf(stderr, "%s:%d: expected io=<run_ms>:<sleep_ms>\n", path, line_no);
+                    exit(1);
+                }
+            } else if (strncmp(tok, "warm=", 5) == 0) {
+                proc->warm_ms = atoi(tok + 5);
+                if (proc->warm_ms < 0) {
+                    fprintf(stderr, "%s:%d: warm must not be negative\n", path, line_no);
+                    exit(1);
+                }
+            } else if (strncmp(tok, "lock=", 5) == 0) {
+                if (sscanf(tok + 5, "%d:%d", &proc->lock_hold_ms, &proc->lock_period_ms) != 2 ||
+                    proc->lock_hold_ms <= 0 || proc->lock_period_ms < 0) {
+                    fprintf(stderr, "%s:%d: expected lock=<hold_ms>:<period_ms>\n", path, line_no);
+                    exit(1);
+                }
+            } else if (strncmp(tok, "disk=", 5) == 0) {
+                proc->disk_kb = atoi(tok + 5);
+                if (proc->disk_kb <= 0) {
+                    fprintf(stderr, "%s:%d: disk must be positive\n", path, line_no);
+                    exit(1);
+                }
+            } else if (strncmp(tok, "mem=", 4) == 0) {
+                proc->mem_mb = atoi(tok + 4);
+                if (proc->mem_mb <= 0) {
+                    fprintf(stderr, "%s:%d: mem must be positive\n", path, line_no);
+                    exit(1);
+                }
+            } else if (strncmp(tok, "group=", 6) == 0) {
+                scheduler.groups[proc->group_idx].num_tasks--;
+                proc->group_idx = find_or_add_group(tok + 6);
+                scheduler.groups[proc->group_idx].num_tasks++;
+            } else {
+                fprintf(stderr, "%s:%d: unknown key '%s'\n", path, line_no, tok);
+                exit(1);
+            }
         }
-    }
 
-    return best_idx;
-}
+        char where[300];
+        snprintf(where, sizeof(where), "%s:%d", path, line_no);
+        check_task(where, proc);
+    }
 
-// main scheduling loop - uses SIGSTOP/SIGCONT for context switching
-void schedule_processes(void) {
-    printf("\n=== Starting CFS + Heuristic Scheduler ===\n\n");
+    fclose(fp);
 
-    while (scheduler.completed_count < scheduler.num_processes) {
-        long current_time = get_time_ms();
-        scheduler.current_time_ms = current_time;
+    if (scheduler.num_processes == 0) {
+        fprintf(stderr, "%s: no tasks\n", path);
+        exit(1);
+    }
+}
 
-        int next_idx = select_next_process_cfs_heuristic();
+/* the records are in release order with parents first, so each one becomes
+   a task without any parsing. wl_open() only checks the layout, so every
+   record still goes through check_task(), after a range check on the
+   unsigned fields that are narrowed to int */
+void load_workload_binary(const char *path) {
+    wl_view_t wl;
+    if (wl_open(path, &wl) < 0) {
+        fprintf(stderr, "%s: %s\n", path, errno == EPROTO ? "bad binary workload" : strerror(errno));
+        exit(1);
+    }
 
-        if (next_idx == -1) {
-            usleep(SCHEDULER_TICK_US);
-            continue;
+    for (uint64_t i = 0; i < wl.hdr->num_tasks; i++) {
+        const wl_task_t *t = &wl.tasks[i];
+        const char *group = wl_string(&wl, t->group);
+        if (!group || t->deps_first > wl.hdr->num_deps || t->deps_count > wl.hdr->num_deps - t->deps_first) {
+            fprintf(stderr, "%s: record %llu is corrupt\n", path, (unsigned long long)i);
+            exit(1);
         }
-
-        process_t *proc = &scheduler.processes[next_idx];
-
-        long elapsed = current_time - scheduler.scheduler_start_time_ms;
-        if (elapsed < proc->arrival_time_ms) {
-            usleep(SCHEDULER_TICK_US);
-            continue;
+        const uint32_t narrowed[] = { t->arrival_ms, t->burst_ms, t->slo_ms, t->io_run_ms, t->io_sleep_ms,
+                                      t->warm_ms, t->lock_hold_ms, t->lock_period_ms, t->disk_kb, t->mem_mb };
+        for (size_t f = 0; f < sizeof(narrowed) / sizeof(narrowed[0]); f++) {
+            if (narrowed[f] > INT_MAX) {
+                fprintf(stderr, "%s: record %llu: value %u out of range\n", path, (unsigned long long)i, narrowed[f]);
+                exit(1);
+            }
         }
 
-        // context switch
-        if (scheduler.current_process_idx != -1 &&
-            scheduler.current_process_idx != next_idx) {
-            process_t *prev = &scheduler.processes[scheduler.current_process_idx];
-            if (prev->state == PROC_RUNNING) {
-                stop_process(prev->pid);
-                prev->state = PROC_STOPPED;
-            }
+        process_t *proc = add_task(t->arrival_ms, t->burst_ms, t->nice);
+        for (uint32_t d = 0; d < t->deps_count; d++) {
+            add_dependency((int)wl.deps[t->deps_first + d], proc->task_id);
+        }
+        proc->slo_target_ms = t->slo_ms;
+        proc->io_run_ms = t->io_run_ms;
+        proc->io_sleep_ms = t->io_sleep_ms;
+        proc->warm_ms = t->warm_ms;
+        proc->lock_hold_ms = t->lock_hold_ms;
+        proc->lock_period_ms = t->lock_period_ms;
+        proc->disk_kb = t->disk_kb;
+        proc->mem_mb = t->mem_mb;
+        if (t->group != 0) {
+            scheduler.groups[proc->group_idx].num_tasks--;
+            proc->group_idx = find_or_add_group(group);
+            scheduler.groups[proc->group_idx].num_tasks++;
         }
 
-        if (proc->state == PROC_READY || proc->state == PROC_STOPPED) {
-            if (proc->first_run == 0) {
-                proc->first_run = 1;
+        char where[300];
+        snprintf(where, sizeof(where), "%s: record %llu", path, (unsigned long long)i);
+        check_task(where, proc);
+    }
+
+    wl_close(&wl);
+
+    if (scheduler.num_processes == 0) {
+        fprintf(stderr, "%s: no tasks\n", path);
+        exit(1);
+    }
+}
+
+void load_default_workload(void) {
+    // test workload
+    struct {
+        int arrival_ms;
+        int burst_ms;
+        int nice;
+    } workload[] = {
+        {0,   60,  0},    // P0: CPU-bound, normal priority
+        {10,  20, -5},    // P1: short, higher priority
+        {15,  80,  5},    // P2: long, lower priority
+        {20,  30,  0},    // P3: medium, normal
+        {30,  15, -10},   // P4: very short, highest priority
+        {35,  50,  0},    // P5: medium, normal
+    };
+
+    int num_tasks = sizeof(workload) / sizeof(workload[0]);
+    for (int i = 0; i < num_tasks; i++) {
+        add_task(workload[i].arrival_ms, workload[i].burst_ms, workload[i].nice);
+    }
+}
+
+/* upward rank = own predicted length + longest rank among children
+   (critical path to a sink). children always have higher ids, so one
+   reverse pass visits them first */
+void compute_upward_ranks(void) {
+    for (int i = scheduler.num_processes - 1; i >= 0; i--) {
+        process_t *proc = &scheduler.processes[i];
+        long longest_child = 0;
+
+        estimate_burst(proc);
+
+        for (int c = 0; c < proc->num_children; c++) {
+            long rank = scheduler.processes[proc->children[c]].upward_rank_ms;
+            if (rank > longest_child) longest_child = rank;
+        }
+
+        proc->upward_rank_ms = proc->estimated_burst_ms + longest_child;
+    }
+}
+
+// O(1) per edge: each child keeps a count of its unfinished parents
+void release_dependents(process_t *proc, long current_time) {
+    for (int i = 0; i < proc->num_children; i++) {
+        process_t *child = &scheduler.processes[proc->children[i]];
+
+        if (--child->pending_parents == 0) {
+            child->state = PROC_READY;
+            child->last_schedule_time_ms = current_time;
+
+            long arrival = scheduler.scheduler_start_time_ms + child->arrival_time_ms;
+            child->ready_since_ms = current_time > arrival ? current_time : arrival;
+        }
+    }
+}
+
+int find_or_add_group(const char *name) {
+    for (int i = 0; i < scheduler.num_groups; i++) {
+        if (strcmp(scheduler.groups[i].name, name) == 0) return i;
+    }
+
+    if (scheduler.num_groups >= MAX_GROUPS) {
+        fprintf(stderr, "too many groups (max %d)\n", MAX_GROUPS);
+        exit(1);
+    }
+
+    group_t *group = &scheduler.groups[scheduler.num_groups];
+    snprintf(group->name, GROUP_NAME_LEN, "%s", name);
+    group->last_update_s = get_wall_time_s();
+    return scheduler.num_groups++;
+}
+
+// lazy exponential decay: usage *= 2^(-elapsed / half_life), O(1)
+void group_decay(group_t *group, double now_s) {
+    if (now_s > group->last_update_s) {
+        group->usage_ms *= exp2(-(now_s - group->last_update_s) / config.fairshare_half_life_s);
+        group->last_update_s = now_s;
+    }
+}
+
+// every group decays at the same rate, so the total can be decayed on its own
+static void total_usage_decay(double now_s) {
+    if (now_s > scheduler.total_update_s) {
+        scheduler.total_usage_ms *= exp2(-(now_s - scheduler.total_update_s) / config.fairshare_half_life_s);
+        scheduler.total_update_s = now_s;
+    }
+}
+
+/* fair-share factor F = 2^(-U/S) where U is the group's share of decayed
+   usage and S its entitled share (equal split among groups with work).
+   F is 1 for an idle history and 0.5 at exactly the entitled share */
+double fairshare_factor(group_t *group, double now_s) {
+    group_decay(group, now_s);
+    total_usage_decay(now_s);
+
+    int active = 0;
+    for (int i = 0; i < scheduler.num_groups; i++) {
+        if (scheduler.groups[i].num_tasks > 0) active++;
+    }
+    if (active == 0 || scheduler.total_usage_ms <= 0.0) return 1.0;
+
+    double used = group->usage_ms / scheduler.total_usage_ms;
+    double entitled = 1.0 / active;
+    return exp2(-used / entitled);
+}
+
+/* fair-share adjustment for a new task: groups over their share get a
+   vruntime debit (returned) and reduced weight, groups at or under it are
+   untouched */
+long fairshare_adjust(process_t *proc, double now_s) {
+    double factor = fairshare_factor(&scheduler.groups[proc->group_idx], now_s);
+    double penalty = 1.0 - 2.0 * factor;
+    if (penalty < 0.0) penalty = 0.0;
+
+    int permille = 1000 - (int)(penalty * (1000 - FAIRSHARE_MIN_WEIGHT_PERMILLE));
+    proc->weight = (int)((long)nice_to_weight(proc->nice_value) * permille / 1000);
+    if (proc->weight < 1) proc->weight = 1;
+    proc->base_weight = proc->weight;
+
+    return (long)(penalty * FAIRSHARE_MAX_DEBIT_NS);
+}
+
+void fairshare_charge(process_t *proc, long executed_time_ms) {
+    double now_s = get_wall_time_s();
+    group_t *group = &scheduler.groups[proc->group_idx];
+
+    group_decay(group, now_s);
+    total_usage_decay(now_s);
+    group->usage_ms += executed_time_ms;
+    scheduler.total_usage_ms += executed_time_ms;
+}
+
+/* state file, one group per line: <name> <usage_ms> <last_update_s>
+   a missing file just means no history yet */
+void load_fairshare_state(const char *path) {
+    FILE *fp = fopen(path, "r");
+    if (!fp) {
+        if (errno != ENOENT) perror(path);
+        return;
+    }
+
+    double now_s = get_wall_time_s();
+    char line[MAX_LINE_LEN];
+    char name[GROUP_NAME_LEN];
+    double usage_ms, last_update_s;
+
+    while (fgets(line, sizeof(line), fp)) {
+        if (line[0] == '#') continue;
+        if (sscanf(line, "%31s %lf %lf", name, &usage_ms, &last_update_s) != 3) continue;
+
+        group_t *group = &scheduler.groups[find_or_add_group(name)];
+        group->usage_ms = usage_ms;
+        group->last_update_s = last_update_s;
+        group_decay(group, now_s);
+        scheduler.total_usage_ms += group->usage_ms;
+    }
+    scheduler.total_update_s = now_s;
+
+    fclose(fp);
+}
+
+// written to a temp file and renamed so a crash never leaves a torn state file
+void save_fairshare_state(const char *path) {
+    char tmp_path[PATH_MAX];
+    snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", path);
+
+    FILE *fp = fopen(tmp_path, "w");
+    if (!fp) {
+        perror(tmp_path);
+        return;
+    }
+
+    double now_s = get_wall_time_s();
+    fprintf(fp, "# cfs fair-share state: <group> <decayed_usage_ms> <wall_time_s>\n");
+    for (int i = 0; i < scheduler.num_groups; i++) {
+        group_t *group = &scheduler.groups[i];
+        group_decay(group, now_s);
+        if (group->usage_ms <= 0.0 && group->num_tasks == 0) continue;
+        fprintf(fp, "%s %.3f %.3f\n", group->name, group->usage_ms, group->last_update_s);
+    }
+
+    if (fclose(fp) != 0 || rename(tmp_path, path) != 0) {
+        perror(path);
+    }
+}
+
+/* ---- dominant resource fairness ---- */
+
+/* a group holds two resources: cpu, as its share of recently dispatched time
+   (decayed with DRF_HALF_LIFE_MS), and memory, as the demand of its admitted,
+   unfinished tasks over the capacity. its dominant share is the larger one.
+   with -D the next pick goes to the group with the lowest dominant share, so a
+   tenant whose jobs pin memory gets correspondingly less cpu */
+static void drf_decay(double *cpu_ms, long *update_ms, long now) {
+    if (now > *update_ms) {
+        *cpu_ms *= exp2(-(now - *update_ms) / DRF_HALF_LIFE_MS);
+        *update_ms = now;
+    }
+}
+
+double drf_dominant_share(group_t *group, long current_time) {
+    drf_decay(&group->drf_cpu_ms, &group->drf_update_ms, current_time);
+    drf_decay(&scheduler.drf_cpu_ms, &scheduler.drf_update_ms, current_time);
+
+    double cpu = scheduler.drf_cpu_ms > 0.0 ? group->drf_cpu_ms / scheduler.drf_cpu_ms : 0.0;
+    double mem = (double)group->mem_held_mb / config.mem_capacity_mb;
+    return cpu > mem ? cpu : mem;
+}
+
+// the first memory task always fits, so one larger than the capacity still runs
+static int drf_fits(process_t *proc) {
+    return scheduler.drf_mem_used_mb == 0 ||
+           scheduler.drf_mem_used_mb + proc->mem_mb <= config.mem_capacity_mb;
+}
+
+static int drf_waiting(process_t *proc, long elapsed) {
+    return proc->mem_mb > 0 && !proc->arrived && proc->state == PROC_READY &&
+           elapsed >= proc->arrival_time_ms;
+}
+
+/* with -D a memory task is admitted only while its demand fits next to the
+   admitted ones. when several wait, the one whose group has the lowest
+   dominant share goes first. returns 1 when proc may be admitted now */
+int drf_admit(process_t *proc, long current_time) {
+    if (!config.drf || proc->mem_mb == 0) return 1;
+
+    long elapsed = current_time - scheduler.scheduler_start_time_ms;
+    group_t *group = &scheduler.groups[proc->group_idx];
+    if (proc->eligible_ms == 0) proc->eligible_ms = current_time;
+
+    int admit = drf_fits(proc);
+    if (admit) {
+        double share = drf_dominant_share(group, current_time);
+        for (int i = 0; i < scheduler.num_processes && admit; i++) {
+            process_t *other = &scheduler.processes[i];
+            if (other == proc || !drf_waiting(other, elapsed) || !drf_fits(other)) continue;
+            if (drf_dominant_share(&scheduler.groups[other->group_idx], current_time) < share) admit = 0;
+        }
+    }
+
+    if (!admit) {
+        proc->admission = ADMIT_HELD_MEMORY;
+        atomic_store(&shared_page->tasks[proc - scheduler.processes].admission, ADMIT_HELD_MEMORY);
+    }
+    if (!admit && !proc->drf_deferred) {
+        CFS_PROBE3(throttle, proc->task_id, proc->vruntime_ns, THROTTLE_DRF_HOLD);
+        trace_emit(TR_THROTTLE, proc->task_id, THROTTLE_DRF_HOLD);
+        proc->drf_deferred = 1;
+        group->deferred++;
+        printf("[T=%4ld ms] DRF: holding P%d (%d MiB), %d of %d MiB admitted\n",
+               elapsed, proc->task_id, proc->mem_mb, scheduler.drf_mem_used_mb, config.mem_capacity_mb);
+    }
+    if (admit) group->deferred_ms += current_time - proc->eligible_ms;
+    return admit;
+}
+
+// memory demand is the declared mem= size; an admitted task holds it until it completes
+static void drf_hold(process_t *proc) {
+    proc->drf_mem_mb = proc->mem_mb;
+    scheduler.groups[proc->group_idx].mem_held_mb += proc->drf_mem_mb;
+    scheduler.drf_mem_used_mb += proc->drf_mem_mb;
+}
+
+void drf_release(process_t *proc) {
+    scheduler.groups[proc->group_idx].mem_held_mb -= proc->drf_mem_mb;
+    scheduler.drf_mem_used_mb -= proc->drf_mem_mb;
+    proc->drf_mem_mb = 0;
+}
+
+// groups with work: arrived (admitted or waiting to be) and not completed
+static int drf_contended(long current_time) {
+    long elapsed = current_time - scheduler.scheduler_start_time_ms;
+    unsigned live = 0;
+    for (int i = 0; i < scheduler.num_processes; i++) {
+        process_t *proc = &scheduler.processes[i];
+        if (proc->state != PROC_COMPLETED && elapsed >= proc->arrival_time_ms) {
+            live |= 1u << proc->group_idx;
+        }
+    }
+    return live & (live - 1);
+}
+
+void drf_charge(process_t *proc, long executed_time_ms, long current_time) {
+    group_t *group = &scheduler.groups[proc->group_idx];
+
+    drf_decay(&group->drf_cpu_ms, &group->drf_update_ms, current_time);
+    drf_decay(&scheduler.drf_cpu_ms, &scheduler.drf_update_ms, current_time);
+    group->drf_cpu_ms += executed_time_ms;
+    scheduler.drf_cpu_ms += executed_time_ms;
+    if (drf_contended(current_time)) group->contended_cpu_ms += executed_time_ms;
+}
+
+// memory held over time while two or more groups compete, for the report
+void drf_account(long current_time) {
+    long dt = scheduler.drf_last_ms ? current_time - scheduler.drf_last_ms : 0;
+    scheduler.drf_last_ms = current_time;
+    if (!drf_contended(current_time)) return;
+
+    scheduler.drf_contended_ms += dt;
+    for (int i = 0; i < scheduler.num_groups; i++) {
+        scheduler.groups[i].contended_mem_mb_ms += (double)scheduler.groups[i].mem_held_mb * dt;
+    }
+}
+
+/* ---- overload admission control ---- */
+
+/* predicted remaining work: the burst estimate (the declared burst until
+   estimate_burst() has run) minus progress. a task past its estimate is
+   expected to need at least one more quantum */
+static long predicted_remaining_ms(process_t *proc) {
+    long predicted = proc->estimated_burst_ms ? proc->estimated_burst_ms : proc->burst_time_ms;
+    long left = predicted - (proc->burst_time_ms - proc->remaining_time_ms);
+    return left > TIME_QUANTUM_MS ? left : TIME_QUANTUM_MS;
+}
+
+/* predicted final wait of every admitted, unfinished task (plus cand, when
+   given) under processor sharing: a task still waits for min(rem_i, rem_j)
+   of every other task's predicted remaining work, at the delivered cpu rate,
+   on top of what it has waited already. returns the p99 of those waits */
+long predict_p99_wait(process_t *cand, long current_time) {
+    long elapsed = current_time - scheduler.scheduler_start_time_ms;
+    process_t *set[MAX_PROCESSES];
+    long waits[MAX_PROCESSES], left[MAX_PROCESSES];
+    int n = 0;
+
+    for (int i = 0; i < scheduler.num_processes; i++) {
+        process_t *proc = &scheduler.processes[i];
+        if (proc->arrived && proc->state != PROC_COMPLETED) set[n++] = proc;
+    }
+    if (cand) set[n++] = cand;
+    if (n == 0) return 0;
+    for (int j = 0; j < n; j++) left[j] = predicted_remaining_ms(set[j]);
+
+    for (int j = 0; j < n; j++) {
+        process_t *pj = set[j];
+        long waited = elapsed - pj->arrival_time_ms - (pj->burst_time_ms - pj->remaining_time_ms) -
+                      pj->total_sleep_ms;
+        if (waited < 0) waited = 0;
+
+        long ahead = 0;
+        for (int i = 0; i < n; i++) {
+            if (i == j) continue;
+            ahead += left[i] < left[j] ? left[i] : left[j];
+        }
+        long wait = waited + (long)(ahead / scheduler.admit_rate);
+
+        // insertion sort, n is at most MAX_PROCESSES
+        int k = j;
+        while (k > 0 && waits[k - 1] > wait) {
+            waits[k] = waits[k - 1];
+            k--;
+        }
+        waits[k] = wait;
+    }
+    return waits[(n * 99 + 99) / 100 - 1];
+}
+
+static void admission_publish(process_t *proc, long p99) {
+    scheduler.admit_p99_ms = p99;
+    atomic_store(&shared_page->tasks[proc - scheduler.processes].admission, proc->admission);
+    atomic_store(&shared_page->admit_p99_ms, p99);
+    atomic_store(&shared_page->admit_retry_ms,
+                 p99 > config.admit_target_ms ? p99 - config.admit_target_ms : 0);
+    atomic_store(&shared_page->admit_queued, scheduler.admit_queued);
+    atomic_store(&shared_page->admit_level,
+                 proc->admission >= ADMIT_REJECT_QUEUE_FULL ? 2 : scheduler.admit_queued > 0 ? 1 : 0);
+}
+
+/* a rejected task never runs: its worker is killed and the task counts as
+   done so the loop can finish. tasks that depend on it are rejected too */
+static void admission_reject(process_t *proc, admit_reason_t reason, long current_time) {
+    if (proc->admission == ADMIT_QUEUED) scheduler.admit_queued--;
+    proc->admission = reason;
+    scheduler.admit_counts[reason]++;
+    atomic_fetch_add(&shared_page->admit_rejected, 1);
+
+    CFS_PROBE3(throttle, proc->task_id, proc->vruntime_ns, THROTTLE_REJECT);
+    trace_emit(TR_THROTTLE, proc->task_id, THROTTLE_REJECT);
+    kill(proc->pid, SIGKILL);
+    proc->state = PROC_COMPLETED;
+    proc->finish_time_ms = current_time;
+    scheduler.completed_count++;
+    printf("[T=%4ld ms] Admission: P%d %s\n",
+           current_time - scheduler.scheduler_start_time_ms, proc->task_id, admit_reason_names[reason]);
+
+    for (int i = 0; i < proc->num_children; i++) {
+        process_t *child = &scheduler.processes[proc->children[i]];
+        if (child->state != PROC_COMPLETED) admission_reject(child, ADMIT_REJECT_PARENT, current_time);
+    }
+}
+
+/* with -O, a submission is admitted only while the predicted p99 wait,
+   counting it, stays within the target. otherwise it waits in a bounded
+   queue and is re-evaluated every tick; it is rejected when the queue is
+   full, or once its own wait has passed the target. returns 1 to admit */
+int admission_control(process_t *proc, long current_time) {
+    if (config.admit_target_ms <= 0) {
+        proc->admission = ADMIT_OK;
+        return 1;
+    }
+
+    long waited = current_time - scheduler.scheduler_start_time_ms - proc->arrival_time_ms;
+    long p99 = predict_p99_wait(proc, current_time);
+
+    if (p99 <= config.admit_target_ms) {
+        if (proc->admission == ADMIT_QUEUED) scheduler.admit_queued--;
+        proc->admission = ADMIT_OK;
+        scheduler.admit_counts[ADMIT_OK]++;
+        admission_publish(proc, p99);
+        return 1;
+    }
+
+    if (proc->admission == ADMIT_QUEUED) {
+        if (waited >= config.admit_target_ms) {
+            admission_reject(proc, ADMIT_REJECT_TIMEOUT, current_time);
+            admission_publish(proc, p99);
+        }
+        return 0;
+    }
+
+    if (scheduler.admit_queued >= ADMIT_QUEUE_MAX) {
+        admission_reject(proc, ADMIT_REJECT_QUEUE_FULL, current_time);
+    } else {
+        CFS_PROBE3(throttle, proc->task_id, proc->vruntime_ns, THROTTLE_ADMIT_QUEUE);
+        trace_emit(TR_THROTTLE, proc->task_id, THROTTLE_ADMIT_QUEUE);
+        proc->admission = ADMIT_QUEUED;
+        scheduler.admit_queued++;
+        scheduler.admit_counts[ADMIT_QUEUED]++;
+    }
+    admission_publish(proc, p99);
+    return 0;
+}
+
+/* delivered cpu rate: progress per wall ms over windows in which the cpu
+   was never idle, smoothed. below 1 when warm-ups, spinning and the
+   scheduler itself eat into the cpu */
+void admission_track(long progress_ms, long current_time) {
+    if (scheduler.rate_start_ms == 0) {
+        scheduler.rate_start_ms = current_time;
+        return;
+    }
+    scheduler.rate_progress_ms += progress_ms;
+    long window = current_time - scheduler.rate_start_ms;
+    if (window < ADMIT_RATE_PERIOD_MS) return;
+
+    if (!scheduler.rate_idle) {
+        double rate = (double)scheduler.rate_progress_ms / window;
+        if (rate > 1.0) rate = 1.0;
+        if (rate < 0.1) rate = 0.1;
+        scheduler.admit_rate += ADMIT_RATE_ALPHA * (rate - scheduler.admit_rate);
+    }
+    scheduler.rate_start_ms = current_time;
+    scheduler.rate_progress_ms = 0;
+    scheduler.rate_idle = 0;
+}
+
+/* enqueues tasks that became runnable: the first time a task is both
+   arrived and released, and whenever a sleeper's wake time has passed */
+void admit_arrivals(long current_time) {
+    long elapsed = current_time - scheduler.scheduler_start_time_ms;
+    double now_s = get_wall_time_s();
+
+    for (int i = 0; i < scheduler.num_processes; i++) {
+        process_t *proc = &scheduler.processes[i];
+
+        if (proc->state == PROC_SLEEPING && current_time >= proc->wake_time_ms) {
+            if (proc->disk_kb > 0) {
+                slice_page_t *page = &shared_page->tasks[i];
+                int phase = atomic_load(&page->io_request);
+                siginfo_t info = { 0 };
+                // a worker that already exited will not serve the phase; leave it for waitpid
+                if (atomic_load(&page->io_done) != phase &&
+                    !(waitid(P_PID, proc->pid, &info, WEXITED | WNOHANG | WNOWAIT) == 0 &&
+                      info.si_pid == proc->pid)) {
+                    continue;
+                }
+                stop_process(proc->pid);
+                atomic_store(&page->io_release, phase);
+                proc->disk_phases++;
+                proc->disk_ms += current_time - (proc->wake_time_ms - proc->io_sleep_ms);
+            }
+            proc->total_sleep_ms += current_time - (proc->wake_time_ms - proc->io_sleep_ms);
+            proc->state = PROC_STOPPED;
+            proc->last_schedule_time_ms = current_time;
+            proc->ready_since_ms = current_time;
+            place_task(proc, 1, 0);
+            CFS_PROBE3(wake, proc->task_id, proc->vruntime_ns, proc->total_sleep_ms);
+            trace_emit(TR_WAKE, proc->task_id, 0);
+            continue;
+        }
+
+        if (proc->arrived || proc->state != PROC_READY || elapsed < proc->arrival_time_ms) {
+            continue;
+        }
+        if (!drf_admit(proc, current_time)) continue;
+        if (!admission_control(proc, current_time)) continue;
+
+        proc->arrived = 1;
+        drf_hold(proc);
+        place_task(proc, 0, fairshare_adjust(proc, now_s));
+        CFS_PROBE3(arrive, proc->task_id, proc->vruntime_ns, proc->weight);
+        trace_emit(TR_ARRIVE, proc->task_id, 0);
+        sync_io_priority(proc);
+        shadow_emit(EV_ARRIVE, i, current_time, proc->vruntime_ns, 0, 0);
+    }
+}
+
+static int on_run_queue(process_t *proc) {
+    return proc->arrived && (proc->state == PROC_READY ||
+                             proc->state == PROC_STOPPED ||
+                             proc->state == PROC_RUNNING);
+}
+
+// min_vruntime only moves forward, tracking the smallest queued vruntime
+void update_min_vruntime(void) {
+    unsigned long lowest = 0;
+    int found = 0;
+
+    for (int i = 0; i < scheduler.num_processes; i++) {
+        process_t *proc = &scheduler.processes[i];
+        if (!on_run_queue(proc)) continue;
+        if (!found || proc->vruntime_ns < lowest) {
+            lowest = proc->vruntime_ns;
+            found = 1;
+        }
+    }
+
+    if (found && lowest > scheduler.min_vruntime_ns) {
+        scheduler.min_vruntime_ns = lowest;
+    }
+}
+
+// weight-averaged vruntime of the queue (the zero-lag point)
+long avg_vruntime(void) {
+    long double sum = 0;
+    long total_weight = 0;
+
+    for (int i = 0; i < scheduler.num_processes; i++) {
+        process_t *proc = &scheduler.processes[i];
+        if (!on_run_queue(proc)) continue;
+        sum += (long double)proc->vruntime_ns * proc->weight;
+        total_weight += proc->weight;
+    }
+
+    return total_weight ? (long)(sum / total_weight) : (long)scheduler.min_vruntime_ns;
+}
+
+// one time quantum expressed in this task's virtual time
+long vslice_ns(process_t *proc) {
+    return TIME_QUANTUM_MS * 1000000LL * CFS_WEIGHT_NICE_0 / proc->weight;
+}
+
+/* where a new or waking task enters the timeline:
+   legacy - new tasks at min_vruntime, sleepers keep their old vruntime
+   debit  - new tasks one slice behind min_vruntime so forks can't jump
+            the queue; sleepers get at most SLEEPER_CREDIT_NS of credit
+   lag    - new tasks at the average (zero lag); sleepers resume with the
+            lag they had when they blocked, clamped to two slices */
+void place_task(process_t *proc, int wakeup, long fairshare_debit) {
+    long vruntime;
+
+    switch (config.placement) {
+    case PLACE_LEGACY:
+        vruntime = wakeup ? (long)proc->vruntime_ns : (long)scheduler.min_vruntime_ns;
+        break;
+    case PLACE_DEBIT:
+        if (wakeup) {
+            long floor = (long)scheduler.min_vruntime_ns - SLEEPER_CREDIT_NS;
+            vruntime = (long)proc->vruntime_ns > floor ? (long)proc->vruntime_ns : floor;
+        } else {
+            vruntime = scheduler.min_vruntime_ns + vslice_ns(proc);
+        }
+        break;
+    default: {
+        long lag = wakeup ? proc->lag_ns : 0;
+        long limit = 2 * vslice_ns(proc);
+        if (lag > limit) lag = limit;
+        if (lag < -limit) lag = -limit;
+        vruntime = avg_vruntime() - lag;
+        break;
+    }
+    }
+
+    vruntime += fairshare_debit;
+    proc->vruntime_ns = vruntime > 0 ? (unsigned long)vruntime : 0;
+}
+
+// emulated i/o wait: the (already stopped) task leaves the run queue for io_sleep_ms
+// a disk worker is resumed off the run queue to do its i/o for real
+void put_to_sleep(process_t *proc, long current_time) {
+    proc->lag_ns = avg_vruntime() - (long)proc->vruntime_ns;
+    proc->state = PROC_SLEEPING;
+    proc->wake_time_ms = current_time + proc->io_sleep_ms;
+    proc->ran_since_wake_ms = 0;
+    CFS_PROBE3(sleep, proc->task_id, proc->vruntime_ns, proc->io_sleep_ms);
+    trace_emit(TR_SLEEP, proc->task_id, proc->io_sleep_ms);
+
+    if (proc->disk_kb > 0) {
+        atomic_fetch_add(&shared_page->tasks[proc->task_id].io_request, 1);
+        continue_process(proc->pid);
+    }
+}
+
+/* dispatch latency = time from becoming runnable to getting the cpu.
+   the window ring and histogram always describe the last SLO_WINDOW samples */
+void record_dispatch_latency(process_t *proc, long current_time) {
+    long latency = current_time - proc->ready_since_ms;
+    if (latency < 0) latency = 0;
+
+    int bucket = latency < SLO_HIST_BUCKETS - 1 ? (int)latency : SLO_HIST_BUCKETS - 1;
+    int slot = proc->latency_samples % SLO_WINDOW;
+
+    if (proc->latency_samples >= SLO_WINDOW) {
+        proc->latency_hist[proc->latency_window[slot]]--;
+    }
+    proc->latency_window[slot] = bucket;
+    proc->latency_hist[bucket]++;
+    proc->latency_samples++;
+
+    if (proc->slo_target_ms > 0 && latency <= proc->slo_target_ms) {
+        proc->latency_met++;
+    }
+}
+
+/* ---- bounded-wait watchdog ---- */
+
+/* the aging boost saturates, so under enough interactive load a long task can
+   still wait forever. with -W a timerfd ticks WATCHDOG_TICKS times per bound,
+   independent of picks, and forces a dispatch of the longest-waiting task once
+   it reaches WATCHDOG_MARGIN_PCT of the bound. created after the forks so the
+   children do not inherit it. the bound is best effort: one task is forced
+   per tick, so waiters that cross the threshold together are served a tick
+   apart, and tasks parked under memory pressure (-R) are exempt, since
+   forcing them would undo the parking */
+void watchdog_start(void) {
+    scheduler.watchdog_fd = -1;
+    scheduler.forced_idx = -1;
+    if (config.max_wait_ms <= 0) return;
+
+    int fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (fd < 0) {
+        perror("timerfd_create");
+        exit(1);
+    }
+
+    long period_ms = config.max_wait_ms / WATCHDOG_TICKS;
+    if (period_ms < 1) period_ms = 1;
+    struct itimerspec its;
+    its.it_interval.tv_sec = period_ms / 1000;
+    its.it_interval.tv_nsec = (period_ms % 1000) * 1000000L;
+    its.it_value = its.it_interval;
+    if (timerfd_settime(fd, 0, &its, NULL) < 0) {
+        perror("timerfd_settime");
+        exit(1);
+    }
+    scheduler.watchdog_fd = fd;
+}
+
+/* consumes pending timer expirations. returns 1 when a task other than the
+   running one is close enough to the bound that the current slice must end */
+int watchdog_tick(long current_time) {
+    uint64_t expirations;
+    if (scheduler.watchdog_fd < 0) return 0;
+    if (read(scheduler.watchdog_fd, &expirations, sizeof(expirations)) != sizeof(expirations)) return 0;
+
+    long threshold = (long)config.max_wait_ms * WATCHDOG_MARGIN_PCT / 100;
+    long worst = -1;
+    int worst_idx = -1;
+    for (int i = 0; i < scheduler.num_processes; i++) {
+        process_t *proc = &scheduler.processes[i];
+        if (!on_run_queue(proc) || i == scheduler.current_process_idx || memory_parked(proc)) continue;
+
+        long wait = current_time - proc->ready_since_ms;
+        if (wait >= threshold && wait > worst) {
+            worst = wait;
+            worst_idx = i;
+        }
+    }
+    if (worst_idx == -1 || worst_idx == scheduler.forced_idx) return 0;
+
+    scheduler.forced_idx = worst_idx;
+    scheduler.watchdog_fires++;
+    printf("[T=%4ld ms] Watchdog: P%d waited %ld ms (bound %d ms), forcing dispatch\n",
+           current_time - scheduler.scheduler_start_time_ms,
+           scheduler.processes[worst_idx].task_id, worst, config.max_wait_ms);
+    return 1;
+}
+
+/* lets the running task have its slice. the watchdog may end it early, and a
+   psi trigger firing meanwhile is handled at once (poll skips negative fds) */
+void run_slice(int slice_ms) {
+    if (scheduler.watchdog_fd < 0 && scheduler.psi_fd < 0) {
+        usleep(slice_ms * 1000);
+        return;
+    }
+
+    long end = get_time_ms() + slice_ms;
+    for (;;) {
+        long left = end - get_time_ms();
+        if (left <= 0) return;
+
+        struct pollfd pfds[2] = {
+            { scheduler.watchdog_fd, POLLIN, 0 },
+            { scheduler.psi_fd, POLLPRI, 0 },
+        };
+        if (poll(pfds, 2, (int)left) <= 0) continue;
+
+        if (pfds[1].revents & POLLPRI) {
+            run_memory_control(get_time_ms(), 1);
+        }
+        if ((pfds[0].revents & POLLIN) && watchdog_tick(get_time_ms())) return;
+    }
+}
+
+// how close each dispatch came to the bound, in WAIT_BANDS bands
+void record_bounded_wait(process_t *proc, long current_time) {
+    long wait = current_time - proc->ready_since_ms;
+    if (wait < 0) wait = 0;
+    if (wait > proc->max_dispatch_wait_ms) proc->max_dispatch_wait_ms = wait;
+    if (config.max_wait_ms <= 0) return;
+
+    // a wait of exactly the bound is within it; only the last band violates
+    int over = wait > config.max_wait_ms;
+    int band = over ? WAIT_BANDS : (int)(wait * WAIT_BANDS / config.max_wait_ms);
+    if (band == WAIT_BANDS && !over) band = WAIT_BANDS - 1;
+    if (over) scheduler.wait_violations++;
+    scheduler.wait_bands[band]++;
+    scheduler.wait_samples++;
+}
+
+/* ---- slice extension for critical sections ---- */
+
+/* at slice expiry a worker inside a critical section gets up to SLICE_EXT_MS
+   more instead of SIGSTOP, so its lock is not left held by a stopped task.
+   capped per task at SLICE_EXT_BUDGET_PCT of its burst; a worker that uses up
+   the extension still holding the lock is an overrun, and after
+   SLICE_EXT_MAX_OVERRUNS of them it is not extended again */
+void grant_slice_extension(process_t *proc, int idx) {
+    slice_page_t *page = &shared_page->tasks[idx];
+    if (!atomic_load(&page->in_critical)) return;
+
+    if (proc->ext_revoked || proc->ext_ms * 100 >= (long)proc->burst_time_ms * SLICE_EXT_BUDGET_PCT) {
+        proc->ext_denied++;
+        return;
+    }
+
+    atomic_store(&page->yielded, 0);
+    atomic_store(&page->extended, 1);
+    long start = get_time_ms();
+    while (!atomic_load(&page->yielded) && get_time_ms() - start < SLICE_EXT_MS) {
+        usleep(SLICE_EXT_POLL_US);
+    }
+    proc->ext_granted++;
+    proc->ext_ms += get_time_ms() - start;
+
+    if (!atomic_load(&page->yielded)) {
+        atomic_store(&page->extended, 0);
+        if (++proc->ext_overruns >= SLICE_EXT_MAX_OVERRUNS && !proc->ext_revoked) {
+            proc->ext_revoked = 1;
+            printf("[T=%4ld ms] P%d overran %d slice extensions, no longer extended\n",
+                   get_time_ms() - scheduler.scheduler_start_time_ms, proc->task_id, proc->ext_overruns);
+        }
+    }
+}
+
+/* ---- memory pressure ---- */
+
+// "some avg10" of a psi file in percent, 0 when unavailable
+static double psi_avg10(const char *path) {
+    FILE *fp = fopen(path, "r");
+    double avg10 = 0.0;
+    if (!fp) return 0.0;
+    if (fscanf(fp, "some avg10=%lf", &avg10) != 1) avg10 = 0.0;
+    fclose(fp);
+    return avg10;
+}
+
+/* registers a psi trigger on memory stalls; the fd raises POLLPRI when the
+   stall threshold is crossed within a window. kernels or containers without
+   trigger support fall back to sampling avg10 */
+void memory_start(void) {
+    scheduler.psi_fd = -1;
+    for (int i = 0; i < scheduler.num_processes; i++) {
+        if (scheduler.processes[i].mem_mb > 0) scheduler.mem_limit++;
+    }
+    scheduler.mem_limit_min = scheduler.mem_limit;
+    if (!config.mem_control || scheduler.mem_limit == 0) return;
+
+    int fd = open(PSI_MEMORY_PATH, O_RDWR | O_NONBLOCK | O_CLOEXEC);
+    if (fd >= 0) {
+        char trigger[64];
+        int len = snprintf(trigger, sizeof(trigger), "some %d %d", PSI_STALL_US, PSI_WINDOW_US);
+        if (write(fd, trigger, len + 1) == len + 1) {
+            scheduler.psi_fd = fd;
+            return;
+        }
+        close(fd);
+    }
+    fprintf(stderr, "psi triggers unavailable (%s), sampling avg10 instead\n", strerror(errno));
+}
+
+// rss (kB) and major faults of a live child from /proc/<pid>/stat
+static int read_task_memory(pid_t pid, long *rss_kb, long *maj_faults) {
+    char path[64], buf[1024];
+    snprintf(path, sizeof(path), "/proc/%d/stat", (int)pid);
+    FILE *fp = fopen(path, "r");
+    if (!fp) return -1;
+    size_t n = fread(buf, 1, sizeof(buf) - 1, fp);
+    fclose(fp);
+    buf[n] = '\0';
+
+    // fields after the parenthesized comm: state is field 3, majflt 12, rss 24
+    char *p = strrchr(buf, ')');
+    if (!p) return -1;
+    long majflt, rss_pages;
+    if (sscanf(p + 2, "%*c %*d %*d %*d %*d %*d %*u %*u %*u %ld %*u %*u %*u %*d %*d %*d %*d %*d %*d %*u %*u %ld",
+               &majflt, &rss_pages) != 2) {
+        return -1;
+    }
+    *maj_faults = majflt;
+    *rss_kb = rss_pages * (sysconf(_SC_PAGESIZE) / 1024);
+    return 0;
+}
+
+int memory_parked(process_t *proc) {
+    if (!config.mem_control || proc->mem_mb == 0 || proc->mem_active) return 0;
+
+    int active = 0;
+    for (int i = 0; i < scheduler.num_processes; i++) {
+        process_t *other = &scheduler.processes[i];
+        if (other->mem_active && other->state != PROC_COMPLETED) active++;
+    }
+    return active >= scheduler.mem_limit;
+}
+
+/* drops the heaviest active memory task (by rss) from the active set; it
+   stays stopped and its pages may be reclaimed, but it no longer competes
+   with the rest for memory */
+static void memory_shrink(long current_time) {
+    int victim = -1, active = 0;
+    for (int i = 0; i < scheduler.num_processes; i++) {
+        process_t *proc = &scheduler.processes[i];
+        if (!proc->mem_active || proc->state == PROC_COMPLETED) continue;
+        active++;
+        if (victim == -1 || proc->rss_kb > scheduler.processes[victim].rss_kb) victim = i;
+    }
+    scheduler.mem_limit = active > 1 ? active - 1 : 1;
+    if (scheduler.mem_limit < scheduler.mem_limit_min) scheduler.mem_limit_min = scheduler.mem_limit;
+    if (active <= 1) return;
+
+    process_t *proc = &scheduler.processes[victim];
+    proc->mem_active = 0;
+    proc->mem_parked++;
+    CFS_PROBE3(throttle, proc->task_id, proc->vruntime_ns, THROTTLE_MEM_PARK);
+    trace_emit(TR_THROTTLE, proc->task_id, THROTTLE_MEM_PARK);
+    printf("[T=%4ld ms] Memory pressure: parked P%d (rss %ld MiB), active set limit %d\n",
+           current_time - scheduler.scheduler_start_time_ms, proc->task_id,
+           proc->rss_kb / 1024, scheduler.mem_limit);
+}
+
+// nonblocking check of the psi trigger. polling consumes the event
+int psi_poll(void) {
+    if (scheduler.psi_fd < 0) return 0;
+    struct pollfd pfd = { scheduler.psi_fd, POLLPRI, 0 };
+    return poll(&pfd, 1, 0) > 0 && (pfd.revents & POLLPRI);
+}
+
+/* every MEM_SAMPLE_PERIOD_MS: rss and major faults of every live child and
+   psi averages for the report. with -R, pressure (a trigger event, or avg10
+   above PSI_AVG10_PCT without triggers) shrinks the active set by one; after
+   MEM_CALM_MS without pressure it grows back one task at a time */
+void run_memory_control(long current_time, int psi_fired) {
+    int pressure = psi_fired;
+    if (psi_fired) scheduler.psi_events++;
+
+    if (current_time - scheduler.mem_last_sample_ms >= MEM_SAMPLE_PERIOD_MS) {
+        scheduler.mem_last_sample_ms = current_time;
+
+        for (int i = 0; i < scheduler.num_processes; i++) {
+            process_t *proc = &scheduler.processes[i];
+            if (proc->mem_mb == 0 || proc->state == PROC_COMPLETED) continue;
+            if (read_task_memory(proc->pid, &proc->rss_kb, &proc->maj_faults) == 0 &&
+                proc->rss_kb > proc->peak_rss_kb) {
+                proc->peak_rss_kb = proc->rss_kb;
+            }
+        }
+
+        double mem = psi_avg10(PSI_MEMORY_PATH);
+        double cpu = psi_avg10(PSI_CPU_PATH);
+        if (mem > scheduler.psi_mem_peak) scheduler.psi_mem_peak = mem;
+        if (cpu > scheduler.psi_cpu_peak) scheduler.psi_cpu_peak = cpu;
+        if (config.mem_control && scheduler.psi_fd < 0 && mem >= PSI_AVG10_PCT) pressure = 1;
+    }
+
+    if (!config.mem_control) return;
+
+    if (pressure) {
+        scheduler.mem_pressure_ms = current_time;
+        memory_shrink(current_time);
+        return;
+    }
+
+    int total = 0;
+    for (int i = 0; i < scheduler.num_processes; i++) {
+        if (scheduler.processes[i].mem_mb > 0) total++;
+    }
+    if (scheduler.mem_limit < total && current_time - scheduler.mem_pressure_ms >= MEM_CALM_MS) {
+        scheduler.mem_limit++;
+        scheduler.mem_pressure_ms = current_time;
+    }
+}
+
+/* ---- i/o priority coordination ---- */
+
+/* maps the effective weight to an i/o priority the way the kernel derives one
+   from nice (best-effort level = (nice + 20) / 5), so fair-share and slo
+   adjustments reach the disk too. weight at the nice 19 floor stays at level 7
+   and is never demoted to the idle class, which the disk would only serve when
+   it is otherwise idle. only the bfq i/o scheduler honours these */
+void sync_io_priority(process_t *proc) {
+    if (!config.io_priority || proc->pid <= 0) return;
+
+    int nice = 19;
+    for (int n = -20; n <= 19; n++) {
+        if (nice_to_weight(n) <= proc->weight) {
+            nice = n;
+            break;
+        }
+    }
+    int level = (nice + 20) / 5;
+    if (level == proc->io_level) return;
+
+    if (syscall(SYS_ioprio_set, IOPRIO_WHO_PROCESS, proc->pid, IOPRIO_PRIO_VALUE(IOPRIO_CLASS_BE, level)) < 0) {
+        // a worker that has just exited is its own problem, not the feature's
+        if (errno == ESRCH) return;
+        int err = errno;
+        perror("ioprio_set");
+        if (err == EPERM || err == EINVAL) config.io_priority = 0;
+        return;
+    }
+    proc->io_level = level;
+    proc->io_updates++;
+}
+
+// percentile over the sliding window, in ms (bucket resolution)
+int latency_percentile(process_t *proc, int pct) {
+    long n = proc->latency_samples < SLO_WINDOW ? proc->latency_samples : SLO_WINDOW;
+    if (n == 0) return 0;
+
+    long rank = (n * pct + 99) / 100;
+    long seen = 0;
+    for (int b = 0; b < SLO_HIST_BUCKETS; b++) {
+        seen += proc->latency_hist[b];
+        if (seen >= rank) return b;
+    }
+    return SLO_HIST_BUCKETS - 1;
+}
+
+/* pi controller on p99 latency: raise the effective weight while the
+   target is missed, hand it back toward the nice weight once it is met.
+   the per-period change is capped so one bad window can't swing shares */
+void slo_control_step(process_t *proc) {
+    long error = latency_percentile(proc, 99) - proc->slo_target_ms;
+
+    proc->slo_integral += error;
+    if (proc->slo_integral > SLO_INTEGRAL_LIMIT) proc->slo_integral = SLO_INTEGRAL_LIMIT;
+    if (proc->slo_integral < -SLO_INTEGRAL_LIMIT) proc->slo_integral = -SLO_INTEGRAL_LIMIT;
+
+    long step = SLO_KP * error + SLO_KI * proc->slo_integral;
+    if (step > SLO_MAX_STEP_PERMILLE) step = SLO_MAX_STEP_PERMILLE;
+    if (step < -SLO_MAX_STEP_PERMILLE) step = -SLO_MAX_STEP_PERMILLE;
+
+    long weight = proc->weight + (proc->weight * step) / 1000;
+    if (weight < proc->base_weight) weight = proc->base_weight;
+    if (weight > nice_to_weight(-20)) weight = nice_to_weight(-20);
+    proc->weight = (int)weight;
+}
+
+void run_slo_controller(long current_time) {
+    if (current_time - scheduler.last_slo_control_ms < SLO_CONTROL_PERIOD_MS) {
+        return;
+    }
+    scheduler.last_slo_control_ms = current_time;
+
+    for (int i = 0; i < scheduler.num_processes; i++) {
+        process_t *proc = &scheduler.processes[i];
+        if (proc->slo_target_ms > 0 && proc->latency_samples > 0 &&
+            proc->state != PROC_COMPLETED) {
+            slo_control_step(proc);
+            sync_io_priority(proc);
+        }
+    }
+}
+
+// burst estimation, once per task: a quarter of its work, at least a quantum
+void estimate_burst(process_t *proc) {
+    if (proc->estimated_burst_ms == 0) {
+        proc->estimated_burst_ms = proc->remaining_time_ms / 4;
+        if (proc->estimated_burst_ms < TIME_QUANTUM_MS) {
+            proc->estimated_burst_ms = TIME_QUANTUM_MS;
+        }
+    }
+}
+
+/* heuristic layer - computes dynamic scheduling metrics:
+   1. aging boost for long-waiting processes
+   2. burst estimation using exponential moving avg
+   3. interactivity score to favor short tasks */
+void compute_heuristic_metrics(process_t *proc, long current_time) {
+    if (proc->state == PROC_READY || proc->state == PROC_STOPPED) {
+        long wait_delta = current_time - proc->last_schedule_time_ms;
+        if (wait_delta > 0) {
+            proc->total_wait_time_ms += wait_delta;
+        }
+    }
+
+    // aging boost to prevent starvation
+    if (proc->total_wait_time_ms > MAX_WAIT_THRESHOLD_MS) {
+        proc->aging_boost = (proc->total_wait_time_ms - MAX_WAIT_THRESHOLD_MS) / 10;
+        if (proc->aging_boost > 10) proc->aging_boost = 10;
+    } else {
+        proc->aging_boost = 0;
+    }
+
+    estimate_burst(proc);
+
+    // interactivity - shorter remaining = less interactive
+    if (proc->burst_time_ms > 0) {
+        proc->interactivity_score =
+            (proc->remaining_time_ms * 100) / proc->burst_time_ms;
+        if (proc->estimated_burst_ms < INTERACTIVE_THRESHOLD_MS) {
+            proc->interactivity_score += 20;
+        }
+    }
+
+    proc->last_schedule_time_ms = current_time;
+}
+
+/* ---- stats page ---- */
+
+/* the dispatch thread is the only writer: it republishes the global record
+   and every task record before each pick and before each slice, two full
+   passes per decision with no locks and no system calls. monitors map the
+   page read-only through cfs_stats.h and retry torn copies themselves */
+_Static_assert(MAX_PROCESSES <= CFS_STATS_MAX_TASKS, "stats page too small for MAX_PROCESSES");
+
+static cfs_stats_page_t *stats_page;
+static char stats_path[256];
+static long stats_samples_seen[MAX_PROCESSES];   // latency samples behind the published percentiles
+
+void stats_open(const char *name) {
+    snprintf(stats_path, sizeof(stats_path), "/%s", name + (name[0] == '/'));
+    int fd = shm_open(stats_path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0 || ftruncate(fd, sizeof(cfs_stats_page_t)) < 0) {
+        perror("stats page");
+        exit(1);
+    }
+    stats_page = mmap(NULL, sizeof(cfs_stats_page_t), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (stats_page == MAP_FAILED) {
+        perror("mmap stats page");
+        exit(1);
+    }
+    stats_page->version = CFS_STATS_VERSION;
+    stats_page->max_tasks = CFS_STATS_MAX_TASKS;
+    stats_page->pid = getpid();
+    stats_publish(get_time_ms());
+    // readers check the magic last
+    atomic_thread_fence(memory_order_release);
+    stats_page->magic = CFS_STATS_MAGIC;
+}
+
+static int stats_task_state(process_t *proc) {
+    switch (proc->state) {
+    case PROC_COMPLETED: return CFS_TASK_DONE;
+    case PROC_RUNNING: return CFS_TASK_RUNNING;
+    case PROC_SLEEPING: return CFS_TASK_SLEEPING;
+    case PROC_WAITING_ARRIVAL:
+    case PROC_WAITING_DEPS: return CFS_TASK_WAITING;
+    default:
+        if (on_run_queue(proc)) return CFS_TASK_READY;
+        return proc->admission == ADMIT_PENDING ? CFS_TASK_WAITING : CFS_TASK_HELD;
+    }
+}
+
+void stats_publish(long current_time) {
+    if (!stats_page) return;
+
+    int runnable = 0;
+    for (int i = 0; i < scheduler.num_processes; i++) {
+        process_t *proc = &scheduler.processes[i];
+        cfs_stats_task_rec_t *rec = &stats_page->tasks[i];
+        runnable += on_run_queue(proc);
+
+        // percentiles only move when the task was dispatched since the last pass
+        int resample = proc->latency_samples != stats_samples_seen[i];
+        int p50 = resample ? latency_percentile(proc, 50) : 0;
+        int p99 = resample ? latency_percentile(proc, 99) : 0;
+        stats_samples_seen[i] = proc->latency_samples;
+
+        cfs_stats_write_begin(&rec->seq);
+        rec->data.task_id = proc->task_id;
+        rec->data.state = stats_task_state(proc);
+        rec->data.vruntime_ns = proc->vruntime_ns;
+        rec->data.weight = proc->weight;
+        rec->data.aging_boost = proc->aging_boost;
+        rec->data.wait_ms = proc->total_wait_time_ms;
+        rec->data.cpu_ms = proc->run_time_ms;
+        rec->data.remaining_ms = proc->remaining_time_ms;
+        if (resample) {
+            rec->data.wait_p50_ms = p50;
+            rec->data.wait_p99_ms = p99;
+        }
+        cfs_stats_write_end(&rec->seq);
+    }
+
+    cfs_stats_global_rec_t *rec = &stats_page->global;
+    int current = scheduler.current_process_idx;
+    cfs_stats_write_begin(&rec->seq);
+    rec->data.elapsed_ms = current_time - scheduler.scheduler_start_time_ms;
+    rec->data.slices = scheduler.slices;
+    rec->data.dispatches = scheduler.dispatches;
+    rec->data.min_vruntime_ns = scheduler.min_vruntime_ns;
+    rec->data.num_tasks = scheduler.num_processes;
+    rec->data.completed = scheduler.completed_count;
+    rec->data.runnable = runnable;
+    rec->data.running_task = current != -1 && scheduler.processes[current].state == PROC_RUNNING
+                             ? scheduler.processes[current].task_id : -1;
+    rec->data.active_policy = scheduler.active_policy;
+    rec->data.finished = scheduler.completed_count == scheduler.num_processes;
+    cfs_stats_write_end(&rec->seq);
+
+#ifdef CFS_PROFILE
+    // the histograms only move when a decision closes
+    static long profile_published = -1;
+    if (profile.decisions != profile_published) {
+        cfs_stats_profile_rec_t *prof = &stats_page->profile;
+        cfs_stats_write_begin(&prof->seq);
+        prof->data.enabled = 1;
+        prof->data.phases = PH_COUNT;
+        prof->data.decisions = profile.decisions;
+        for (int ph = 0; ph < PH_COUNT; ph++) {
+            prof->data.samples[ph] = profile.samples[ph];
+            prof->data.total_ns[ph] = profile.total_ns[ph];
+            prof->data.max_ns[ph] = profile.max_ns[ph];
+            for (int b = 0; b < PROFILE_BUCKETS; b++) prof->data.hist[ph][b] = profile.hist[ph][b];
+        }
+        cfs_stats_write_end(&prof->seq);
+        profile_published = profile.decisions;
+    }
+#endif
+}
+
+// the last state stays readable by monitors that still hold the mapping
+void stats_close(void) {
+    if (!stats_page) return;
+    stats_publish(get_time_ms());
+    munmap(stats_page, sizeof(cfs_stats_page_t));
+    shm_unlink(stats_path);
+    stats_page = NULL;
+}
+
+/* ---- snapshot ring ---- */
+
+/* every ring_interval_ms, at the first decision after it is due, one record
+   per task goes into the mapped ring file. shares and waits are deltas over
+   the time since the previous snapshot. a completed task gets one last
+   record and then drops out */
+_Static_assert(MAX_PROCESSES <= RING_TASKS && MAX_GROUPS <= RING_GROUPS &&
+               GROUP_NAME_LEN <= RING_GROUP_NAME, "ring header too small");
+
+static ring_hdr_t *ring_hdr;
+static ring_rec_t *ring_recs;
+static size_t ring_size;
+static uint64_t ring_seq;
+static long ring_next_ms, ring_last_ms;
+static long ring_cpu_seen[MAX_PROCESSES], ring_wait_seen[MAX_PROCESSES];
+static int ring_final[MAX_PROCESSES];    // the completed record was written
+
+void ring_open(const char *path) {
+    ring_size = RING_HDR_SIZE + (size_t)RING_RECORDS * sizeof(ring_rec_t);
+    int fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0 || ftruncate(fd, ring_size) < 0) {
+        perror(path);
+        exit(1);
+    }
+    void *map = mmap(NULL, ring_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        perror("mmap ring file");
+        exit(1);
+    }
+    ring_hdr = map;
+    ring_recs = (ring_rec_t *)((char *)map + RING_HDR_SIZE);
+
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    ring_hdr->version = RING_VERSION;
+    ring_hdr->record_size = sizeof(ring_rec_t);
+    ring_hdr->slots = RING_RECORDS;
+    ring_hdr->interval_ms = config.ring_interval_ms;
+    ring_hdr->num_groups = scheduler.num_groups;
+    ring_hdr->start_unix_ns = (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec -
+                              (uint64_t)(get_time_ms() - scheduler.scheduler_start_time_ms) * 1000000ULL;
+    for (int g = 0; g < scheduler.num_groups; g++) {
+        memcpy(ring_hdr->groups[g], scheduler.groups[g].name, GROUP_NAME_LEN);
+    }
+    memcpy(ring_hdr->magic, RING_MAGIC, sizeof(ring_hdr->magic));
+    ring_next_ms = ring_last_ms = scheduler.scheduler_start_time_ms;
+}
+
+static int ring_throttle(process_t *proc) {
+    int bits = 0;
+    if (memory_parked(proc)) bits |= RING_THROTTLE_MEM;
+    if (proc->admission == ADMIT_QUEUED) bits |= RING_THROTTLE_ADMIT;
+    if (proc->drf_deferred) bits |= RING_THROTTLE_DRF;
+    return bits;
+}
+
+void ring_snapshot(long current_time) {
+    if (!ring_hdr || current_time < ring_next_ms) return;
+
+    long span = current_time - ring_last_ms;
+    ring_last_ms = current_time;
+    ring_next_ms += config.ring_interval_ms;
+    if (ring_next_ms <= current_time) ring_next_ms = current_time + config.ring_interval_ms;
+
+    int runnable = 0;
+    for (int i = 0; i < scheduler.num_processes; i++) {
+        runnable += on_run_queue(&scheduler.processes[i]);
+    }
+
+    for (int i = 0; i < scheduler.num_processes; i++) {
+        process_t *proc = &scheduler.processes[i];
+        if (ring_final[i]) continue;
+        ring_final[i] = proc->state == PROC_COMPLETED;
+
+        long ran = proc->run_time_ms - ring_cpu_seen[i];
+        long waited = proc->total_wait_time_ms - ring_wait_seen[i];
+        ring_cpu_seen[i] = proc->run_time_ms;
+        ring_wait_seen[i] = proc->total_wait_time_ms;
+        long share = span > 0 ? ran * 10000 / span : 0;
+
+        ring_rec_t rec = {0};
+        rec.seq = ++ring_seq;
+        rec.time_ms = (uint32_t)(current_time - scheduler.scheduler_start_time_ms);
+        rec.task = (uint16_t)proc->task_id;
+        rec.group = (uint8_t)(proc->group_idx >= 0 ? proc->group_idx : 0);
+        rec.state = (uint8_t)stats_task_state(proc);
+        rec.share_bp = (uint16_t)(share < 10000 ? share : 10000);
+        rec.runnable = (uint16_t)runnable;
+        rec.wait_ms = (uint32_t)waited;
+        rec.cpu_ms = (uint32_t)proc->run_time_ms;
+        rec.throttle = (uint8_t)ring_throttle(proc);
+        rec.check = ring_check(&rec);
+        ring_recs[(rec.seq - 1) % RING_RECORDS] = rec;
+    }
+    ring_hdr->num_groups = scheduler.num_groups;
+    ring_hdr->head = ring_seq;
+}
+
+void ring_close(void) {
+    if (!ring_hdr) return;
+    ring_next_ms = 0;
+    ring_snapshot(get_time_ms());
+    munmap(ring_hdr, ring_size);
+    ring_hdr = NULL;
+}
+
+// vruntime update: vruntime += (exec_time * 1024) / weight
+void update_vruntime(process_t *proc, long executed_time_ms) {
+    unsigned long executed_ns = executed_time_ms * 1000000UL;
+    unsigned long delta_vruntime =
+        (executed_ns * CFS_WEIGHT_NICE_0) / proc->weight;
+
+    proc->vruntime_ns += delta_vruntime;
+
+    update_min_vruntime();
+}
+
+// credit for the predicted work still downstream of this task, capped so a
+// long chain can jump the queue but never starve the rest
+static inline long long critical_path_bias(process_t *proc) {
+    long long bias = (proc->upward_rank_ms - proc->estimated_burst_ms) * CRITICAL_PATH_BIAS_NS;
+    return bias < CRITICAL_PATH_MAX_BIAS_NS ? bias : CRITICAL_PATH_MAX_BIAS_NS;
+}
+
+/* hand-written score: vruntime adjusted by the heuristic metrics. each
+   adjustment is also stored as its TRACE_TERM_* so pick explanations (-E)
+   see exactly what was summed; returns the score */
+long long heuristic_terms(process_t *proc, long long *terms) {
+    long long score = terms[TRACE_TERM_VRUNTIME] = proc->vruntime_ns;
+
+    // aging: reduce score so starved processes get picked
+    score += terms[TRACE_TERM_AGING] = -(proc->aging_boost * 100000000LL);
+
+    // interactive bonus
+    score += terms[TRACE_TERM_INTERACTIVE] =
+        proc->estimated_burst_ms < INTERACTIVE_THRESHOLD_MS ? -50000000LL : 0;
+
+    // slight penalty for very long processes
+    score += terms[TRACE_TERM_LONG_TASK] = proc->remaining_time_ms > 100 ? 10000000LL : 0;
+
+    // critical path: favor tasks that gate long chains of dependents
+    score += terms[TRACE_TERM_CRITICAL_PATH] = config.critical_path ? -critical_path_bias(proc) : 0;
+
+    return score;
+}
+
+long long heuristic_score(process_t *proc) {
+    long long terms[TRACE_TERMS];
+    return heuristic_terms(proc, terms);
+}
+
+/* learned model features, integer only and clamped to [0, MODEL_FEATURE_MAX].
+   must match HeuristicCFSScheduler._features() in scheduler_simulation.py */
+static inline int32_t clamp_feature(long value) {
+    value = value < 0 ? 0 : value;
+    return value > MODEL_FEATURE_MAX ? MODEL_FEATURE_MAX : value;
+}
+
+// log2 in 1/16 steps: leading bit position plus the 4 bits after it
+static inline int32_t log2_q4(uint32_t value) {
+    if (value == 0) return 0;
+    int top = 31 - __builtin_clz(value);
+    return top * 16 + (int32_t)(((uint64_t)value << 4 >> top) & 0xF);
+}
+
+void model_features(process_t *proc, long current_time, int32_t *features) {
+    long lifetime = current_time - scheduler.scheduler_start_time_ms - proc->arrival_time_ms;
+    if (lifetime < 1) lifetime = 1;
+
+    features[0] = clamp_feature(((long)proc->vruntime_ns - (long)scheduler.min_vruntime_ns) / 1000000L);
+    features[1] = clamp_feature(current_time - proc->ready_since_ms);
+    features[2] = clamp_feature(proc->remaining_time_ms);
+    features[3] = clamp_feature(proc->total_sleep_ms * 1000 / lifetime);
+    features[4] = log2_q4(proc->weight);
+}
+
+// dot product with the trained weights, no branches in the loop
+long long model_score(process_t *proc, long current_time) {
+    int32_t features[MODEL_FEATURES];
+    model_features(proc, current_time, features);
+
+    long long score = 0;
+    for (int i = 0; i < MODEL_FEATURES; i++) {
+        score += (long long)model_weights[i] * features[i];
+    }
+    return score;
+}
+
+/* ---- registered policies ---- */
+
+static long long policy_score_heuristic(process_t *proc, long current_time) {
+    compute_heuristic_metrics(proc, current_time);
+    return heuristic_score(proc);
+}
+
+static long long policy_score_cfs(process_t *proc, long current_time) {
+    (void)current_time;
+    return proc->vruntime_ns;
+}
+
+static long long policy_score_srtf(process_t *proc, long current_time) {
+    (void)current_time;
+    return proc->remaining_time_ms;
+}
+
+static long long policy_score_fifo(process_t *proc, long current_time) {
+    (void)current_time;
+    return proc->arrival_time_ms;
+}
+
+// round robin: whoever has been runnable the longest
+static long long policy_score_rr(process_t *proc, long current_time) {
+    (void)current_time;
+    return proc->ready_since_ms;
+}
+
+static const policy_t policies[] = {
+    { "heuristic", policy_score_heuristic },
+    { "cfs",       policy_score_cfs },
+    { "srtf",      policy_score_srtf },
+    { "fifo",      policy_score_fifo },
+    { "rr",        policy_score_rr },
+};
+#define NUM_POLICIES ((int)(sizeof(policies) / sizeof(policies[0])))
+
+int policy_index(const char *name) {
+    for (int p = 0; p < NUM_POLICIES; p++) {
+        if (strcmp(policies[p].name, name) == 0) return p;
+    }
+    return -1;
+}
+
+// picks process with lowest score (heuristic or learned)
+int select_next_process_cfs_heuristic(void) {
+    int best_idx = -1;
+    long long best_score = LLONG_MAX;
+    long current_time = get_time_ms();
+    scheduler.ready_mask = 0;
+
+    // with -E: one heuristic pick in explain_every is traced against its rival,
+    // the first task in pure vruntime order or else the runner-up
+    int explain = 0;
+    int vruntime_idx = -1, top_idx = -1, second_idx = -1;
+    long long top_score = LLONG_MAX, second_score = LLONG_MAX;
+    if (config.explain_every > 0 && !config.learned_model &&
+        (!config.meta_policy || scheduler.active_policy == policy_index("heuristic"))) {
+        explain = scheduler.explain_picks++ % config.explain_every == 0;
+    }
+
+    // with -D: best candidate per group, the group is chosen by dominant share
+    int group_best[MAX_GROUPS];
+    long long group_score[MAX_GROUPS];
+    for (int g = 0; g < scheduler.num_groups; g++) {
+        group_best[g] = -1;
+        group_score[g] = LLONG_MAX;
+    }
+
+    for (int i = 0; i < scheduler.num_processes; i++) {
+        process_t *proc = &scheduler.processes[i];
+
+        if (proc->state != PROC_READY && proc->state != PROC_STOPPED) {
+            continue;
+        }
+
+        if (!proc->arrived) {
+            continue;
+        }
+
+        if (memory_parked(proc)) {
+            continue;
+        }
+
+        PROFILE_LAP(PH_PICK);
+        int boost = proc->aging_boost;
+        compute_heuristic_metrics(proc, current_time);
+        if (proc->aging_boost != boost) {
+            CFS_PROBE3(aging, proc->task_id, proc->vruntime_ns, proc->aging_boost);
+            trace_emit(TR_AGING, proc->task_id, proc->aging_boost);
+        }
+        PROFILE_LAP(PH_METRICS);
+        scheduler.ready_mask |= 1ULL << i;
+
+        long long score;
+        if (config.meta_policy) {
+            score = policies[scheduler.active_policy].score(proc, current_time);
+        } else {
+            score = config.learned_model ?
+                model_score(proc, current_time) : heuristic_score(proc);
+        }
+
+        if (score < best_score) {
+            best_score = score;
+            best_idx = i;
+        }
+        if (explain) {
+            if (vruntime_idx == -1 || proc->vruntime_ns < scheduler.processes[vruntime_idx].vruntime_ns) {
+                vruntime_idx = i;
+            }
+            if (score < top_score) {
+                second_idx = top_idx;
+                second_score = top_score;
+                top_idx = i;
+                top_score = score;
+            } else if (score < second_score) {
+                second_idx = i;
+                second_score = score;
+            }
+        }
+        if (score < group_score[proc->group_idx]) {
+            group_score[proc->group_idx] = score;
+            group_best[proc->group_idx] = i;
+        }
+    }
+
+    if (config.drf && best_idx != -1) {
+        int best_group = -1;
+        double best_share = 0.0;
+        for (int g = 0; g < scheduler.num_groups; g++) {
+            if (group_best[g] == -1) continue;
+            double share = drf_dominant_share(&scheduler.groups[g], current_time);
+            if (best_group == -1 || share < best_share ||
+                (share == best_share && group_score[g] < group_score[best_group])) {
+                best_group = g;
+                best_share = share;
+            }
+        }
+        best_idx = group_best[best_group];
+        best_score = group_score[best_group];
+    }
+
+    if (best_idx != -1) {
+        CFS_PROBE3(pick, scheduler.processes[best_idx].task_id,
+                   scheduler.processes[best_idx].vruntime_ns, best_score);
+        trace_emit(TR_PICK, scheduler.processes[best_idx].task_id, 0);
+    }
+    if (explain && best_idx != -1) {
+        int rival = vruntime_idx != best_idx ? vruntime_idx : top_idx != best_idx ? top_idx : second_idx;
+        if (rival != -1) {
+            trace_explain(&scheduler.processes[best_idx], &scheduler.processes[rival],
+                          rival == vruntime_idx ? TRACE_EXPLAIN_VRUNTIME_RIVAL : 0,
+                          scheduler.processes[vruntime_idx].vruntime_ns);
+        }
+    }
+    return best_idx;
+}
+
+int latency_sensitive(process_t *proc) {
+    return proc->slo_target_ms > 0 || proc->io_run_ms > 0;
+}
+
+// bandit context: 1 while any other latency-sensitive task is still unfinished
+int bandit_context(process_t *proc) {
+    for (int i = 0; i < scheduler.num_processes; i++) {
+        process_t *other = &scheduler.processes[i];
+        if (other != proc && other->state != PROC_COMPLETED && latency_sensitive(other)) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// ucb1 over the quantum arms, untried arms first
+int bandit_pick(process_t *proc, int context) {
+    long total = 0;
+    for (int arm = 0; arm < QUANTUM_ARMS; arm++) {
+        if (proc->bandit_pulls[context][arm] == 0) return arm;
+        total += proc->bandit_pulls[context][arm];
+    }
+
+    int best = 0;
+    double best_bound = -INFINITY;
+    for (int arm = 0; arm < QUANTUM_ARMS; arm++) {
+        double bound = proc->bandit_value[context][arm] +
+            BANDIT_EXPLORE * sqrt(log((double)total) / proc->bandit_pulls[context][arm]);
+        if (bound > best_bound) {
+            best_bound = bound;
+            best = arm;
+        }
+    }
+    return best;
+}
+
+/* reward = progress per ms of cpu, minus the time latency-sensitive tasks
+   spent waiting on the run queue during this slice (in sched latencies).
+   incremental mean, so the update is constant time */
+void bandit_update(process_t *proc, long executed_ms, long progress_ms, long current_time) {
+    if (executed_ms <= 0) return;
+
+    long delayed_ms = 0;
+    for (int i = 0; i < scheduler.num_processes; i++) {
+        process_t *other = &scheduler.processes[i];
+        if (other == proc || !other->arrived || !latency_sensitive(other)) continue;
+        if (other->state != PROC_READY && other->state != PROC_STOPPED) continue;
+
+        long waited = current_time - other->ready_since_ms;
+        delayed_ms += waited < executed_ms ? waited : executed_ms;
+    }
+
+    double reward = (double)progress_ms / executed_ms -
+        BANDIT_LATENCY_COST * delayed_ms / SCHED_LATENCY_MS;
+
+    int ctx = proc->slice_context, arm = proc->slice_arm;
+    proc->bandit_pulls[ctx][arm]++;
+    proc->bandit_value[ctx][arm] += (reward - proc->bandit_value[ctx][arm]) / proc->bandit_pulls[ctx][arm];
+    proc->arm_pulls[arm]++;
+}
+
+/* ---- regime-switching meta-scheduler ---- */
+
+/* hands the run queue to a new policy. vruntime kept advancing under every
+   policy, but a task starved by srtf can sit far behind; bound its lag to two
+   slices around the average (as -P lag does for sleepers) so it cannot
+   monopolize the cpu once vruntime decides again */
+void migrate_run_queue(int to_policy) {
+    int clamp = to_policy == policy_index("heuristic") || to_policy == policy_index("cfs");
+
+    long avg = avg_vruntime();
+    for (int i = 0; i < scheduler.num_processes; i++) {
+        process_t *proc = &scheduler.processes[i];
+        if (!on_run_queue(proc)) continue;
+
+        if (clamp) {
+            long limit = 2 * vslice_ns(proc);
+            long lag = avg - (long)proc->vruntime_ns;
+            if (lag > limit) proc->vruntime_ns = avg - limit;
+            if (lag < -limit) proc->vruntime_ns = avg + limit;
+        }
+        CFS_PROBE3(migrate, proc->task_id, proc->vruntime_ns, to_policy);
+        trace_emit(TR_MIGRATE, proc->task_id, to_policy);
+    }
+    if (clamp) update_min_vruntime();
+}
+
+/* every REGIME_PERIOD_MS: arrivals and their burst-size variation over the
+   last REGIME_WINDOW_MS, and the interactive share of the live tasks.
+   interactive -> rr, mixed sizes -> srtf, otherwise the heuristic default.
+   a new regime must win REGIME_HOLD votes in a row before the switch */
+void run_regime_classifier(long current_time) {
+    if (current_time - scheduler.last_regime_ms < REGIME_PERIOD_MS) return;
+    scheduler.last_regime_ms = current_time;
+
+    long elapsed = current_time - scheduler.scheduler_start_time_ms;
+    int alive = 0, interactive = 0, arrivals = 0, sized = 0;
+    double sum = 0, sum_sq = 0;
+
+    for (int i = 0; i < scheduler.num_processes; i++) {
+        process_t *proc = &scheduler.processes[i];
+        if (!proc->arrived) continue;
+
+        if (proc->state != PROC_COMPLETED) {
+            alive++;
+            if (proc->io_run_ms > 0) interactive++;
+        }
+        if (proc->arrival_time_ms > elapsed - REGIME_WINDOW_MS) {
+            arrivals++;
+            if (proc->io_run_ms == 0) {
+                sized++;
+                sum += proc->burst_time_ms;
+                sum_sq += (double)proc->burst_time_ms * proc->burst_time_ms;
+            }
+        }
+    }
+
+    double cv = 0.0;
+    if (sized >= 2) {
+        double mean = sum / sized;
+        double var = sum_sq / sized - mean * mean;
+        cv = var > 0 ? sqrt(var) / mean : 0.0;
+    }
+
+    int vote;
+    if (alive > 0 && interactive * 100 >= REGIME_INTERACTIVE_PCT * alive) {
+        vote = policy_index("rr");
+    } else if (arrivals >= REGIME_MIN_ARRIVALS && cv >= REGIME_SIZE_CV) {
+        vote = policy_index("srtf");
+    } else {
+        vote = policy_index("heuristic");
+    }
+
+    if (vote == scheduler.active_policy) {
+        scheduler.pending_votes = 0;
+        return;
+    }
+    scheduler.pending_votes = vote == scheduler.pending_policy ? scheduler.pending_votes + 1 : 1;
+    scheduler.pending_policy = vote;
+    if (scheduler.pending_votes < REGIME_HOLD) return;
+
+    migrate_run_queue(vote);
+    scheduler.active_policy = vote;
+    scheduler.pending_votes = 0;
+    if (scheduler.num_switches < REGIME_LOG) {
+        scheduler.switch_time_ms[scheduler.num_switches] = elapsed;
+        scheduler.switch_policy[scheduler.num_switches] = vote;
+    }
+    scheduler.num_switches++;
+
+    printf("[T=%4ld ms] Regime switch -> %s (%d live, %d interactive, %d arrivals, size cv %.2f)\n",
+           elapsed, policies[vote].name, alive, interactive, arrivals, cv);
+}
+
+/* ---- shadow policy evaluation ---- */
+
+// ring indices only ever grow; slot = index & (SHADOW_RING_SIZE - 1)
+static shadow_event_t shadow_ring[SHADOW_RING_SIZE];
+static atomic_uint shadow_head;               // written by the dispatch loop only
+static atomic_uint shadow_tail;               // written by the shadow thread only
+static long shadow_emitted, shadow_dropped;   // producer side
+static long long shadow_emit_ns;
+static int shadow_running;
+static pthread_t shadow_tid;
+
+// consumer side, owned by the shadow thread until it is joined
+static shadow_t *shadows;                     // one per policy in config.shadow_mask
+static process_t shadow_mirror[MAX_PROCESSES];     // live task state as seen through events
+static int shadow_has_parents[MAX_PROCESSES];
+
+// never blocks: a full ring drops the event and counts it
+void shadow_emit(int type, int task, long current_time, long a, long b, uint64_t mask) {
+    if (!shadow_running) return;
+
+    struct timespec t0, t1;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+
+    unsigned head = atomic_load_explicit(&shadow_head, memory_order_relaxed);
+    unsigned tail = atomic_load_explicit(&shadow_tail, memory_order_acquire);
+    if (head - tail == SHADOW_RING_SIZE) {
+        shadow_dropped++;
+    } else {
+        shadow_event_t *ev = &shadow_ring[head & (SHADOW_RING_SIZE - 1)];
+        ev->type = type;
+        ev->task = task;
+        ev->time_ms = current_time - scheduler.scheduler_start_time_ms;
+        ev->a = a;
+        ev->b = b;
+        ev->mask = mask;
+        atomic_store_explicit(&shadow_head, head + 1, memory_order_release);
+        shadow_emitted++;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    shadow_emit_ns += (t1.tv_sec - t0.tv_sec) * 1000000000LL + (t1.tv_nsec - t0.tv_nsec);
+}
+
+static void shadow_admit(shadow_t *sh, int idx, long now) {
+    unsigned long lowest = 0;
+    int found = 0;
+    for (int i = 0; i < scheduler.num_processes; i++) {
+        process_t *other = &sh->tasks[i];
+        if (!other->arrived || other->state == PROC_COMPLETED) continue;
+        if (!found || other->vruntime_ns < lowest) {
+            lowest = other->vruntime_ns;
+            found = 1;
+        }
+    }
+
+    process_t *proc = &sh->tasks[idx];
+    proc->arrived = 1;
+    proc->state = PROC_READY;
+    proc->vruntime_ns = lowest;
+    proc->ready_since_ms = now;
+    proc->last_schedule_time_ms = now;
+}
+
+static int shadow_pick(process_t *tasks, const policy_t *policy, long now, uint64_t mask) {
+    int best = -1;
+    long long best_score = LLONG_MAX;
+    for (int i = 0; i < scheduler.num_processes; i++) {
+        if (!(mask & (1ULL << i))) continue;
+        long long score = policy->score(&tasks[i], now);
+        if (score < best_score) {
+            best_score = score;
+            best = i;
+        }
+    }
+    return best;
+}
+
+/* runs the shadow's own single-cpu timeline up to `until` (ms since start).
+   same slice, warm-up and i/o rules as the live loop; no slo or fair-share
+   weight changes and no adaptive quanta */
+static void shadow_advance(shadow_t *sh, const policy_t *policy, long until) {
+    int n = scheduler.num_processes;
+
+    while (sh->clock_ms < until && sh->completed < n) {
+        long next_wake = LONG_MAX;
+        uint64_t runnable = 0;
+        for (int i = 0; i < n; i++) {
+            process_t *proc = &sh->tasks[i];
+            if (proc->state == PROC_SLEEPING) {
+                if (proc->wake_time_ms <= sh->clock_ms) {
+                    proc->state = PROC_READY;
+                    proc->ready_since_ms = proc->wake_time_ms;
+                    proc->total_sleep_ms += proc->io_sleep_ms;
+                } else if (proc->wake_time_ms < next_wake) {
+                    next_wake = proc->wake_time_ms;
+                }
+            }
+            if (!proc->arrived && shadow_has_parents[i] && proc->pending_parents == 0 &&
+                proc->arrival_time_ms <= sh->clock_ms) {
+                shadow_admit(sh, i, sh->clock_ms);
+            }
+            if (proc->arrived && proc->state == PROC_READY) {
+                runnable |= 1ULL << i;
+            }
+        }
+
+        if (sh->current < 0 || sh->slice_left_ms <= 0) {
+            int pick = shadow_pick(sh->tasks, policy, sh->clock_ms, runnable);
+            if (pick < 0) {
+                sh->clock_ms = next_wake < until ? next_wake : until;
+                continue;
+            }
+
+            process_t *proc = &sh->tasks[pick];
+            if (sh->cache_owner != pick) {
+                proc->warm_owed_ms = proc->warm_ms;
+            }
+            if (!proc->first_run) {
+                proc->first_run = 1;
+                proc->response_time_ms = sh->clock_ms - proc->arrival_time_ms;
+            }
+            proc->last_schedule_time_ms = sh->clock_ms;
+
+            int slice = (TIME_QUANTUM_MS * CFS_WEIGHT_NICE_0) / proc->weight;
+            if (slice < MIN_GRANULARITY_MS) slice = MIN_GRANULARITY_MS;
+            int io_left = proc->warm_owed_ms + proc->io_run_ms - proc->ran_since_wake_ms;
+            if (proc->io_run_ms > 0 && slice > io_left) slice = io_left;
+
+            sh->current = pick;
+            sh->slice_left_ms = slice;
+        }
+
+        process_t *proc = &sh->tasks[sh->current];
+        long run = sh->slice_left_ms;
+        if (run > until - sh->clock_ms) run = until - sh->clock_ms;
+        if (run > proc->remaining_time_ms + proc->warm_owed_ms) {
+            run = proc->remaining_time_ms + proc->warm_owed_ms;
+        }
+
+        long progress = run - proc->warm_owed_ms;
+        if (progress < 0) progress = 0;
+        proc->warm_owed_ms -= run - progress;
+        proc->remaining_time_ms -= progress;
+        proc->ran_since_wake_ms += progress;
+        proc->vruntime_ns += (unsigned long)run * 1000000UL * CFS_WEIGHT_NICE_0 / proc->weight;
+        sh->clock_ms += run;
+        sh->slice_left_ms -= run;
+        sh->cache_owner = sh->current;
+
+        if (proc->remaining_time_ms <= 0) {
+            proc->state = PROC_COMPLETED;
+            proc->finish_time_ms = sh->clock_ms;
+            proc->wait_time_ms = sh->clock_ms - proc->arrival_time_ms - proc->burst_time_ms - proc->total_sleep_ms;
+            sh->completed++;
+            sh->current = -1;
+            for (int c = 0; c < proc->num_children; c++) {
+                sh->tasks[proc->children[c]].pending_parents--;
+            }
+        } else if (proc->io_run_ms > 0 && proc->ran_since_wake_ms >= proc->io_run_ms) {
+            proc->state = PROC_SLEEPING;
+            proc->wake_time_ms = sh->clock_ms + proc->io_sleep_ms;
+            proc->ran_since_wake_ms = 0;
+            sh->current = -1;
+        } else if (sh->slice_left_ms <= 0) {
+            proc->ready_since_ms = sh->clock_ms;
+        }
+    }
+}
+
+static void shadow_apply(shadow_event_t *ev) {
+    int k = 0;
+    long until = ev->type == EV_DONE ? LONG_MAX : ev->time_ms;
+    for (int p = 0; p < NUM_POLICIES; p++) {
+        if (config.shadow_mask & (1u << p)) shadow_advance(&shadows[k++], &policies[p], until);
+    }
+
+    process_t *mirror = &shadow_mirror[ev->task];
+    switch (ev->type) {
+    case EV_ARRIVE:
+        mirror->arrived = 1;
+        mirror->state = PROC_READY;
+        mirror->vruntime_ns = ev->a;
+        mirror->last_schedule_time_ms = ev->time_ms;
+        mirror->ready_since_ms = ev->time_ms;
+        k = 0;
+        for (int p = 0; p < NUM_POLICIES; p++) {
+            if (!(config.shadow_mask & (1u << p))) continue;
+            shadow_t *sh = &shadows[k++];
+            if (!shadow_has_parents[ev->task] && !sh->tasks[ev->task].arrived) {
+                shadow_admit(sh, ev->task, ev->time_ms);
+            }
+        }
+        break;
+    case EV_PICK:
+        // what each policy would have picked from the same ready set
+        k = 0;
+        for (int p = 0; p < NUM_POLICIES; p++) {
+            if (!(config.shadow_mask & (1u << p))) continue;
+            shadow_t *sh = &shadows[k++];
+            sh->picks++;
+            if (shadow_pick(shadow_mirror, &policies[p], ev->time_ms, ev->mask) != ev->task) {
+                sh->disagreements++;
+            }
+        }
+        break;
+    case EV_RAN:
+        mirror->vruntime_ns = ev->a;
+        mirror->remaining_time_ms = ev->b;
+        mirror->last_schedule_time_ms = ev->time_ms;
+        mirror->ready_since_ms = ev->time_ms;
+        break;
+    case EV_COMPLETE:
+        mirror->state = PROC_COMPLETED;
+        break;
+    }
+}
+
+void *shadow_thread(void *arg) {
+    (void)arg;
+    for (;;) {
+        unsigned tail = atomic_load_explicit(&shadow_tail, memory_order_relaxed);
+        unsigned head = atomic_load_explicit(&shadow_head, memory_order_acquire);
+        if (tail == head) {
+            usleep(SHADOW_IDLE_US);
+            continue;
+        }
+
+        shadow_event_t ev = shadow_ring[tail & (SHADOW_RING_SIZE - 1)];
+        atomic_store_explicit(&shadow_tail, tail + 1, memory_order_release);
+
+        shadow_apply(&ev);
+        if (ev.type == EV_DONE) return NULL;
+    }
+}
+
+// copies the task table before any dispatch, then starts the consumer
+void shadow_start(void) {
+    int count = 0;
+    for (int p = 0; p < NUM_POLICIES; p++) {
+        if (config.shadow_mask & (1u << p)) count++;
+    }
+    if (count == 0) return;
+
+    shadows = calloc(count, sizeof(shadow_t));
+    if (!shadows) {
+        perror("calloc");
+        exit(1);
+    }
+
+    for (int i = 0; i < scheduler.num_processes; i++) {
+        process_t task = scheduler.processes[i];
+        shadow_has_parents[i] = task.pending_parents > 0;
+        task.state = PROC_READY;
+        task.arrived = 0;
+        task.last_schedule_time_ms = 0;
+        task.total_wait_time_ms = 0;
+        shadow_mirror[i] = task;
+        for (int k = 0; k < count; k++) {
+            shadows[k].tasks[i] = task;
+        }
+    }
+    for (int k = 0; k < count; k++) {
+        shadows[k].current = -1;
+        shadows[k].cache_owner = -1;
+    }
+
+    shadow_running = 1;
+    if (pthread_create(&shadow_tid, NULL, shadow_thread, NULL) != 0) {
+        perror("pthread_create");
+        exit(1);
+    }
+}
+
+// EV_DONE must get through, so this one waits for ring space
+void shadow_stop(long current_time) {
+    if (!shadow_running) return;
+
+    long dropped = shadow_dropped;
+    do {
+        shadow_dropped = dropped;
+        shadow_emit(EV_DONE, 0, current_time, 0, 0, 0);
+        if (shadow_dropped != dropped) usleep(SHADOW_IDLE_US);
+    } while (shadow_dropped != dropped);
+
+    pthread_join(shadow_tid, NULL);
+    shadow_running = 0;
+}
+
+/* ---- binary trace ---- */
+
+/* each stream has two raw buffers: the producer encodes into one while the
+   writer thread compresses and writes the other. a full buffer is handed
+   over under trace_lock; if the writer still holds the previous one the
+   producer waits (counted as a stall) rather than drop events. the
+   dispatch loop drives one cpu, so the scheduler writes stream 0 */
+typedef struct {
+    uint8_t buf[2][TRACE_BLOCK_SIZE];
+    size_t len[2];
+    uint32_t events[2];
+    uint64_t base_us[2];
+    uint32_t prev_task;           // of the last event in the filling buffer
+    int fill;                     // buffer the producer encodes into
+    int pending;                  // buffer handed to the writer, -1 = none
+    uint64_t last_us;             // time of the stream's last event
+} trace_stream_t;
+
+static FILE *trace_file;
+static trace_stream_t *trace_streams;
+static int trace_num_streams;
+static uint64_t trace_start_ns;
+static pthread_mutex_t trace_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t trace_ready = PTHREAD_COND_INITIALIZER;    // a buffer is pending
+static pthread_cond_t trace_done = PTHREAD_COND_INITIALIZER;     // a pending buffer was written
+static int trace_stopping;
+static pthread_t trace_tid;
+static long long trace_events, trace_raw_bytes, trace_stored_bytes;
+static long trace_blocks, trace_stalls, trace_write_errors;
+
+static uint64_t trace_clock_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static void *trace_thread(void *arg) {
+    (void)arg;
+    static uint8_t stored[TRACE_STORED_MAX];
+
+    pthread_mutex_lock(&trace_lock);
+    for (;;) {
+        trace_stream_t *s = NULL;
+        int stream = 0;
+        for (; stream < trace_num_streams; stream++) {
+            if (trace_streams[stream].pending >= 0) {
+                s = &trace_streams[stream];
+                break;
+            }
+        }
+        if (!s) {
+            if (trace_stopping) break;
+            pthread_cond_wait(&trace_ready, &trace_lock);
+            continue;
+        }
+        pthread_mutex_unlock(&trace_lock);
+
+        int b = s->pending;
+        size_t stored_len;
+        trace_block_hdr_t hdr = {0};
+        hdr.stream = (uint8_t)stream;
+        hdr.codec = (uint8_t)trace_encode_block(TRACE_CODEC_DEFAULT, s->buf[b], s->len[b], stored, &stored_len);
+        hdr.raw_len = (uint32_t)s->len[b];
+        hdr.stored_len = (uint32_t)stored_len;
+        hdr.events = s->events[b];
+        hdr.base_us = s->base_us[b];
+        if (fwrite(&hdr, sizeof(hdr), 1, trace_file) != 1 ||
+            fwrite(stored, 1, stored_len, trace_file) != stored_len) {
+            trace_write_errors++;
+        }
+        trace_stored_bytes += sizeof(hdr) + stored_len;
+        trace_raw_bytes += s->len[b];
+        trace_blocks++;
+
+        pthread_mutex_lock(&trace_lock);
+        s->pending = -1;
+        pthread_cond_broadcast(&trace_done);
+    }
+    pthread_mutex_unlock(&trace_lock);
+    return NULL;
+}
+
+void trace_open(const char *path, int streams) {
+    trace_file = fopen(path, "wb");
+    if (!trace_file) {
+        perror(path);
+        exit(1);
+    }
+    trace_streams = calloc(streams, sizeof(trace_stream_t));
+    if (!trace_streams) {
+        perror("calloc");
+        exit(1);
+    }
+    for (int i = 0; i < streams; i++) trace_streams[i].pending = -1;
+    trace_num_streams = streams;
+    trace_start_ns = trace_clock_ns();
+
+    trace_file_hdr_t hdr = {0};
+    memcpy(hdr.magic, TRACE_MAGIC, sizeof(hdr.magic));
+    hdr.version = TRACE_VERSION;
+    hdr.streams = (uint32_t)streams;
+    hdr.start_ns = trace_start_ns;
+    if (fwrite(&hdr, sizeof(hdr), 1, trace_file) != 1) {
+        perror(path);
+        exit(1);
+    }
+    trace_stored_bytes = sizeof(hdr);
+
+    if (pthread_create(&trace_tid, NULL, trace_thread, NULL) != 0) {
+        perror("pthread_create");
+        exit(1);
+    }
+}
+
+// hands the filling buffer to the writer and switches to the other one
+static void trace_flush(trace_stream_t *s) {
+    if (s->len[s->fill] == 0) return;
+
+    pthread_mutex_lock(&trace_lock);
+    if (s->pending >= 0) trace_stalls++;
+    while (s->pending >= 0) pthread_cond_wait(&trace_done, &trace_lock);
+    s->pending = s->fill;
+    pthread_cond_signal(&trace_ready);
+    pthread_mutex_unlock(&trace_lock);
+
+    s->fill ^= 1;
+    s->len[s->fill] = 0;
+    s->events[s->fill] = 0;
+}
+
+static inline void trace_put(int stream, uint64_t time_us, int type, int task, long arg,
+                             const trace_explain_t *explain) {
+    trace_stream_t *s = &trace_streams[stream];
+    if (s->len[s->fill] > TRACE_BLOCK_SIZE - TRACE_EVENT_MAX) trace_flush(s);
+
+    int b = s->fill;
+    if (s->events[b] == 0) {
+        s->base_us[b] = s->last_us;
+        s->prev_task = TRACE_TASK_NONE;
+    }
+    uint64_t delta = time_us > s->last_us ? time_us - s->last_us : 0;
+    s->last_us += delta;
+    uint8_t *end = trace_put_event(s->buf[b] + s->len[b], &s->prev_task, type, (uint32_t)task, delta, arg);
+    if (explain) end = trace_put_explain(end, explain);
+    s->len[b] = end - s->buf[b];
+    s->events[b]++;
+    trace_events++;
+}
+
+// one event on the dispatch cpu's stream, stamped now
+void trace_emit(int type, int task, long arg) {
+    if (!trace_file) return;
+    trace_put(0, (trace_clock_ns() - trace_start_ns) / 1000, type, task, arg, NULL);
+}
+
+// score terms of a pick and its rival, in us; vruntime relative to base,
+// the lowest vruntime among the candidates
+void trace_explain(process_t *winner, process_t *rival, int flags, unsigned long base_vruntime) {
+    if (!trace_file) return;
+
+    trace_explain_t x;
+    long long terms[TRACE_TERMS];
+    x.rival = (uint32_t)rival->task_id;
+    x.flags = (uint8_t)flags;
+    for (int side = 0; side < 2; side++) {
+        heuristic_terms(side ? rival : winner, terms);
+        terms[TRACE_TERM_VRUNTIME] -= (long long)base_vruntime;
+        for (int k = 0; k < TRACE_TERMS; k++) x.terms[side][k] = terms[k] / 1000;
+    }
+    trace_put(0, (trace_clock_ns() - trace_start_ns) / 1000, TR_EXPLAIN, winner->task_id, 0, &x);
+    scheduler.explain_records++;
+}
+
+void trace_close(void) {
+    if (!trace_file) return;
+
+    for (int i = 0; i < trace_num_streams; i++) trace_flush(&trace_streams[i]);
+    pthread_mutex_lock(&trace_lock);
+    trace_stopping = 1;
+    pthread_cond_signal(&trace_ready);
+    pthread_mutex_unlock(&trace_lock);
+    pthread_join(trace_tid, NULL);
+
+    if (fclose(trace_file) != 0) trace_write_errors++;
+    trace_file = NULL;
+    free(trace_streams);
+    trace_streams = NULL;
+}
+
+/* ---- columnar export ---- */
+
+/* with -o every slice is logged in memory and the run is written at exit as
+   three arrow ipc files in the directory: tasks.arrow (one row per task),
+   gantt.arrow (cpu intervals, back-to-back slices of a task merged) and
+   decisions.arrow (one row per slice). times are ms since the scheduler
+   started. scheduler_simulation.py memory-maps them as they are */
+static decision_t *decisions;
+static long num_decisions, cap_decisions;
+
+void results_record(process_t *proc, long exec_start, long exec_end, long dispatch_wait) {
+    if (!config.results_dir) return;
+    if (num_decisions == cap_decisions) {
+        cap_decisions = cap_decisions ? cap_decisions * 2 : 4096;
+        decisions = realloc(decisions, cap_decisions * sizeof(*decisions));
+        if (!decisions) {
+            perror("realloc");
+            exit(1);
+        }
+    }
+    int runnable = 0;
+    for (int i = 0; i < scheduler.num_processes; i++) {
+        runnable += on_run_queue(&scheduler.processes[i]);
+    }
+    decision_t *d = &decisions[num_decisions++];
+    d->start_ms = exec_start - scheduler.scheduler_start_time_ms;
+    d->end_ms = exec_end - scheduler.scheduler_start_time_ms;
+    d->vruntime_ns = proc->vruntime_ns;
+    d->dispatch_wait_ms = dispatch_wait;
+    d->task = proc->task_id;
+    d->runnable = runnable;
+    d->slice_ms = proc->time_slice_remaining_ms;
+    d->policy = scheduler.active_policy;
+}
+
+static int results_write(const char *dir, const char *name, const arrow_field_t *fields, int num_fields,
+                         const arrow_meta_t *meta, int num_meta, const arrow_column_t *cols, long rows) {
+    char path[PATH_MAX];
+    arrow_writer_t w;
+    snprintf(path, sizeof(path), "%s/%s", dir, name);
+    if (arrow_open(&w, path, fields, num_fields, meta, num_meta) < 0) {
+        perror(path);
+        return -1;
+    }
+    arrow_write_batch(&w, cols, rows);
+    if (arrow_close(&w) < 0) {
+        fprintf(stderr, "%s: write failed\n", path);
+        return -1;
+    }
+    return 0;
+}
+
+static int results_export_tasks(const char *dir) {
+    static const arrow_field_t fields[] = {
+        { "task", ARROW_INT32 }, { "pid", ARROW_INT32 }, { "nice", ARROW_INT32 }, { "weight", ARROW_INT32 },
+        { "arrival", ARROW_INT64 }, { "burst", ARROW_INT64 }, { "start", ARROW_INT64 },
+        { "finish", ARROW_INT64 }, { "response", ARROW_INT64 }, { "turnaround", ARROW_INT64 },
+        { "wait", ARROW_INT64 }, { "cpu", ARROW_INT64 }, { "vruntime", ARROW_INT64 },
+        { "dispatches", ARROW_INT64 }, { "max_dispatch_wait", ARROW_INT64 },
+        { "group", ARROW_UTF8 }, { "admission", ARROW_UTF8 },
+    };
+    enum { INTS = 4, LONGS = 11, NUM_FIELDS = sizeof(fields) / sizeof(fields[0]) };
+    static int32_t ints[INTS][MAX_PROCESSES];
+    static int64_t longs[LONGS][MAX_PROCESSES];
+    static char groups[MAX_PROCESSES * GROUP_NAME_LEN], admissions[MAX_PROCESSES * 32];
+    int32_t group_off[MAX_PROCESSES + 1] = { 0 }, admission_off[MAX_PROCESSES + 1] = { 0 };
+
+    long start = scheduler.scheduler_start_time_ms;
+    for (int i = 0; i < scheduler.num_processes; i++) {
+        process_t *proc = &scheduler.processes[i];
+        long turnaround = proc->finish_time_ms - start - proc->arrival_time_ms;
+        int64_t row[LONGS] = {
+            proc->arrival_time_ms, proc->burst_time_ms,
+            proc->first_run ? proc->start_time_ms - start : -1,
+            proc->finish_time_ms - start, proc->first_run ? proc->response_time_ms : -1, turnaround,
+            turnaround - proc->burst_time_ms - proc->total_sleep_ms, proc->run_time_ms,
+            (int64_t)proc->vruntime_ns, proc->latency_samples, proc->max_dispatch_wait_ms,
+        };
+        ints[0][i] = proc->task_id;
+        ints[1][i] = proc->pid;
+        ints[2][i] = proc->nice_value;
+        ints[3][i] = proc->weight;
+        for (int k = 0; k < LONGS; k++) longs[k][i] = row[k];
+
+        const char *group = proc->group_idx >= 0 ? scheduler.groups[proc->group_idx].name : "";
+        group_off[i + 1] = group_off[i] + (int32_t)strlen(group);
+        memcpy(groups + group_off[i], group, group_off[i + 1] - group_off[i]);
+        const char *admission = admit_reason_names[proc->admission];
+        admission_off[i + 1] = admission_off[i] + (int32_t)strlen(admission);
+        memcpy(admissions + admission_off[i], admission, admission_off[i + 1] - admission_off[i]);
+    }
+
+    arrow_column_t cols[NUM_FIELDS];
+    for (int k = 0; k < INTS; k++) cols[k] = (arrow_column_t){ ints[k], NULL };
+    for (int k = 0; k < LONGS; k++) cols[INTS + k] = (arrow_column_t){ longs[k], NULL };
+    cols[INTS + LONGS] = (arrow_column_t){ groups, group_off };
+    cols[INTS + LONGS + 1] = (arrow_column_t){ admissions, admission_off };
+
+    char total[32];
+    snprintf(total, sizeof(total), "%ld", scheduler.makespan_ms);
+    const arrow_meta_t meta[] = {
+        { "producer", "cfs_scheduler" }, { "name", "Heuristic CFS (C)" }, { "time_unit", "ms" },
+        { "vruntime_unit", "ns" }, { "total_time", total }, { "num_cpus", "1" },
+    };
+    return results_write(dir, "tasks.arrow", fields, NUM_FIELDS, meta, sizeof(meta) / sizeof(meta[0]),
+                         cols, scheduler.num_processes);
+}
+
+// consecutive slices of one task with at most a tick between them are one interval
+static int results_export_gantt(const char *dir, int32_t *task, int64_t *start, int64_t *end, int32_t *cpu) {
+    static const arrow_field_t fields[] = {
+        { "task", ARROW_INT32 }, { "start", ARROW_INT64 }, { "end", ARROW_INT64 }, { "cpu", ARROW_INT32 },
+    };
+    long rows = 0;
+    for (long i = 0; i < num_decisions; i++) {
+        decision_t *d = &decisions[i];
+        if (rows > 0 && task[rows - 1] == d->task && d->start_ms - end[rows - 1] <= 1) {
+            end[rows - 1] = d->end_ms;
+            continue;
+        }
+        task[rows] = d->task;
+        start[rows] = d->start_ms;
+        end[rows] = d->end_ms;
+        cpu[rows++] = 0;
+    }
+    const arrow_column_t cols[] = { { task, NULL }, { start, NULL }, { end, NULL }, { cpu, NULL } };
+    const arrow_meta_t meta[] = { { "producer", "cfs_scheduler" }, { "time_unit", "ms" } };
+    return results_write(dir, "gantt.arrow", fields, 4, meta, 2, cols, rows);
+}
+
+static int results_export_decisions(const char *dir, int32_t *ints[4], int64_t *longs[4]) {
+    static const arrow_field_t fields[] = {
+        { "time", ARROW_INT64 }, { "task", ARROW_INT32 }, { "vruntime", ARROW_INT64 },
+        { "runnable", ARROW_INT32 }, { "slice", ARROW_INT32 }, { "ran", ARROW_INT64 },
+        { "dispatch_wait", ARROW_INT64 }, { "policy", ARROW_INT32 },
+    };
+    for (long i = 0; i < num_decisions; i++) {
+        decision_t *d = &decisions[i];
+        longs[0][i] = d->start_ms;
+        longs[1][i] = (int64_t)d->vruntime_ns;
+        longs[2][i] = d->end_ms - d->start_ms;
+        longs[3][i] = d->dispatch_wait_ms;
+        ints[0][i] = d->task;
+        ints[1][i] = d->runnable;
+        ints[2][i] = d->slice_ms;
+        ints[3][i] = d->policy;
+    }
+
+    // policy is a code into the comma list in the schema metadata
+    char names[256] = "";
+    for (int p = 0; p < NUM_POLICIES; p++) {
+        snprintf(names + strlen(names), sizeof(names) - strlen(names), "%s%s", p ? "," : "", policies[p].name);
+    }
+    const arrow_column_t cols[] = {
+        { longs[0], NULL }, { ints[0], NULL }, { longs[1], NULL }, { ints[1], NULL },
+        { ints[2], NULL }, { longs[2], NULL }, { longs[3], NULL }, { ints[3], NULL },
+    };
+    const arrow_meta_t meta[] = {
+        { "producer", "cfs_scheduler" }, { "time_unit", "ms" }, { "vruntime_unit", "ns" },
+        { "policy.names", names },
+    };
+    return results_write(dir, "decisions.arrow", fields, 8, meta, 4, cols, num_decisions);
+}
+
+void results_export(const char *dir) {
+    if (mkdir(dir, 0755) < 0 && errno != EEXIST) {
+        perror(dir);
+        return;
+    }
+    // column buffers sized for the decision log, reused by the gantt intervals
+    int32_t *ints[4];
+    int64_t *longs[4];
+    size_t rows = num_decisions ? num_decisions : 1;
+    int failed = 0;
+    for (int k = 0; k < 4; k++) {
+        ints[k] = malloc(rows * sizeof(int32_t));
+        longs[k] = malloc(rows * sizeof(int64_t));
+        failed |= !ints[k] || !longs[k];
+    }
+    if (failed) perror("malloc");
+    else {
+        failed = results_export_tasks(dir) < 0;
+        failed |= results_export_gantt(dir, ints[0], longs[0], longs[1], ints[1]) < 0;
+        failed |= results_export_decisions(dir, ints, longs) < 0;
+    }
+    if (!failed) {
+        printf("\nResults: %d tasks, %ld slices written to %s/{tasks,gantt,decisions}.arrow\n",
+               scheduler.num_processes, num_decisions, dir);
+    }
+    for (int k = 0; k < 4; k++) {
+        free(ints[k]);
+        free(longs[k]);
+    }
+    free(decisions);
+    decisions = NULL;
+    num_decisions = cap_decisions = 0;
+}
+
+// main scheduling loop - uses SIGSTOP/SIGCONT for context switching
+void schedule_processes(void) {
+    printf("\n=== Starting CFS + Heuristic Scheduler ===\n\n");
+
+    PROFILE_START();
+    while (scheduler.completed_count < scheduler.num_processes) {
+        PROFILE_DECISION();
+        long current_time = get_time_ms();
+        scheduler.current_time_ms = current_time;
+
+        admit_arrivals(current_time);
+
+        if (config.slo_control) {
+            run_slo_controller(current_time);
+        }
+        if (config.meta_policy) {
+            run_regime_classifier(current_time);
+        }
+        run_memory_control(current_time, psi_poll());
+        drf_account(current_time);
+
+        watchdog_tick(current_time);
+        stats_publish(current_time);
+        ring_snapshot(current_time);
+        PROFILE_LAP(PH_METRICS);
+        int next_idx = select_next_process_cfs_heuristic();
+
+        // the watchdog overrides the policy for a task at its wait bound
+        if (scheduler.forced_idx != -1) {
+            if (on_run_queue(&scheduler.processes[scheduler.forced_idx])) {
+                if (scheduler.forced_idx != next_idx) {
+                    scheduler.processes[scheduler.forced_idx].forced_dispatches++;
+                    scheduler.forced_total++;
+                }
+                next_idx = scheduler.forced_idx;
+            }
+            scheduler.forced_idx = -1;
+        }
+        PROFILE_LAP(PH_PICK);
+
+        if (next_idx == -1) {
+            scheduler.rate_idle = 1;
+            usleep(SCHEDULER_TICK_US);
+            PROFILE_LAP(PH_WAIT);
+            continue;
+        }
+
+        process_t *proc = &scheduler.processes[next_idx];
+
+        long elapsed = current_time - scheduler.scheduler_start_time_ms;
+        if (elapsed < proc->arrival_time_ms) {
+            usleep(SCHEDULER_TICK_US);
+            PROFILE_LAP(PH_WAIT);
+            continue;
+        }
+
+        // context switch
+        long dispatch_wait = -1;
+        if (scheduler.current_process_idx != -1 &&
+            scheduler.current_process_idx != next_idx) {
+            process_t *prev = &scheduler.processes[scheduler.current_process_idx];
+            if (prev->state == PROC_RUNNING) {
+                CFS_PROBE3(switch_out, prev->task_id, prev->vruntime_ns, 0);
+                trace_emit(TR_SWITCH_OUT, prev->task_id, 0);
+                stop_process(prev->pid);
+                prev->state = PROC_STOPPED;
+            }
+        }
+
+        if (proc->state == PROC_READY || proc->state == PROC_STOPPED) {
+            if (proc->first_run == 0) {
+                proc->first_run = 1;
                 proc->response_time_ms = current_time - scheduler.scheduler_start_time_ms - proc->arrival_time_ms;
                 proc->start_time_ms = current_time;
             }
+            dispatch_wait = current_time - proc->ready_since_ms;
+            record_dispatch_latency(proc, current_time);
+            record_bounded_wait(proc, current_time);
+            if (proc->mem_mb > 0) proc->mem_active = 1;
+            PROFILE_LAP(PH_ACCOUNT);
+            shadow_emit(EV_PICK, next_idx, current_time, 0, 0, scheduler.ready_mask);
+            PROFILE_LAP(PH_TRACE);
 
+            CFS_PROBE3(switch_in, proc->task_id, proc->vruntime_ns, current_time - proc->ready_since_ms);
+            trace_emit(TR_SWITCH_IN, proc->task_id, current_time - proc->ready_since_ms);
             continue_process(proc->pid);
             proc->state = PROC_RUNNING;
             scheduler.current_process_idx = next_idx;
+            scheduler.dispatches++;
+
+            // a task switched in after someone else owes its cache refill again
+            if (scheduler.cache_owner != next_idx) {
+                proc->warm_owed_ms = proc->warm_ms;
+            }
+
+            int quantum = TIME_QUANTUM_MS;
+            if (config.adaptive_quantum) {
+                proc->slice_context = bandit_context(proc);
+                proc->slice_arm = bandit_pick(proc, proc->slice_context);
+                quantum = quantum_arms_ms[proc->slice_arm];
+            }
 
             // time slice based on weight
-            int time_slice = (TIME_QUANTUM_MS * CFS_WEIGHT_NICE_0) / proc->weight;
+            int time_slice = (quantum * CFS_WEIGHT_NICE_0) / proc->weight;
             if (time_slice < MIN_GRANULARITY_MS) {
                 time_slice = MIN_GRANULARITY_MS;
             }
+            int io_left = proc->warm_owed_ms + proc->io_run_ms - proc->ran_since_wake_ms;
+            if (proc->io_run_ms > 0 && time_slice > io_left) {
+                time_slice = io_left;
+            }
             proc->time_slice_remaining_ms = time_slice;
+            PROFILE_LAP(PH_ACCOUNT);
 
             printf("[T=%4ld ms] Scheduled P%d (PID=%d) | vruntime=%lu ns | remaining=%d ms | aging=%d\n",
                    elapsed, proc->task_id, proc->pid,
                    proc->vruntime_ns, proc->remaining_time_ms, proc->aging_boost);
+            PROFILE_LAP(PH_TRACE);
         }
 
         // let it run
+        scheduler.slices++;
+        stats_publish(current_time);
         long exec_start = get_time_ms();
-        usleep(proc->time_slice_remaining_ms * 1000);
+        run_slice(proc->time_slice_remaining_ms);
+        if (config.slice_ext) {
+            grant_slice_extension(proc, next_idx);
+        }
+        PROFILE_LAP(PH_WAIT);
         long exec_end = get_time_ms();
         long executed_time = exec_end - exec_start;
+        results_record(proc, exec_start, exec_end, dispatch_wait);
+
+        // cpu spent refilling the cache is charged but makes no progress
+        long progress = executed_time - proc->warm_owed_ms;
+        if (progress < 0) progress = 0;
+        proc->warm_owed_ms -= executed_time - progress;
+
+        // so does spinning on the shared lock
+        long spun = atomic_load(&shared_page->tasks[next_idx].spin_ms) - proc->spin_seen_ms;
+        proc->spin_seen_ms += spun;
+        progress -= spun;
+        if (progress < 0) progress = 0;
+
+        // and for a mem worker, time blocked on refaults: count only its cpu
+        if (proc->mem_mb > 0) {
+            long cpu = atomic_load(&shared_page->tasks[next_idx].cpu_ms) - proc->cpu_seen_ms;
+            proc->cpu_seen_ms += cpu;
+            if (progress > cpu) progress = cpu;
+        }
+        scheduler.cache_owner = next_idx;
 
-        proc->remaining_time_ms -= executed_time;
+        proc->remaining_time_ms -= progress;
         if (proc->remaining_time_ms <= 0) {
             proc->remaining_time_ms = 0;
         }
 
         update_vruntime(proc, executed_time);
+        proc->run_time_ms += executed_time;
+        fairshare_charge(proc, executed_time);
+        drf_charge(proc, executed_time, exec_end);
+        admission_track(progress, exec_end);
+        scheduler.policy_time_ms[scheduler.active_policy] += executed_time;
+        if (config.adaptive_quantum) {
+            bandit_update(proc, executed_time, progress, exec_end);
+        }
+        PROFILE_LAP(PH_ACCOUNT);
+        shadow_emit(EV_RAN, next_idx, exec_end, proc->vruntime_ns, proc->remaining_time_ms, 0);
+        PROFILE_LAP(PH_TRACE);
 
         // check completion
         int status;
@@ -324,18 +3805,41 @@ void schedule_processes(void) {
             proc->state = PROC_COMPLETED;
             proc->finish_time_ms = get_time_ms();
             scheduler.completed_count++;
+            scheduler.makespan_ms = proc->finish_time_ms - scheduler.scheduler_start_time_ms;
+            drf_release(proc);
+            release_dependents(proc, proc->finish_time_ms);
+            PROFILE_LAP(PH_ACCOUNT);
+            shadow_emit(EV_COMPLETE, next_idx, proc->finish_time_ms, 0, 0, 0);
 
             long turnaround = proc->finish_time_ms - scheduler.scheduler_start_time_ms - proc->arrival_time_ms;
-            proc->wait_time_ms = turnaround - proc->burst_time_ms;
+            proc->wait_time_ms = turnaround - proc->burst_time_ms - proc->total_sleep_ms;
+            CFS_PROBE3(complete, proc->task_id, proc->vruntime_ns, turnaround);
+            trace_emit(TR_COMPLETE, proc->task_id, turnaround);
 
             printf("[T=%4ld ms] Completed P%d | turnaround=%ld ms | wait=%ld ms | vruntime=%lu ns\n",
                    get_time_ms() - scheduler.scheduler_start_time_ms,
                    proc->task_id, turnaround, proc->wait_time_ms, proc->vruntime_ns);
+            PROFILE_LAP(PH_TRACE);
         } else {
+            if (proc->lock_hold_ms > 0) {
+                proc->lock_stops++;
+                if (atomic_load(&shared_page->tasks[next_idx].in_critical)) proc->lock_preempted++;
+            }
+            PROFILE_LAP(PH_ACCOUNT);
+            CFS_PROBE3(switch_out, proc->task_id, proc->vruntime_ns, executed_time);
+            trace_emit(TR_SWITCH_OUT, proc->task_id, executed_time);
             stop_process(proc->pid);
             proc->state = PROC_STOPPED;
+            proc->ready_since_ms = get_time_ms();
+
+            proc->ran_since_wake_ms += progress;
+            if (proc->io_run_ms > 0 && proc->ran_since_wake_ms >= proc->io_run_ms) {
+                put_to_sleep(proc, proc->ready_since_ms);
+            }
         }
+        PROFILE_LAP(PH_ACCOUNT);
     }
+    PROFILE_DECISION();
 
     printf("\n=== All processes completed ===\n");
 }
@@ -383,6 +3887,8 @@ void print_final_statistics(void) {
     long total_turnaround = 0;
     long max_wait = 0;
     long min_wait = LONG_MAX;
+    long waits[MAX_PROCESSES];
+    int admitted = 0;
 
     printf("\n");
     printf("╔════════════════════════════════════════════════════════════════════╗\n");
@@ -395,8 +3901,20 @@ void print_final_statistics(void) {
     for (int i = 0; i < scheduler.num_processes; i++) {
         process_t *proc = &scheduler.processes[i];
         long turnaround = proc->finish_time_ms - scheduler.scheduler_start_time_ms - proc->arrival_time_ms;
-        long wait = turnaround - proc->burst_time_ms;
+        long wait = turnaround - proc->burst_time_ms - proc->total_sleep_ms;
+
+        if (proc->admission >= ADMIT_REJECT_QUEUE_FULL) {
+            printf("║   P%-2d  ║   rejected    ║      %4ld     ║   %10lu   ║    %2d   ║\n",
+                   proc->task_id, turnaround, proc->vruntime_ns, proc->aging_boost);
+            continue;
+        }
 
+        int k = admitted++;
+        while (k > 0 && waits[k - 1] > wait) {
+            waits[k] = waits[k - 1];
+            k--;
+        }
+        waits[k] = wait;
         total_wait += wait;
         total_turnaround += turnaround;
 
@@ -411,18 +3929,850 @@ void print_final_statistics(void) {
     printf("╠════════╩═══════════════╩═══════════════╩════════════════╩═════════╣\n");
     printf("║                        AGGREGATE METRICS                           ║\n");
     printf("╠════════════════════════════════════════════════════════════════════╣\n");
-    printf("║  Average Wait Time       : %8.2f ms                             ║\n",
-           (double)total_wait / scheduler.num_processes);
-    printf("║  Average Turnaround Time : %8.2f ms                             ║\n",
-           (double)total_turnaround / scheduler.num_processes);
-    printf("║  Min Wait Time           : %8ld ms                             ║\n", min_wait);
-    printf("║  Max Wait Time           : %8ld ms                             ║\n", max_wait);
+    if (admitted == 0) {
+        // every task was rejected: there is no wait to report
+        static const char *names[] = { "Average Wait Time      ", "Average Turnaround Time",
+                                       "Min Wait Time          ", "P99 Wait Time          ",
+                                       "Max Wait Time          " };
+        for (int i = 0; i < 5; i++) {
+            printf("║  %s : %8s                                ║\n", names[i], "-");
+        }
+    } else {
+        printf("║  Average Wait Time       : %8.2f ms                             ║\n",
+               (double)total_wait / admitted);
+        printf("║  Average Turnaround Time : %8.2f ms                             ║\n",
+               (double)total_turnaround / admitted);
+        printf("║  Min Wait Time           : %8ld ms                             ║\n", min_wait);
+        printf("║  P99 Wait Time           : %8ld ms                             ║\n",
+               waits[(admitted * 99 + 99) / 100 - 1]);
+        printf("║  Max Wait Time           : %8ld ms                             ║\n", max_wait);
+    }
     printf("║  Total Processes         : %8d                                  ║\n",
            scheduler.num_processes);
+    printf("║  Makespan                : %8ld ms                             ║\n",
+           scheduler.makespan_ms);
+    printf("╚════════════════════════════════════════════════════════════════════╝\n");
+
+    PROFILE_REPORT();
+}
+
+// per-task latency slo attainment, only printed when the workload sets targets
+void print_slo_report(void) {
+    int any = 0;
+    for (int i = 0; i < scheduler.num_processes; i++) {
+        if (scheduler.processes[i].slo_target_ms > 0) any = 1;
+    }
+    if (!any) return;
+
+    printf("\n");
+    printf("╔════════════════════════════════════════════════════════════════════╗\n");
+    printf("║               LATENCY SLO ATTAINMENT (%s WEIGHT CONTROL)            ║\n",
+           config.slo_control ? "PI" : "NO");
+    printf("╠════════╦════════════╦════════════╦══════════════╦══════════════════╣\n");
+    printf("║ Task   ║  Target    ║  p99 Lat   ║  Attained    ║  Weight          ║\n");
+    printf("║   ID   ║  (ms)      ║  (ms)      ║  (samples)   ║  (base -> eff)   ║\n");
+    printf("╠════════╬════════════╬════════════╬══════════════╬══════════════════╣\n");
+
+    for (int i = 0; i < scheduler.num_processes; i++) {
+        process_t *proc = &scheduler.processes[i];
+        if (proc->slo_target_ms == 0) continue;
+
+        double attained = proc->latency_samples > 0 ?
+            100.0 * proc->latency_met / proc->latency_samples : 0.0;
+        printf("║   P%-2d  ║    %4d    ║    %4d    ║   %6.1f%%    ║  %5d -> %5d  ║\n",
+               proc->task_id, proc->slo_target_ms, latency_percentile(proc, 99),
+               attained, proc->base_weight, proc->weight);
+    }
+
+    printf("╚════════╩════════════╩════════════╩══════════════╩══════════════════╝\n");
+}
+
+void print_fairshare_report(void) {
+    double now_s = get_wall_time_s();
+
+    printf("\n");
+    printf("╔════════════════════════════════════════════════════════════════════╗\n");
+    printf("║              DECAYED FAIR SHARE (half-life %8.0f s)              ║\n",
+           config.fairshare_half_life_s);
+    printf("╠══════════════════╦═════════╦════════════════╦═════════╦═══════════╣\n");
+    printf("║ Group            ║  Tasks  ║  Usage (ms)    ║  Share  ║  Factor   ║\n");
+    printf("╠══════════════════╬═════════╬════════════════╬═════════╬═══════════╣\n");
+
+    for (int i = 0; i < scheduler.num_groups; i++) {
+        group_t *group = &scheduler.groups[i];
+        double factor = fairshare_factor(group, now_s);
+        if (group->usage_ms <= 0.0 && group->num_tasks == 0) continue;
+
+        double share = scheduler.total_usage_ms > 0.0 ?
+            100.0 * group->usage_ms / scheduler.total_usage_ms : 0.0;
+        printf("║ %-16.16s ║  %5d  ║  %12.1f  ║ %5.1f%%  ║   %5.3f   ║\n",
+               group->name, group->num_tasks, group->usage_ms, share, factor);
+    }
+
+    printf("╚══════════════════╩═════════╩════════════════╩═════════╩═══════════╝\n");
+}
+
+// quanta the bandit settled on, only printed with -A
+void print_quantum_report(void) {
+    if (!config.adaptive_quantum) return;
+
+    printf("\n");
+    printf("╔════════════════════════════════════════════════════════════════════╗\n");
+    printf("║                 ADAPTIVE QUANTUM (PER-TASK BANDIT)                 ║\n");
+    printf("╠════════╦════════╦═══════════════════════════╦══════════════════════╣\n");
+    printf("║ Task   ║  Warm  ║  Slices per quantum       ║  Best quantum (ms)   ║\n");
+    printf("║   ID   ║  (ms)  ║   %2d /  %2d /  %2d /  %2d ms ║  alone / sensitive   ║\n",
+           quantum_arms_ms[0], quantum_arms_ms[1], quantum_arms_ms[2], quantum_arms_ms[3]);
+    printf("╠════════╬════════╬═══════════════════════════╬══════════════════════╣\n");
+
+    for (int i = 0; i < scheduler.num_processes; i++) {
+        process_t *proc = &scheduler.processes[i];
+        int best[BANDIT_CONTEXTS];
+        for (int ctx = 0; ctx < BANDIT_CONTEXTS; ctx++) {
+            best[ctx] = -1;
+            for (int arm = 0; arm < QUANTUM_ARMS; arm++) {
+                if (proc->bandit_pulls[ctx][arm] == 0) continue;
+                if (best[ctx] < 0 || proc->bandit_value[ctx][arm] > proc->bandit_value[ctx][best[ctx]]) {
+                    best[ctx] = arm;
+                }
+            }
+        }
+
+        printf("║  P%-4d ║  %4d  ║  %4ld %4ld %4ld %4ld     ║    %3d  /  %3d       ║\n",
+               proc->task_id, proc->warm_ms,
+               proc->arm_pulls[0], proc->arm_pulls[1], proc->arm_pulls[2], proc->arm_pulls[3],
+               best[0] >= 0 ? quantum_arms_ms[best[0]] : 0,
+               best[1] >= 0 ? quantum_arms_ms[best[1]] : 0);
+    }
+
+    printf("╚════════╩════════╩═══════════════════════════╩══════════════════════╝\n");
+}
+
+// live policy vs each shadow, only printed with -S
+void print_shadow_report(void) {
+    if (!shadows) return;
+
+    int n = scheduler.num_processes;
+    double wait = 0, resp = 0;
+    for (int i = 0; i < n; i++) {
+        wait += scheduler.processes[i].wait_time_ms;
+        resp += scheduler.processes[i].response_time_ms;
+    }
+
+    printf("\n");
+    printf("╔════════════════════════════════════════════════════════════════════╗\n");
+    printf("║                    SHADOW POLICY EVALUATION                        ║\n");
+    printf("╠══════════════════╦════════════╦════════════╦════════════╦══════════╣\n");
+    printf("║ Policy           ║  Differs   ║  Avg Wait  ║  Avg Resp  ║ Makespan ║\n");
+    printf("║                  ║  (picks)   ║  (ms)      ║  (ms)      ║  (ms)    ║\n");
+    printf("╠══════════════════╬════════════╬════════════╬════════════╬══════════╣\n");
+    printf("║ %-16s ║      -     ║  %8.1f  ║  %8.1f  ║  %6ld  ║\n",
+           config.meta_policy ? "live (adaptive)" :
+           config.learned_model ? "live (learned)" : "live (heuristic)",
+           wait / n, resp / n, scheduler.makespan_ms);
+
+    int k = 0;
+    for (int p = 0; p < NUM_POLICIES; p++) {
+        if (!(config.shadow_mask & (1u << p))) continue;
+        shadow_t *sh = &shadows[k++];
+
+        double sw = 0, sr = 0;
+        long makespan = 0;
+        int finished = 0;
+        for (int i = 0; i < n; i++) {
+            process_t *proc = &sh->tasks[i];
+            if (proc->state != PROC_COMPLETED) continue;
+            finished++;
+            sw += proc->wait_time_ms;
+            sr += proc->response_time_ms;
+            if (proc->finish_time_ms > makespan) makespan = proc->finish_time_ms;
+        }
+        if (finished == 0) finished = 1;
+
+        printf("║ shadow %-9s ║   %5.1f%%   ║  %8.1f  ║  %8.1f  ║  %6ld  ║\n",
+               policies[p].name,
+               sh->picks ? 100.0 * sh->disagreements / sh->picks : 0.0,
+               sw / finished, sr / finished, makespan);
+    }
+
+    printf("╚══════════════════╩════════════╩════════════╩════════════╩══════════╝\n");
+    printf("%ld events, %ld dropped, %.0f ns per event on the dispatch thread\n",
+           shadow_emitted, shadow_dropped,
+           shadow_emitted ? (double)shadow_emit_ns / shadow_emitted : 0.0);
+}
+
+// time under each policy and the switch log, only printed with -M
+void print_regime_report(void) {
+    if (!config.meta_policy) return;
+
+    long total = 0;
+    for (int p = 0; p < NUM_POLICIES; p++) total += scheduler.policy_time_ms[p];
+    if (total == 0) total = 1;
+
+    printf("\n");
+    printf("╔════════════════════════════════════════════════════════════════════╗\n");
+    printf("║               ADAPTIVE POLICY SELECTION (%3d switches)             ║\n",
+           scheduler.num_switches);
+    printf("╠══════════════════╦══════════════════╦══════════════════════════════╣\n");
+    printf("║ Policy           ║  CPU time (ms)   ║  Share                       ║\n");
+    printf("╠══════════════════╬══════════════════╬══════════════════════════════╣\n");
+    for (int p = 0; p < NUM_POLICIES; p++) {
+        if (scheduler.policy_time_ms[p] == 0) continue;
+        printf("║ %-16s ║  %14ld  ║  %5.1f%%                      ║\n", policies[p].name,
+               scheduler.policy_time_ms[p], 100.0 * scheduler.policy_time_ms[p] / total);
+    }
+    printf("╚══════════════════╩══════════════════╩══════════════════════════════╝\n");
+
+    int logged = scheduler.num_switches < REGIME_LOG ? scheduler.num_switches : REGIME_LOG;
+    for (int k = 0; k < logged; k++) {
+        printf("  %6ld ms  -> %s\n", scheduler.switch_time_ms[k], policies[scheduler.switch_policy[k]].name);
+    }
+}
+
+// bounded-wait guarantee: watchdog activity and how close dispatches came to the bound
+void print_wait_report(void) {
+    if (config.max_wait_ms <= 0) return;
+
+    long worst = 0;
+    for (int i = 0; i < scheduler.num_processes; i++) {
+        if (scheduler.processes[i].max_dispatch_wait_ms > worst) {
+            worst = scheduler.processes[i].max_dispatch_wait_ms;
+        }
+    }
+    long samples = scheduler.wait_samples > 0 ? scheduler.wait_samples : 1;
+
+    printf("\n");
+    printf("╔════════════════════════════════════════════════════════════════════╗\n");
+    printf("║            BOUNDED WAIT (bound %5d ms, forced at %3d%%)            ║\n",
+           config.max_wait_ms, WATCHDOG_MARGIN_PCT);
+    printf("╠════════════════════════════════════════════════════════════════════╣\n");
+    printf("║  Watchdog fires          : %8ld                                ║\n", scheduler.watchdog_fires);
+    printf("║  Forced dispatches       : %8ld                                ║\n", scheduler.forced_total);
+    printf("║  Bound violations        : %8ld of %-8ld dispatches          ║\n",
+           scheduler.wait_violations, scheduler.wait_samples);
+    printf("║  Worst dispatch wait     : %8ld ms (%5.1f%% of bound)           ║\n",
+           worst, 100.0 * worst / config.max_wait_ms);
+    printf("║  Best effort: one task is forced per tick, and tasks parked by -R  ║\n");
+    printf("║  are exempt from the bound                                         ║\n");
+    printf("╠══════════════════╦══════════════════╦══════════════════════════════╣\n");
+    printf("║ Wait / bound     ║  Dispatches      ║  Share                       ║\n");
+    printf("╠══════════════════╬══════════════════╬══════════════════════════════╣\n");
+    for (int b = 0; b <= WAIT_BANDS; b++) {
+        if (scheduler.wait_bands[b] == 0) continue;
+        char band[16];
+        if (b == WAIT_BANDS) {
+            snprintf(band, sizeof(band), "> 100%%");
+        } else {
+            snprintf(band, sizeof(band), "%3d-%3d%%", b * 100 / WAIT_BANDS, (b + 1) * 100 / WAIT_BANDS);
+        }
+        printf("║ %-16s ║  %14ld  ║  %5.1f%%                      ║\n",
+               band, scheduler.wait_bands[b], 100.0 * scheduler.wait_bands[b] / samples);
+    }
+    printf("╠══════════════════╬══════════════════╬══════════════════════════════╣\n");
+    printf("║ Task             ║  Max wait (ms)   ║  Forced                      ║\n");
+    printf("╠══════════════════╬══════════════════╬══════════════════════════════╣\n");
+    for (int i = 0; i < scheduler.num_processes; i++) {
+        process_t *proc = &scheduler.processes[i];
+        printf("║ P%-15d ║  %14ld  ║  %8d                    ║\n",
+               proc->task_id, proc->max_dispatch_wait_ms, proc->forced_dispatches);
+    }
+    printf("╚══════════════════╩══════════════════╩══════════════════════════════╝\n");
+}
+
+// lock-holder preemption and critical-section throughput, only for lock workloads
+void print_lock_report(void) {
+    int any = 0;
+    long sections = 0, spin = 0, stops = 0, preempted = 0;
+    for (int i = 0; i < scheduler.num_processes; i++) {
+        process_t *proc = &scheduler.processes[i];
+        if (proc->lock_hold_ms == 0) continue;
+        any = 1;
+        sections += atomic_load(&shared_page->tasks[i].sections);
+        spin += atomic_load(&shared_page->tasks[i].spin_ms);
+        stops += proc->lock_stops;
+        preempted += proc->lock_preempted;
+    }
+    if (!any) return;
+
+    double seconds = scheduler.makespan_ms > 0 ? scheduler.makespan_ms / 1000.0 : 1.0;
+
+    printf("\n");
+    printf("╔════════════════════════════════════════════════════════════════════╗\n");
+    printf("║                SHARED LOCK (slice extension %-3s)                   ║\n",
+           config.slice_ext ? "on" : "off");
+    printf("╠════════╦══════════╦══════════╦═════════════╦═══════════════════════╣\n");
+    printf("║ Task   ║ Sections ║  Spin    ║ Preempted   ║ Extensions            ║\n");
+    printf("║   ID   ║          ║  (ms)    ║ holding     ║ ok/denied/overrun ms  ║\n");
+    printf("╠════════╬══════════╬══════════╬═════════════╬═══════════════════════╣\n");
+    for (int i = 0; i < scheduler.num_processes; i++) {
+        process_t *proc = &scheduler.processes[i];
+        if (proc->lock_hold_ms == 0) continue;
+        printf("║   P%-2d  ║ %8ld ║ %8ld ║ %4d / %-4d ║ %3d/%3d/%3d %7ld%s  ║\n",
+               proc->task_id, atomic_load(&shared_page->tasks[i].sections),
+               atomic_load(&shared_page->tasks[i].spin_ms), proc->lock_preempted, proc->lock_stops,
+               proc->ext_granted, proc->ext_denied, proc->ext_overruns, proc->ext_ms,
+               proc->ext_revoked ? "!" : " ");
+    }
+    printf("╠════════╩══════════╩══════════╩═════════════╩═══════════════════════╣\n");
+    printf("║  Lock-holder preemptions : %5.1f%% of %-6ld slice-end stops        ║\n",
+           stops > 0 ? 100.0 * preempted / stops : 0.0, stops);
+    printf("║  CPU lost spinning       : %8ld ms                             ║\n", spin);
+    printf("║  Throughput              : %8.1f sections/s                     ║\n", sections / seconds);
+    printf("╚════════════════════════════════════════════════════════════════════╝\n");
+}
+
+// disk workers: time in real i/o phases and the i/o priority they ended with
+void print_disk_report(void) {
+    int any = 0;
+    for (int i = 0; i < scheduler.num_processes; i++) {
+        if (scheduler.processes[i].disk_kb > 0) any = 1;
+    }
+    if (!any) return;
+
+    printf("\n");
+    printf("╔════════════════════════════════════════════════════════════════════╗\n");
+    printf("║                DISK WORKERS (i/o priority sync %-3s)                ║\n",
+           config.io_priority ? "on" : "off");
+    printf("╠════════╦════════╦═══════════════╦══════════╦═══════════╦═══════════╣\n");
+    printf("║ Task   ║  Nice  ║   I/O prio    ║  Phases  ║ Avg phase ║Turnaround ║\n");
+    printf("║   ID   ║        ║   (updates)   ║          ║   (ms)    ║   (ms)    ║\n");
+    printf("╠════════╬════════╬═══════════════╬══════════╬═══════════╬═══════════╣\n");
+    for (int i = 0; i < scheduler.num_processes; i++) {
+        process_t *proc = &scheduler.processes[i];
+        if (proc->disk_kb == 0) continue;
+
+        char prio[32];
+        if (proc->io_level < 0) {
+            snprintf(prio, sizeof(prio), "-");
+        } else {
+            snprintf(prio, sizeof(prio), "be%d (%d)", proc->io_level, proc->io_updates);
+        }
+        long turnaround = proc->finish_time_ms - scheduler.scheduler_start_time_ms - proc->arrival_time_ms;
+        printf("║   P%-2d  ║  %4d  ║ %-13.13s ║ %8d ║ %9.1f ║  %7ld  ║\n",
+               proc->task_id, proc->nice_value, prio, proc->disk_phases,
+               proc->disk_phases ? (double)proc->disk_ms / proc->disk_phases : 0.0, turnaround);
+    }
+    printf("╚════════╩════════╩═══════════════╩══════════╩═══════════╩═══════════╝\n");
+}
+
+// memory workers: footprint, refaults and how often they were parked
+void print_memory_report(void) {
+    int any = 0;
+    long faults = 0, work = 0;
+    for (int i = 0; i < scheduler.num_processes; i++) {
+        process_t *proc = &scheduler.processes[i];
+        if (proc->mem_mb == 0) continue;
+        any = 1;
+        faults += proc->maj_faults;
+        work += proc->burst_time_ms;
+    }
+    if (!any) return;
+
+    double seconds = scheduler.makespan_ms > 0 ? scheduler.makespan_ms / 1000.0 : 1.0;
+
+    printf("\n");
+    printf("╔════════════════════════════════════════════════════════════════════╗\n");
+    printf("║             MEMORY PRESSURE (active-set control %s)%-*s║\n",
+           config.mem_control ? "on" : "off", config.mem_control ? 16 : 15, "");
+    printf("╠════════╦══════════╦══════════════╦═════════════╦═══════════════════╣\n");
+    printf("║ Task   ║ Size     ║  Peak RSS    ║  Major      ║  Parked           ║\n");
+    printf("║   ID   ║ (MiB)    ║  (MiB)       ║  faults     ║                   ║\n");
+    printf("╠════════╬══════════╬══════════════╬═════════════╬═══════════════════╣\n");
+    for (int i = 0; i < scheduler.num_processes; i++) {
+        process_t *proc = &scheduler.processes[i];
+        if (proc->mem_mb == 0) continue;
+        printf("║   P%-2d  ║ %8d ║  %10ld  ║ %11ld ║ %17d ║\n",
+               proc->task_id, proc->mem_mb, proc->peak_rss_kb / 1024, proc->maj_faults, proc->mem_parked);
+    }
+    printf("╠════════╩══════════╩══════════════╩═════════════╩═══════════════════╣\n");
+    printf("║  Major faults            : %8.1f /s                             ║\n", faults / seconds);
+    printf("║  Throughput              : %8.1f ms of work /s                  ║\n", work / seconds);
+    printf("║  PSI some avg10 peak     : memory %5.1f%%  cpu %5.1f%%               ║\n",
+           scheduler.psi_mem_peak, scheduler.psi_cpu_peak);
+    printf("║  PSI trigger events      : %8ld %-30s ║\n", scheduler.psi_events,
+           scheduler.psi_fd >= 0 ? "" : "(avg10 sampling)");
+    printf("║  Smallest active set     : %8d                                ║\n", scheduler.mem_limit_min);
+    printf("╚════════════════════════════════════════════════════════════════════╝\n");
+}
+
+// per-group cpu, memory and dominant shares while two or more groups competed
+void print_drf_report(void) {
+    int groups = 0, any_mem = 0;
+    for (int g = 0; g < scheduler.num_groups; g++) {
+        if (scheduler.groups[g].num_tasks > 0) groups++;
+    }
+    for (int i = 0; i < scheduler.num_processes; i++) {
+        if (scheduler.processes[i].mem_mb > 0) any_mem = 1;
+    }
+    if (groups < 2 || !any_mem || scheduler.drf_contended_ms == 0) return;
+
+    long cpu_total = 0;
+    for (int g = 0; g < scheduler.num_groups; g++) {
+        cpu_total += scheduler.groups[g].contended_cpu_ms;
+    }
+    if (cpu_total == 0) cpu_total = 1;
+
+    printf("\n");
+    printf("╔════════════════════════════════════════════════════════════════════╗\n");
+    printf("║        RESOURCE SHARES (%s picks, memory %6d MiB)         ║\n",
+           config.drf ? "dominant" : "cpu-only", config.mem_capacity_mb);
+    printf("╠══════════════════╦═════════╦═════════╦═════════╦═══════════════════╣\n");
+    printf("║ Group            ║  CPU    ║  Memory ║  Domi-  ║  Deferred (avg    ║\n");
+    printf("║                  ║  share  ║  share  ║  nant   ║  wait ms)         ║\n");
+    printf("╠══════════════════╬═════════╬═════════╬═════════╬═══════════════════╣\n");
+
+    double lo = 1e9, hi = 0.0, sum = 0.0, sum_sq = 0.0;
+    int n = 0;
+    for (int g = 0; g < scheduler.num_groups; g++) {
+        group_t *group = &scheduler.groups[g];
+        if (group->num_tasks == 0) continue;
+
+        double cpu = (double)group->contended_cpu_ms / cpu_total;
+        double mem = group->contended_mem_mb_ms / ((double)scheduler.drf_contended_ms * config.mem_capacity_mb);
+        double dominant = cpu > mem ? cpu : mem;
+        if (dominant < lo) lo = dominant;
+        if (dominant > hi) hi = dominant;
+        sum += dominant;
+        sum_sq += dominant * dominant;
+        n++;
+
+        printf("║ %-16.16s ║ %5.1f%%  ║ %5.1f%%  ║ %5.1f%%  ║  %4d (%7.1f)   ║\n",
+               group->name, 100.0 * cpu, 100.0 * mem, 100.0 * dominant, group->deferred,
+               group->deferred ? (double)group->deferred_ms / group->deferred : 0.0);
+    }
+
+    printf("╠══════════════════╩═════════╩═════════╩═════════╩═══════════════════╣\n");
+    printf("║  Contended time          : %8ld ms                             ║\n", scheduler.drf_contended_ms);
+    printf("║  Dominant share spread   : %8.1f points                         ║\n", 100.0 * (hi - lo));
+    printf("║  Jain index (dominant)   : %8.3f                                ║\n",
+           sum_sq > 0.0 ? sum * sum / (n * sum_sq) : 1.0);
+    printf("╚════════════════════════════════════════════════════════════════════╝\n");
+}
+
+// admission decisions by reason and the tail the admitted tasks actually saw
+void print_admission_report(void) {
+    if (config.admit_target_ms <= 0) return;
+
+    long waits[MAX_PROCESSES];
+    long done_work = 0;
+    int n = 0;
+    for (int i = 0; i < scheduler.num_processes; i++) {
+        process_t *proc = &scheduler.processes[i];
+        if (proc->admission != ADMIT_OK) continue;
+        long wait = proc->finish_time_ms - scheduler.scheduler_start_time_ms - proc->arrival_time_ms -
+                    proc->burst_time_ms - proc->total_sleep_ms;
+        int k = n++;
+        while (k > 0 && waits[k - 1] > wait) {
+            waits[k] = waits[k - 1];
+            k--;
+        }
+        waits[k] = wait;
+        done_work += proc->burst_time_ms;
+    }
+    double seconds = scheduler.makespan_ms > 0 ? scheduler.makespan_ms / 1000.0 : 1.0;
+
+    printf("\n");
+    printf("╔════════════════════════════════════════════════════════════════════╗\n");
+    printf("║           ADMISSION CONTROL (p99 wait target %6d ms)            ║\n",
+           config.admit_target_ms);
+    printf("╠════════════════════════════════════════════════════╦═══════════════╣\n");
+    printf("║ Decision                                           ║  Tasks        ║\n");
+    printf("╠════════════════════════════════════════════════════╬═══════════════╣\n");
+    for (int r = ADMIT_OK; r < ADMIT_REASONS; r++) {
+        if (scheduler.admit_counts[r] == 0 && r != ADMIT_OK) continue;
+        printf("║ %-50s ║  %11ld  ║\n", admit_reason_names[r], scheduler.admit_counts[r]);
+    }
+    printf("╠════════════════════════════════════════════════════╩═══════════════╣\n");
+    printf("║  Admitted wait p50       : %8ld ms                             ║\n",
+           n ? waits[(n * 50 + 99) / 100 - 1] : 0);
+    printf("║  Admitted wait p99       : %8ld ms                             ║\n",
+           n ? waits[(n * 99 + 99) / 100 - 1] : 0);
+    printf("║  Goodput                 : %8.1f ms of work /s                  ║\n", done_work / seconds);
+    printf("║  Delivered cpu rate      : %8.2f                                ║\n", scheduler.admit_rate);
+    printf("╚════════════════════════════════════════════════════════════════════╝\n");
+}
+
+// size of the binary trace written with -T
+void print_trace_report(void) {
+    if (!config.trace_path || trace_events == 0) return;
+
+    printf("\n");
+    printf("╔════════════════════════════════════════════════════════════════════╗\n");
+    printf("║                          BINARY TRACE                              ║\n");
+    printf("╠════════════════════════════════════════════════════════════════════╣\n");
+    printf("║  Events                  : %12lld                            ║\n", trace_events);
+    printf("║  Codec                   : %12s                            ║\n",
+           trace_codec_names[TRACE_CODEC_DEFAULT]);
+    printf("║  Blocks                  : %12ld                            ║\n", trace_blocks);
+    printf("║  Encoded                 : %12.2f bytes/event                ║\n",
+           (double)trace_raw_bytes / trace_events);
+    printf("║  On disk                 : %12.2f bytes/event                ║\n",
+           (double)trace_stored_bytes / trace_events);
+    printf("║  Writer stalls           : %12ld                            ║\n", trace_stalls);
+    if (config.explain_every) {
+        printf("║  Explained picks         : %12ld of %-8ld                ║\n",
+               scheduler.explain_records, scheduler.explain_picks);
+    }
+    if (trace_write_errors) {
+        printf("║  Write errors            : %12ld                            ║\n", trace_write_errors);
+    }
+    printf("╚════════════════════════════════════════════════════════════════════╝\n");
+}
+
+// ns per candidate for both scorers over the loaded workload; fails if the
+// model is over MODEL_BUDGET_NS. no children are forked
+int benchmark_scoring(void) {
+    long now = scheduler.scheduler_start_time_ms + 1000;
+    for (int i = 0; i < scheduler.num_processes; i++) {
+        process_t *proc = &scheduler.processes[i];
+        proc->arrived = 1;
+        proc->vruntime_ns = (unsigned long)(i % 7) * 3000000UL;
+        proc->remaining_time_ms = proc->burst_time_ms - (i % 5) * proc->burst_time_ms / 8;
+        proc->total_sleep_ms = (i % 3) * 40;
+        compute_heuristic_metrics(proc, now - (i % 4) * 30);
+    }
+
+    volatile long long sink = 0;
+    long long candidates = (long long)MODEL_BENCH_ROUNDS * scheduler.num_processes;
+    double cost_ns[2];
+    for (int scorer = 0; scorer < 2; scorer++) {
+        struct timespec start, end;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        for (int round = 0; round < MODEL_BENCH_ROUNDS; round++) {
+            for (int i = 0; i < scheduler.num_processes; i++) {
+                process_t *proc = &scheduler.processes[i];
+                sink += scorer ? model_score(proc, now + round) : heuristic_score(proc);
+            }
+        }
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        cost_ns[scorer] = ((end.tv_sec - start.tv_sec) * 1e9 + (end.tv_nsec - start.tv_nsec)) / candidates;
+    }
+    (void)sink;
+
+    int over = cost_ns[1] > MODEL_BUDGET_NS;
+    printf("\n");
+    printf("╔════════════════════════════════════════════════════════════════════╗\n");
+    printf("║                   SCORING COST PER CANDIDATE                       ║\n");
+    printf("╠═══════════════════════════════╦══════════════╦═════════════════════╣\n");
+    printf("║ Scorer                        ║  ns/cand     ║  Budget             ║\n");
+    printf("╠═══════════════════════════════╬══════════════╬═════════════════════╣\n");
+    printf("║ hand-written heuristic        ║  %10.2f  ║  -                  ║\n", cost_ns[0]);
+    printf("║ learned model (%d features)    ║  %10.2f  ║  %3d ns %-11s ║\n",
+           MODEL_FEATURES, cost_ns[1], MODEL_BUDGET_NS, over ? "(OVER)" : "(ok)");
+    printf("╚═══════════════════════════════╩══════════════╩═════════════════════╝\n");
+    printf("%d candidates x %d rounds, added cost %+.2f ns per candidate\n",
+           scheduler.num_processes, MODEL_BENCH_ROUNDS, cost_ns[1] - cost_ns[0]);
+
+    return over;
+}
+
+/* encode-and-write throughput of the binary trace: a synthetic
+   pick / switch_in / switch_out cycle over the loaded tasks with quantum-
+   sized gaps, through the real double buffers, writer thread, codec and
+   file. timestamps are synthetic so the clock read of trace_emit() is not
+   counted; it is reported separately */
+int benchmark_trace(void) {
+    trace_open(config.trace_path, 1);
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    uint64_t t = 0;
+    uint32_t rng = 12345;
+    int n = scheduler.num_processes;
+    for (long i = 0; i < TRACE_BENCH_EVENTS; i += 3) {
+        rng = rng * 1664525u + 1013904223u;
+        int task = scheduler.processes[(rng >> 8) % n].task_id;
+        long slice = TIME_QUANTUM_MS / 2 + (rng >> 20) % TIME_QUANTUM_MS;
+        trace_put(0, t += 2 + (rng >> 28), TR_PICK, task, 0, NULL);
+        trace_put(0, t += 100 + (rng >> 24), TR_SWITCH_IN, task, (rng >> 16) % 64, NULL);
+        trace_put(0, t += slice * 1000 + (rng >> 22), TR_SWITCH_OUT, task, slice, NULL);
+    }
+    long long events = trace_events;
+    trace_close();
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+
+    volatile uint64_t sink = 0;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < MODEL_BENCH_ROUNDS; i++) sink += trace_clock_ns();
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    (void)sink;
+    double clock_ns = ((end.tv_sec - start.tv_sec) * 1e9 + (end.tv_nsec - start.tv_nsec)) / MODEL_BENCH_ROUNDS;
+
+    printf("\n");
+    printf("╔════════════════════════════════════════════════════════════════════╗\n");
+    printf("║                     BINARY TRACE THROUGHPUT                        ║\n");
+    printf("╠════════════════════════════════════════════════════════════════════╣\n");
+    printf("║  Events                  : %12lld                            ║\n", events);
+    printf("║  Codec                   : %12s                            ║\n",
+           trace_codec_names[TRACE_CODEC_DEFAULT]);
+    printf("║  Encoded                 : %12.2f bytes/event                ║\n",
+           (double)trace_raw_bytes / events);
+    printf("║  On disk                 : %12.2f bytes/event                ║\n",
+           (double)trace_stored_bytes / events);
+    printf("║  Throughput              : %12.2f M events/s                 ║\n", events / seconds / 1e6);
+    printf("║  Writer stalls           : %12ld of %-8ld blocks         ║\n", trace_stalls, trace_blocks);
+    printf("║  Live timestamp cost     : %12.1f ns/event                   ║\n", clock_ns);
+    printf("╚════════════════════════════════════════════════════════════════════╝\n");
+
+    return trace_write_errors != 0;
+}
+
+/* snapshot latency of the stats page: the real stats_publish() rewrites the
+   page STATS_BENCH_PUBLISHES times while a reader thread maps it through
+   cfs_stats.h and copies the global record and every task record, timing
+   each full snapshot. the writer makes each record self-checking (vruntime
+   = cpu * 1000 = wait * 1000) so torn copies would be counted. the reader
+   only times a snapshot of a page the writer has republished since its last
+   one and yields otherwise, so the two share a single cpu */
+static atomic_int stats_bench_stop;
+static atomic_int stats_bench_ready;          // 1 = reader mapped the page, -1 = it failed
+static long stats_bench_ns[STATS_BENCH_SAMPLES];
+static _Atomic long stats_bench_snapshots, stats_bench_retries, stats_bench_torn;
+
+static void *stats_bench_reader(void *arg) {
+    const cfs_stats_page_t *page = cfs_stats_open((const char *)arg);
+    if (!page) {
+        perror("cfs_stats_open");
+        atomic_store(&stats_bench_ready, -1);
+        return NULL;
+    }
+    atomic_store(&stats_bench_ready, 1);
+
+    uint64_t last = 0;
+    while (!atomic_load(&stats_bench_stop)) {
+        cfs_stats_global_t g;
+        cfs_stats_task_t t[CFS_STATS_MAX_TASKS];
+        uint64_t start = trace_clock_ns();
+        unsigned retries = CFS_STATS_READ(&page->global, &g);
+        if (g.slices == last) {
+            sched_yield();
+            continue;
+        }
+        last = g.slices;
+        for (int i = 0; i < g.num_tasks; i++) {
+            retries += CFS_STATS_READ(&page->tasks[i], &t[i]);
+        }
+        uint64_t end = trace_clock_ns();
+
+        if (g.slices != g.dispatches) stats_bench_torn++;
+        for (int i = 0; i < g.num_tasks; i++) {
+            if (t[i].vruntime_ns != (uint64_t)t[i].cpu_ms * 1000 ||
+                t[i].wait_ms != t[i].cpu_ms) stats_bench_torn++;
+        }
+        long n = atomic_load(&stats_bench_snapshots);
+        if (n < STATS_BENCH_SAMPLES) stats_bench_ns[n] = end - start;
+        stats_bench_snapshots++;
+        stats_bench_retries += retries;
+    }
+    cfs_stats_close(page);
+    return NULL;
+}
+
+static int cmp_long(const void *a, const void *b) {
+    long x = *(const long *)a, y = *(const long *)b;
+    return (x > y) - (x < y);
+}
+
+static void stats_bench_round(long r) {
+    scheduler.slices = scheduler.dispatches = r;
+    for (int i = 0; i < scheduler.num_processes; i++) {
+        process_t *proc = &scheduler.processes[i];
+        proc->run_time_ms = r + i;
+        proc->total_wait_time_ms = r + i;
+        proc->vruntime_ns = (r + i) * 1000UL;
+    }
+}
+
+int benchmark_stats(void) {
+    stats_bench_round(0);
+    stats_open(config.stats_name);
+    pthread_t reader;
+    int err = pthread_create(&reader, NULL, stats_bench_reader, (void *)config.stats_name);
+    if (err) {
+        fprintf(stderr, "pthread_create: %s\n", strerror(err));
+        stats_close();
+        return 1;
+    }
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (long r = 1; r <= STATS_BENCH_PUBLISHES; r++) {
+        stats_bench_round(r);
+        stats_publish(r);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double publish_ns = ((end.tv_sec - start.tv_sec) * 1e9 + (end.tv_nsec - start.tv_nsec)) / STATS_BENCH_PUBLISHES;
+
+    // keep publishing until the reader has taken a full sample or time is up
+    while (atomic_load(&stats_bench_ready) == 0) sched_yield();
+    long deadline = get_time_ms() + STATS_BENCH_SECONDS * 1000;
+    for (long r = STATS_BENCH_PUBLISHES + 1;
+         atomic_load(&stats_bench_ready) > 0 && stats_bench_snapshots < STATS_BENCH_SAMPLES; r++) {
+        stats_bench_round(r);
+        stats_publish(r);
+        sched_yield();
+        if ((r & 1023) == 0 && get_time_ms() > deadline) break;
+    }
+    atomic_store(&stats_bench_stop, 1);
+    pthread_join(reader, NULL);
+    stats_close();
+
+    long n = stats_bench_snapshots < STATS_BENCH_SAMPLES ? stats_bench_snapshots : STATS_BENCH_SAMPLES;
+    if (n == 0) {
+        fprintf(stderr, "stats benchmark: the reader took no snapshots\n");
+        return 1;
+    }
+    qsort(stats_bench_ns, n, sizeof(long), cmp_long);
+
+    printf("\n");
+    printf("╔════════════════════════════════════════════════════════════════════╗\n");
+    printf("║                     STATS PAGE SNAPSHOT COST                       ║\n");
+    printf("╠════════════════════════════════════════════════════════════════════╣\n");
+    printf("║  Tasks per snapshot      : %12d                            ║\n", scheduler.num_processes);
+    printf("║  Writer publish          : %12.1f ns/page                    ║\n", publish_ns);
+    printf("║  Reader snapshots        : %12ld                            ║\n", stats_bench_snapshots);
+    printf("║  Snapshot p50            : %12ld ns                         ║\n", stats_bench_ns[n / 2]);
+    printf("║  Snapshot p99            : %12ld ns                         ║\n", stats_bench_ns[n * 99 / 100]);
+    printf("║  Snapshot max            : %12ld ns                         ║\n", stats_bench_ns[n - 1]);
+    printf("║  Retries per snapshot    : %12.4f                            ║\n",
+           (double)stats_bench_retries / stats_bench_snapshots);
+    printf("║  Torn records            : %12ld                            ║\n", stats_bench_torn);
     printf("╚════════════════════════════════════════════════════════════════════╝\n");
+
+    return stats_bench_torn != 0;
 }
 
-int main(void) {
+void print_usage(const char *prog) {
+    fprintf(stderr,
+            "usage: %s [-f workload] [-n] [-s] [-u statefile] [-H seconds] [-P policy] [-L] [-B] [-A] [-S list] [-M]\n"
+            "       [-W ms] [-X] [-I] [-R] [-D] [-m mib] [-O ms] [-T file] [-E n] [-K name]\n"
+            "       [-Y file] [-y ms] [-o dir]\n"
+            "  -f FILE  load tasks from a workload file, text or binary (default: built-in test set)\n"
+            "  -n       dependency-oblivious picks (no critical-path bias)\n"
+            "  -s       disable slo weight control\n"
+            "  -u FILE  keep fair-share history in FILE across runs (default none)\n"
+            "  -H SECS  fair-share usage half-life (default %.0f)\n"
+            "  -P NAME  placement of new/waking tasks: legacy, debit (default), lag\n"
+            "  -L       score candidates with the learned model (cfs_model.h)\n"
+            "  -B       benchmark per-candidate scoring cost against the budget and exit;\n"
+            "           with -T also trace write throughput, with -K stats page snapshot cost\n"
+            "  -A       adapt each task's quantum online (bandit) instead of a fixed %d ms\n"
+            "  -S LIST  evaluate shadow policies off the dispatch thread:\n"
+            "           comma list of heuristic, cfs, srtf, fifo, rr, or all\n"
+            "  -M       switch between heuristic, srtf and rr by observed workload regime\n"
+            "  -W MS    hard bound on how long a runnable task waits (watchdog-enforced)\n"
+            "  -X       extend the slice of a worker inside a critical section (lock=)\n"
+            "  -I       tie each task's i/o priority to its effective weight\n"
+            "  -R       shrink the set of running memory-heavy tasks under memory pressure (psi)\n"
+            "  -D       pick and admit by dominant share (cpu, memory) across groups\n"
+            "  -m MIB   memory capacity for dominant shares (default: physical memory)\n"
+            "  -O MS    queue or reject submissions while the predicted p99 wait exceeds MS\n"
+            "  -T FILE  write a compact binary event trace (cfs_trace.h)\n"
+            "  -E N     add the score breakdown of one heuristic pick in N to the trace\n"
+            "  -K NAME  publish live counters in shared memory /dev/shm/NAME (cfs_stats.h)\n"
+            "  -Y FILE  keep per-task snapshots in a fixed-size ring file (cfs_ring.h)\n"
+            "  -y MS    snapshot interval for -Y (default %d)\n"
+            "  -o DIR   write tasks, gantt intervals and decisions as arrow ipc files (cfs_arrow.h)\n",
+            prog, FAIRSHARE_HALF_LIFE_S, TIME_QUANTUM_MS, RING_INTERVAL_MS);
+}
+
+int main(int argc, char **argv) {
+    int opt, bench = 0;
+    while ((opt = getopt(argc, argv, "f:nsu:H:P:LBAS:MW:XIRDm:O:T:E:K:Y:y:o:h")) != -1) {
+        switch (opt) {
+        case 'f': config.workload_path = optarg; break;
+        case 'n': config.critical_path = 0; break;
+        case 's': config.slo_control = 0; break;
+        case 'u': config.fairshare_path = strcmp(optarg, "-") ? optarg : NULL; break;
+        case 'H':
+            config.fairshare_half_life_s = atof(optarg);
+            if (config.fairshare_half_life_s <= 0.0) {
+                fprintf(stderr, "half-life must be positive\n");
+                return 1;
+            }
+            break;
+        case 'P':
+            if (strcmp(optarg, "legacy") == 0) config.placement = PLACE_LEGACY;
+            else if (strcmp(optarg, "debit") == 0) config.placement = PLACE_DEBIT;
+            else if (strcmp(optarg, "lag") == 0) config.placement = PLACE_LAG;
+            else {
+                fprintf(stderr, "unknown placement policy '%s'\n", optarg);
+                return 1;
+            }
+            break;
+        case 'L': config.learned_model = 1; break;
+        case 'B': bench = 1; break;
+        case 'A': config.adaptive_quantum = 1; break;
+        case 'M': config.meta_policy = 1; break;
+        case 'X': config.slice_ext = 1; break;
+        case 'I': config.io_priority = 1; break;
+        case 'R': config.mem_control = 1; break;
+        case 'D': config.drf = 1; break;
+        case 'T': config.trace_path = optarg; break;
+        case 'K': config.stats_name = optarg; break;
+        case 'Y': config.ring_path = optarg; break;
+        case 'o': config.results_dir = optarg; break;
+        case 'y':
+            config.ring_interval_ms = atoi(optarg);
+            if (config.ring_interval_ms <= 0) {
+                fprintf(stderr, "snapshot interval must be positive\n");
+                return 1;
+            }
+            break;
+        case 'E':
+            config.explain_every = atoi(optarg);
+            if (config.explain_every <= 0) {
+                fprintf(stderr, "explain rate must be positive\n");
+                return 1;
+            }
+            break;
+        case 'O':
+            config.admit_target_ms = atoi(optarg);
+            if (config.admit_target_ms <= 0) {
+                fprintf(stderr, "wait target must be positive\n");
+                return 1;
+            }
+            break;
+        case 'm':
+            config.mem_capacity_mb = atoi(optarg);
+            if (config.mem_capacity_mb <= 0) {
+                fprintf(stderr, "memory capacity must be positive\n");
+                return 1;
+            }
+            break;
+        case 'W':
+            config.max_wait_ms = atoi(optarg);
+            if (config.max_wait_ms <= 0) {
+                fprintf(stderr, "max wait must be positive\n");
+                return 1;
+            }
+            break;
+        case 'S':
+            for (char *name = strtok(optarg, ","); name; name = strtok(NULL, ",")) {
+                int found = 0;
+                for (int p = 0; p < NUM_POLICIES; p++) {
+                    if (strcmp(name, "all") == 0 || strcmp(name, policies[p].name) == 0) {
+                        config.shadow_mask |= 1u << p;
+                        found = 1;
+                    }
+                }
+                if (!found) {
+                    fprintf(stderr, "unknown shadow policy '%s'\n", name);
+                    return 1;
+                }
+            }
+            break;
+        default:
+            print_usage(argv[0]);
+            return opt == 'h' ? 0 : 1;
+        }
+    }
+    if (config.explain_every && !config.trace_path) {
+        fprintf(stderr, "-E needs a trace file (-T)\n");
+        return 1;
+    }
+
     printf("╔════════════════════════════════════════════════════════════════════╗\n");
     printf("║     CFS-INSPIRED USER-SPACE SCHEDULER WITH HEURISTIC AI LAYER     ║\n");
     printf("║                                                                    ║\n");
@@ -438,48 +4788,40 @@ int main(void) {
     printf("╚════════════════════════════════════════════════════════════════════╝\n");
 
     initialize_scheduler();
+    if (config.mem_capacity_mb == 0) {
+        config.mem_capacity_mb = (int)((long long)sysconf(_SC_PHYS_PAGES) * sysconf(_SC_PAGESIZE) >> 20);
+    }
 
-    // test workload
-    struct {
-        int arrival_ms;
-        int burst_ms;
-        int nice;
-    } workload[] = {
-        {0,   60,  0},    // P0: CPU-bound, normal priority
-        {10,  20, -5},    // P1: short, higher priority
-        {15,  80,  5},    // P2: long, lower priority
-        {20,  30,  0},    // P3: medium, normal
-        {30,  15, -10},   // P4: very short, highest priority
-        {35,  50,  0},    // P5: medium, normal
-    };
+    if (config.fairshare_path) {
+        load_fairshare_state(config.fairshare_path);
+    }
 
-    int num_tasks = sizeof(workload) / sizeof(workload[0]);
-    scheduler.num_processes = num_tasks;
+    if (config.workload_path) {
+        load_workload_file(config.workload_path);
+    } else {
+        load_default_workload();
+    }
+    compute_upward_ranks();
+    map_shared_page();
 
-    for (int i = 0; i < num_tasks; i++) {
-        process_t *proc = &scheduler.processes[i];
+    if (bench) {
+        int over = benchmark_scoring();
+        if (config.trace_path && benchmark_trace()) return 1;
+        if (config.stats_name && benchmark_stats()) return 1;
+        return over;
+    }
 
-        proc->task_id = i;
-        proc->arrival_time_ms = workload[i].arrival_ms;
-        proc->burst_time_ms = workload[i].burst_ms;
-        proc->remaining_time_ms = workload[i].burst_ms;
-        proc->nice_value = workload[i].nice;
-        proc->weight = nice_to_weight(workload[i].nice);
-        proc->vruntime_ns = scheduler.min_vruntime_ns;
-        proc->state = PROC_READY;
-        proc->first_run = 0;
-        proc->estimated_burst_ms = 0;
-        proc->aging_boost = 0;
-        proc->interactivity_score = 100;
-        proc->last_schedule_time_ms = scheduler.scheduler_start_time_ms;
+    for (int i = 0; i < scheduler.num_processes; i++) {
+        process_t *proc = &scheduler.processes[i];
 
+        fflush(stdout);    // children must not inherit unflushed output
         pid_t pid = fork();
 
         if (pid < 0) {
             perror("fork failed");
             exit(1);
         } else if (pid == 0) {
-            child_worker(i, workload[i].burst_ms);
+            child_worker(proc);
             exit(0);
         } else {
             proc->pid = pid;
@@ -489,7 +4831,18 @@ int main(void) {
     }
 
     print_process_table();
+    shadow_start();
+    watchdog_start();
+    memory_start();
+    if (config.trace_path) trace_open(config.trace_path, 1);
+    if (config.stats_name) stats_open(config.stats_name);
+    if (config.ring_path) ring_open(config.ring_path);
     schedule_processes();
+    shadow_stop(get_time_ms());
+    trace_close();
+    stats_close();
+    ring_close();
+    if (config.results_dir) results_export(config.results_dir);
 
     // wait for all children
     for (int i = 0; i < scheduler.num_processes; i++) {
@@ -499,6 +4852,22 @@ int main(void) {
 
     print_scheduling_trace();
     print_final_statistics();
+    print_slo_report();
+    print_fairshare_report();
+    print_quantum_report();
+    print_shadow_report();
+    print_regime_report();
+    print_wait_report();
+    print_lock_report();
+    print_disk_report();
+    print_memory_report();
+    print_drf_report();
+    print_admission_report();
+    print_trace_report();
+
+    if (config.fairshare_path) {
+        save_fairshare_state(config.fairshare_path);
+    }
 
     printf("\n");
     printf("╔════════════════════════════════════════════════════════════════════╗\n");
@@ -0,0 +1,218 @@
+# calibration of the simulator against the live C scheduler
+# runs one workload through ./cfs_scheduler (-o) and through HeuristicCFSScheduler,
+# aligns the two decision sequences, reports how far the metrics diverge, then
+# fits the simulator's overhead model (switch cost and timer slack as empirical
+# distributions, plus the startup delay) from the live runs and reports the
+# divergence again. the calibrated simulator also runs whole slices, as the
+# live dispatcher does
+#
+# usage: python calibrate.py [-r runs] [-n seeds] [-b scheduler] [-j report.json] workload
+#
+# the simulator models cpu time only: lock=, disk= and mem= keys run for real
+# in the live scheduler but are ignored by the simulator, so expect divergence
+# on workloads that use them
+
+import argparse
+import difflib
+import json
+import os
+import subprocess
+import sys
+import tempfile
+from collections import Counter
+from dataclasses import dataclass
+from typing import Dict, List
+
+import numpy as np
+
+from scheduler_simulation import HeuristicCFSScheduler, load_workload, read_arrow_table
+
+# mirror TIME_QUANTUM_MS and MIN_GRANULARITY_MS of the C scheduler, one tick = 1 ms
+TIME_QUANTUM_MS = 10
+MIN_GRANULARITY_MS = 5
+
+METRICS = ('makespan', 'throughput', 'avg_response', 'avg_wait', 'avg_turnaround',
+           'p99_dispatch_wait', 'switches')
+
+
+@dataclass
+class Trace:
+    """one run, live or simulated, in the columns both sides share (ms)"""
+    time: np.ndarray              # slice start
+    task: np.ndarray
+    slice: np.ndarray             # slice granted
+    ran: np.ndarray               # time the slice actually took
+    wait: np.ndarray              # dispatch wait at the pick, -1 = not a switch-in
+    response: np.ndarray          # per task
+    turnaround: np.ndarray
+    task_wait: np.ndarray
+    total_time: int
+
+
+def live_trace(directory: str) -> Trace:
+    decisions = read_arrow_table(os.path.join(directory, 'decisions.arrow')).to_pydict()
+    tasks = read_arrow_table(os.path.join(directory, 'tasks.arrow'))
+    meta = {k.decode(): v.decode() for k, v in (tasks.schema.metadata or {}).items()}
+    tasks = tasks.to_pydict()
+    return Trace(np.array(decisions['time']), np.array(decisions['task']), np.array(decisions['slice']),
+                 np.array(decisions['ran']), np.array(decisions['dispatch_wait']),
+                 np.array(tasks['response']), np.array(tasks['turnaround']), np.array(tasks['wait']),
+                 int(meta['total_time']))
+
+
+def sim_trace(result) -> Trace:
+    d = result.decisions
+    procs = sorted(result.processes, key=lambda p: p.pid)
+    task = np.array([e.pid for e in d])
+    # like the C scheduler, only a switch-in records a dispatch wait
+    switch_in = np.r_[True, task[1:] != task[:-1]] if len(task) else np.zeros(0, bool)
+    return Trace(np.array([e.time for e in d]), task, np.array([e.slice for e in d]),
+                 np.array([e.ran for e in d]), np.where(switch_in, [e.dispatch_wait for e in d], -1),
+                 np.array([p.response_time for p in procs]), np.array([p.turnaround_time for p in procs]),
+                 np.array([p.waiting_time for p in procs]), result.total_time)
+
+
+def run_live(binary: str, workload: str, runs: int) -> List[Trace]:
+    traces = []
+    with tempfile.TemporaryDirectory() as tmp:
+        for run in range(runs):
+            out = os.path.join(tmp, f'run{run}')
+            subprocess.run([binary, '-f', workload, '-o', out], check=True,
+                           stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
+            traces.append(live_trace(out))
+    return traces
+
+
+def simulate(processes, seeds: int, **overheads) -> List[Trace]:
+    return [sim_trace(HeuristicCFSScheduler(time_quantum=TIME_QUANTUM_MS, min_granularity=MIN_GRANULARITY_MS,
+                                            seed=seed, **overheads).schedule(processes))
+            for seed in range(seeds)]
+
+
+def metrics(t: Trace) -> Dict[str, float]:
+    waits = t.wait[t.wait >= 0]
+    n = len(t.response)
+    return {
+        'makespan': t.total_time,
+        'throughput': n / t.total_time * 1000 if t.total_time > 0 else 0.0,    # tasks/s
+        'avg_response': float(t.response.mean()),
+        'avg_wait': float(t.task_wait.mean()),
+        'avg_turnaround': float(t.turnaround.mean()),
+        'p99_dispatch_wait': float(np.percentile(waits, 99)) if len(waits) else 0.0,
+        'switches': int((t.wait >= 0).sum()),
+    }
+
+
+def mean_metrics(traces: List[Trace]) -> Dict[str, float]:
+    per_run = [metrics(t) for t in traces]
+    return {k: float(np.mean([m[k] for m in per_run])) for k in METRICS}
+
+
+def align(a: Trace, b: Trace) -> Dict[str, float]:
+    """matches the switch-in sequences (which task got the cpu next) of two
+    runs: similarity, the first switch-in where they part, and how far apart
+    in time the matched switch-ins happen"""
+    ia, ib = np.flatnonzero(a.wait >= 0), np.flatnonzero(b.wait >= 0)
+    sa, sb = a.task[ia].tolist(), b.task[ib].tolist()
+    matcher = difflib.SequenceMatcher(None, sa, sb, autojunk=False)
+    blocks = [m for m in matcher.get_matching_blocks() if m.size]
+    first = blocks[0].size if blocks and blocks[0].a == 0 and blocks[0].b == 0 else 0
+    drift = [abs(int(a.time[ia[m.a + k]]) - int(b.time[ib[m.b + k]])) for m in blocks for k in range(m.size)]
+    return {
+        'similarity': matcher.ratio(),
+        'first_divergence': first if first < min(len(sa), len(sb)) else -1,
+        'first_divergence_ms': int(a.time[ia[first]]) if first < min(len(sa), len(sb)) else -1,
+        'mean_drift_ms': float(np.mean(drift)) if drift else 0.0,
+    }
+
+
+def fit(traces: List[Trace], first_arrival: int) -> Dict[str, List[int]]:
+    """samples of the overhead model from live runs. switch cost: the gap
+    between a slice and the next when the cpu changes to a task that was
+    already waiting (otherwise the gap is idle time). timer slack: how far a
+    slice ran past what it was granted. startup: how long after the first
+    arrival the first slice started"""
+    switch_cost, timer_slack, startup = [], [], []
+    for t in traces:
+        gap = t.time[1:] - (t.time[:-1] + t.ran[:-1])
+        waited = (t.task[1:] != t.task[:-1]) & (t.wait[1:] >= gap) & (gap >= 0)
+        switch_cost += gap[waited].tolist()
+        timer_slack += np.maximum(0, t.ran - t.slice).tolist()
+        startup.append(max(0, int(t.time[0]) - first_arrival))
+    return {'switch_cost': switch_cost, 'timer_slack': timer_slack, 'startup': startup}
+
+
+def overheads(samples: Dict[str, List[int]]) -> dict:
+    """HeuristicCFSScheduler keyword arguments for the fitted model"""
+    return {'switch_cost': samples['switch_cost'], 'timer_slack': samples['timer_slack'],
+            'startup': int(round(np.mean(samples['startup']))), 'full_slices': True}
+
+
+def histogram(samples: List[int]) -> Dict[str, int]:
+    return {str(v): c for v, c in sorted(Counter(samples).items())}
+
+
+def overheads_from_report(path: str) -> dict:
+    """HeuristicCFSScheduler keyword arguments from a calibrate.py -j report"""
+    with open(path) as f:
+        fitted = json.load(f)['fit']
+    return overheads({name: [int(v) for v, c in hist.items() for _ in range(c)] for name, hist in fitted.items()})
+
+
+def error(predicted: float, live: float) -> str:
+    return f"{(predicted - live) / live * 100:+.1f}%" if live else "-"
+
+
+def main():
+    parser = argparse.ArgumentParser(description="calibrate the simulator against the live scheduler")
+    parser.add_argument('workload')
+    parser.add_argument('-r', '--runs', type=int, default=3, help="live runs (default 3)")
+    parser.add_argument('-n', '--seeds', type=int, default=20, help="simulator runs per model (default 20)")
+    parser.add_argument('-b', '--binary', default='./cfs_scheduler', help="live scheduler (default ./cfs_scheduler)")
+    parser.add_argument('-j', '--json', help="write the report and the fitted model as JSON")
+    args = parser.parse_args()
+
+    print(f"Running {args.workload} live {args.runs} times...")
+    live = run_live(args.binary, args.workload, args.runs)
+    processes = load_workload(args.workload)
+    ideal = simulate(processes, 1)
+    samples = fit(live, min(p.arrival_time for p in processes))
+    calibrated = simulate(processes, args.seeds, **overheads(samples))
+
+    models = {'live': mean_metrics(live), 'ideal': mean_metrics(ideal), 'calibrated': mean_metrics(calibrated)}
+    alignment = {'ideal': align(live[0], ideal[0]), 'calibrated': align(live[0], calibrated[0])}
+    if len(live) > 1:
+        alignment['live'] = align(live[0], live[1])       # run-to-run noise floor
+
+    print("\n" + "="*70)
+    print("              SIMULATOR CALIBRATION: " + os.path.basename(args.workload))
+    print("="*70)
+    for name, s in samples.items():
+        if s:
+            print(f"  {name:<12} n={len(s):<5} mean {np.mean(s):.2f} ms, p50 {np.percentile(s, 50):.0f}, "
+                  f"p99 {np.percentile(s, 99):.0f}, max {max(s)}")
+        else:
+            print(f"  {name:<12} no samples")
+    print("-"*70)
+    print(f"{'Metric':<20} {'Live':>10} {'Ideal':>10} {'Error':>8} {'Calibrated':>11} {'Error':>8}")
+    for k in METRICS:
+        lv, iv, cv = models['live'][k], models['ideal'][k], models['calibrated'][k]
+        print(f"{k:<20} {lv:>10.2f} {iv:>10.2f} {error(iv, lv):>8} {cv:>11.2f} {error(cv, lv):>8}")
+    print("-"*70)
+    print(f"{'Decision alignment':<20} {'Similarity':>10} {'Parts at':>16} {'Drift':>10}")
+    for name, a in alignment.items():
+        parts = f"#{a['first_divergence']} ({a['first_divergence_ms']} ms)" if a['first_divergence'] >= 0 else "never"
+        label = 'live vs live' if name == 'live' else f'live vs {name}'
+        print(f"{label:<20} {a['similarity']:>10.2f} {parts:>16} {a['mean_drift_ms']:>8.1f}ms")
+    print("="*70)
+
+    if args.json:
+        with open(args.json, 'w') as f:
+            json.dump({'workload': args.workload, 'runs': args.runs, 'seeds': args.seeds,
+                       'fit': {name: histogram(s) for name, s in samples.items()},
+                       'metrics': models, 'alignment': alignment}, f, indent=2)
+        print(f"\nWrote {args.json}")
+
+
+if __name__ == "__main__":
+    sys.exit(main())
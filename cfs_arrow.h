@@ -0,0 +1,374 @@
+// arrow ipc file writer shared by the scheduler (-o) and trace_analyzer (-a):
+// non-null columns of fixed-width numbers and utf-8 strings, written in
+// record batches. pyarrow and every other arrow reader open the files as
+// they are, memory-mapped and without a conversion step.
+//
+// file    = "ARROW1\0\0", the schema message, one message per record batch,
+//           then a footer indexing the batches, its length and "ARROW1"
+// message = 0xffffffff, metadata length, flatbuffer metadata padded to 8,
+//           then the body: the buffers of the batch, each padded to 8
+// column  = a zero-length validity buffer (no nulls), then the values; a
+//           utf8 column has rows + 1 int32 offsets, then the bytes
+//
+// the flatbuffers are built front to back: a table's vtable sits right
+// before it and everything a table points to is written after it, so every
+// offset points forward and no flatbuffers library is needed
+//
+// usage: arrow_open(&w, path, fields, n, meta, nmeta), arrow_write_batch(&w,
+//        columns, rows) any number of times, arrow_close(&w). fields and
+//        meta must stay valid until arrow_close, the footer repeats them
+
+#ifndef CFS_ARROW_H
+#define CFS_ARROW_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+
+#define ARROW_MAGIC "ARROW1"
+#define ARROW_METADATA_V5 4
+#define ARROW_MAX_COLUMNS 32
+#define ARROW_FB_MAX_FIELDS 8         // fields of the largest metadata table written
+
+typedef enum {
+    ARROW_INT32,
+    ARROW_INT64,
+    ARROW_FLOAT64,
+    ARROW_UTF8
+} arrow_type_t;
+
+typedef struct {
+    const char *name;
+    arrow_type_t type;
+} arrow_field_t;
+
+// schema custom_metadata, e.g. units and the names behind coded columns
+typedef struct {
+    const char *key;
+    const char *value;
+} arrow_meta_t;
+
+// one column of a batch: rows values, or for utf8 rows + 1 offsets into values
+typedef struct {
+    const void *values;
+    const int32_t *offsets;
+} arrow_column_t;
+
+// footer Block struct, layout as in the format
+typedef struct {
+    int64_t offset;
+    int32_t meta_len;
+    int32_t pad;
+    int64_t body_len;
+} arrow_block_t;
+
+typedef struct {
+    uint8_t *buf;
+    size_t len, cap;
+} arrow_fb_t;
+
+typedef struct {
+    FILE *file;
+    const arrow_field_t *fields;
+    int num_fields;
+    const arrow_meta_t *meta;
+    int num_meta;
+    int64_t offset;               // bytes written
+    arrow_block_t *blocks;
+    int num_blocks, cap_blocks;
+    arrow_fb_t fb;
+    int error;
+} arrow_writer_t;
+
+_Static_assert(sizeof(arrow_block_t) == 24, "footer blocks are 24 bytes");
+
+/* ---- flatbuffer builder ---- */
+
+// size bytes at the next multiple of align, zero-filled; returns their position
+static inline size_t arrow_fb_alloc(arrow_fb_t *b, size_t size, size_t align) {
+    size_t pos = (b->len + align - 1) & ~(align - 1);
+    if (pos + size > b->cap) {
+        size_t cap = b->cap ? b->cap : 1024;
+        while (cap < pos + size) cap *= 2;
+        uint8_t *buf = realloc(b->buf, cap);
+        if (!buf) {
+            perror("arrow metadata");
+            exit(1);
+        }
+        b->buf = buf;
+        b->cap = cap;
+    }
+    memset(b->buf + b->len, 0, pos + size - b->len);
+    b->len = pos + size;
+    return pos;
+}
+
+static inline void arrow_fb_set(arrow_fb_t *b, size_t pos, const void *v, size_t n) {
+    memcpy(b->buf + pos, v, n);
+}
+
+// the offset field at pos points forward to target
+static inline void arrow_fb_link(arrow_fb_t *b, size_t pos, size_t target) {
+    uint32_t off = (uint32_t)(target - pos);
+    memcpy(b->buf + pos, &off, 4);
+}
+
+// vtable, then a table of n fields of the given sizes (0 = absent) at their
+// natural alignment; pos[i] receives the position of field i
+static inline size_t arrow_fb_table(arrow_fb_t *b, int n, const uint8_t *sizes, size_t *pos) {
+    uint16_t vt[2 + ARROW_FB_MAX_FIELDS];
+    uint16_t size = 4;
+    for (int i = 0; i < n; i++) {
+        vt[2 + i] = 0;
+        if (!sizes[i]) continue;
+        size = (uint16_t)((size + sizes[i] - 1) / sizes[i] * sizes[i]);
+        vt[2 + i] = size;
+        size += sizes[i];
+    }
+    vt[0] = (uint16_t)(4 + 2 * n);
+    vt[1] = size;
+    size_t v = arrow_fb_alloc(b, vt[0], 2);
+    arrow_fb_set(b, v, vt, vt[0]);
+    size_t t = arrow_fb_alloc(b, size, 8);
+    int32_t back = (int32_t)(t - v);
+    arrow_fb_set(b, t, &back, 4);
+    for (int i = 0; i < n; i++) pos[i] = t + vt[2 + i];
+    return t;
+}
+
+// length-prefixed vector of count elements; returns the position of the
+// length, the elements follow it aligned to align (at least 4)
+static inline size_t arrow_fb_vector(arrow_fb_t *b, uint32_t count, size_t elem, size_t align) {
+    size_t first = (b->len + 4 + align - 1) / align * align;
+    arrow_fb_alloc(b, first + count * elem - b->len, 1);
+    arrow_fb_set(b, first - 4, &count, 4);
+    return first - 4;
+}
+
+static inline size_t arrow_fb_string(arrow_fb_t *b, const char *s) {
+    size_t n = strlen(s);
+    size_t v = arrow_fb_vector(b, (uint32_t)n, 1, 4);
+    arrow_fb_alloc(b, 1, 1);              // nul terminator
+    arrow_fb_set(b, v + 4, s, n);
+    return v;
+}
+
+// Field: name, nullable, type_type, type, dictionary, children
+static inline size_t arrow_fb_field(arrow_fb_t *b, const arrow_field_t *f) {
+    static const uint8_t sizes[6] = { 4, 1, 1, 4, 0, 4 };
+    static const uint8_t type_ids[] = { 2, 2, 3, 5 };    // Int, Int, FloatingPoint, Utf8
+    size_t pos[6], tp[2];
+    size_t t = arrow_fb_table(b, 6, sizes, pos);
+    arrow_fb_set(b, pos[2], &type_ids[f->type], 1);
+    arrow_fb_link(b, pos[0], arrow_fb_string(b, f->name));
+
+    size_t type;
+    if (f->type == ARROW_INT32 || f->type == ARROW_INT64) {
+        static const uint8_t int_sizes[2] = { 4, 1 };    // bitWidth, is_signed
+        int32_t bits = f->type == ARROW_INT32 ? 32 : 64;
+        uint8_t is_signed = 1;
+        type = arrow_fb_table(b, 2, int_sizes, tp);
+        arrow_fb_set(b, tp[0], &bits, 4);
+        arrow_fb_set(b, tp[1], &is_signed, 1);
+    } else if (f->type == ARROW_FLOAT64) {
+        static const uint8_t float_sizes[1] = { 2 };     // precision
+        int16_t precision = 2;                           // DOUBLE
+        type = arrow_fb_table(b, 1, float_sizes, tp);
+        arrow_fb_set(b, tp[0], &precision, 2);
+    } else {
+        type = arrow_fb_table(b, 0, NULL, tp);
+    }
+    arrow_fb_link(b, pos[3], type);
+    // readers expect the children vector even when it is empty
+    arrow_fb_link(b, pos[5], arrow_fb_vector(b, 0, 4, 4));
+    return t;
+}
+
+// Schema: endianness (little = 0), fields, custom_metadata
+static inline size_t arrow_fb_schema(arrow_fb_t *b, const arrow_writer_t *w) {
+    const uint8_t sizes[3] = { 2, 4, w->num_meta ? 4 : 0 };
+    size_t pos[3], kv[2];
+    size_t t = arrow_fb_table(b, 3, sizes, pos);
+
+    size_t v = arrow_fb_vector(b, (uint32_t)w->num_fields, 4, 4);
+    arrow_fb_link(b, pos[1], v);
+    for (int i = 0; i < w->num_fields; i++) {
+        arrow_fb_link(b, v + 4 + 4 * i, arrow_fb_field(b, &w->fields[i]));
+    }
+    if (w->num_meta) {
+        static const uint8_t kv_sizes[2] = { 4, 4 };     // KeyValue: key, value
+        v = arrow_fb_vector(b, (uint32_t)w->num_meta, 4, 4);
+        arrow_fb_link(b, pos[2], v);
+        for (int i = 0; i < w->num_meta; i++) {
+            arrow_fb_link(b, v + 4 + 4 * i, arrow_fb_table(b, 2, kv_sizes, kv));
+            arrow_fb_link(b, kv[0], arrow_fb_string(b, w->meta[i].key));
+            arrow_fb_link(b, kv[1], arrow_fb_string(b, w->meta[i].value));
+        }
+    }
+    return t;
+}
+
+// root Message: version, header_type, header, bodyLength; returns the
+// position of the header field for the caller to link
+static inline size_t arrow_fb_message(arrow_fb_t *b, uint8_t header_type, int64_t body_len) {
+    static const uint8_t sizes[4] = { 2, 1, 4, 8 };
+    size_t pos[4];
+    int16_t version = ARROW_METADATA_V5;
+    b->len = 0;
+    arrow_fb_alloc(b, 4, 4);
+    arrow_fb_link(b, 0, arrow_fb_table(b, 4, sizes, pos));
+    arrow_fb_set(b, pos[0], &version, 2);
+    arrow_fb_set(b, pos[1], &header_type, 1);
+    arrow_fb_set(b, pos[3], &body_len, 8);
+    return pos[2];
+}
+
+/* ---- file writer ---- */
+
+static inline void arrow_put(arrow_writer_t *w, const void *p, size_t n) {
+    if (n && fwrite(p, 1, n, w->file) != n) w->error = 1;
+    w->offset += n;
+}
+
+static inline void arrow_pad(arrow_writer_t *w) {
+    static const uint8_t zeros[8];
+    arrow_put(w, zeros, (size_t)(-w->offset & 7));
+}
+
+// encapsulated message around the metadata in w->fb; returns its length
+static inline int32_t arrow_put_message(arrow_writer_t *w) {
+    uint32_t continuation = 0xffffffffu;
+    int32_t len = (int32_t)((w->fb.len + 7) & ~(size_t)7);
+    arrow_put(w, &continuation, 4);
+    arrow_put(w, &len, 4);
+    arrow_put(w, w->fb.buf, w->fb.len);
+    arrow_pad(w);
+    return len + 8;
+}
+
+// 0 on success, -1 with errno set
+static inline int arrow_open(arrow_writer_t *w, const char *path, const arrow_field_t *fields,
+                             int num_fields, const arrow_meta_t *meta, int num_meta) {
+    memset(w, 0, sizeof(*w));
+    if (num_fields <= 0 || num_fields > ARROW_MAX_COLUMNS) {
+        errno = EINVAL;
+        return -1;
+    }
+    w->file = fopen(path, "wb");
+    if (!w->file) return -1;
+    w->fields = fields;
+    w->num_fields = num_fields;
+    w->meta = meta;
+    w->num_meta = num_meta;
+
+    static const char magic[8] = ARROW_MAGIC;
+    arrow_put(w, magic, sizeof(magic));
+    size_t header = arrow_fb_message(&w->fb, 1, 0);      // Schema
+    arrow_fb_link(&w->fb, header, arrow_fb_schema(&w->fb, w));
+    arrow_put_message(w);
+    return 0;
+}
+
+// one record batch of rows rows, a column per field in schema order
+static inline void arrow_write_batch(arrow_writer_t *w, const arrow_column_t *cols, int64_t rows) {
+    struct {
+        const void *data;
+        int64_t len;
+    } bufs[3 * ARROW_MAX_COLUMNS];
+    int nbufs = 0;
+    int64_t body = 0;
+    for (int i = 0; i < w->num_fields; i++) {
+        bufs[nbufs].data = NULL;
+        bufs[nbufs++].len = 0;
+        switch (w->fields[i].type) {
+        case ARROW_INT32:
+            bufs[nbufs].data = cols[i].values;
+            bufs[nbufs++].len = rows * 4;
+            break;
+        case ARROW_INT64:
+        case ARROW_FLOAT64:
+            bufs[nbufs].data = cols[i].values;
+            bufs[nbufs++].len = rows * 8;
+            break;
+        case ARROW_UTF8:
+            bufs[nbufs].data = cols[i].offsets;
+            bufs[nbufs++].len = (rows + 1) * 4;
+            bufs[nbufs].data = cols[i].values;
+            bufs[nbufs++].len = cols[i].offsets[rows];
+            break;
+        }
+    }
+
+    // RecordBatch: length, nodes, buffers
+    static const uint8_t sizes[3] = { 8, 4, 4 };
+    size_t pos[3];
+    for (int i = 0; i < nbufs; i++) body += (bufs[i].len + 7) & ~7;
+    size_t header = arrow_fb_message(&w->fb, 3, body);
+    arrow_fb_link(&w->fb, header, arrow_fb_table(&w->fb, 3, sizes, pos));
+    arrow_fb_set(&w->fb, pos[0], &rows, 8);
+
+    size_t v = arrow_fb_vector(&w->fb, (uint32_t)w->num_fields, 16, 8);
+    arrow_fb_link(&w->fb, pos[1], v);
+    for (int i = 0; i < w->num_fields; i++) {
+        int64_t node[2] = { rows, 0 };                    // FieldNode: length, null_count
+        arrow_fb_set(&w->fb, v + 4 + 16 * i, node, 16);
+    }
+    v = arrow_fb_vector(&w->fb, (uint32_t)nbufs, 16, 8);
+    arrow_fb_link(&w->fb, pos[2], v);
+    int64_t at = 0;
+    for (int i = 0; i < nbufs; i++) {
+        int64_t buffer[2] = { at, bufs[i].len };          // Buffer: offset, length
+        arrow_fb_set(&w->fb, v + 4 + 16 * i, buffer, 16);
+        at += (bufs[i].len + 7) & ~7;
+    }
+
+    if (w->num_blocks == w->cap_blocks) {
+        w->cap_blocks = w->cap_blocks ? w->cap_blocks * 2 : 64;
+        arrow_block_t *blocks = realloc(w->blocks, w->cap_blocks * sizeof(*blocks));
+        if (!blocks) {
+            perror("arrow blocks");
+            exit(1);
+        }
+        w->blocks = blocks;
+    }
+    arrow_block_t *block = &w->blocks[w->num_blocks++];
+    block->offset = w->offset;
+    block->meta_len = arrow_put_message(w);
+    block->pad = 0;
+    block->body_len = body;
+    for (int i = 0; i < nbufs; i++) {
+        arrow_put(w, bufs[i].data, bufs[i].len);
+        arrow_pad(w);
+    }
+}
+
+// writes the footer and closes; 0 on success, -1 when any write failed
+static inline int arrow_close(arrow_writer_t *w) {
+    // Footer: version, schema, dictionaries, recordBatches
+    static const uint8_t sizes[4] = { 2, 4, 4, 4 };
+    size_t pos[4];
+    int16_t version = ARROW_METADATA_V5;
+    arrow_fb_t *b = &w->fb;
+    b->len = 0;
+    arrow_fb_alloc(b, 4, 4);
+    arrow_fb_link(b, 0, arrow_fb_table(b, 4, sizes, pos));
+    arrow_fb_set(b, pos[0], &version, 2);
+    arrow_fb_link(b, pos[1], arrow_fb_schema(b, w));
+    arrow_fb_link(b, pos[2], arrow_fb_vector(b, 0, sizeof(arrow_block_t), 8));
+    size_t v = arrow_fb_vector(b, (uint32_t)w->num_blocks, sizeof(arrow_block_t), 8);
+    arrow_fb_link(b, pos[3], v);
+    if (w->num_blocks) arrow_fb_set(b, v + 4, w->blocks, w->num_blocks * sizeof(arrow_block_t));
+
+    int32_t len = (int32_t)b->len;
+    arrow_put(w, b->buf, b->len);
+    arrow_put(w, &len, 4);
+    arrow_put(w, ARROW_MAGIC, 6);
+    if (fclose(w->file) != 0) w->error = 1;
+    free(w->blocks);
+    free(b->buf);
+    return w->error ? -1 : 0;
+}
+
+#endif
@@ -0,0 +1,18 @@
+// generated by train_model.py - do not edit
+// linear scoring model: score = sum(model_weights[i] * feature[i]),
+// lowest score runs next. features are integers clamped to
+// [0, 4095]: vruntime_delta, wait, remaining, sleep_ratio, log2_weight
+// trained on 30725 decisions from 200 simulator runs,
+// held-out teacher agreement 50.7% (hand-written heuristic 21.3%)
+
+#ifndef CFS_MODEL_H
+#define CFS_MODEL_H
+
+#include <stdint.h>
+
+#define MODEL_FEATURES 5
+#define MODEL_FEATURE_MAX 4095
+
+static const int32_t model_weights[MODEL_FEATURES] = {0, -353, 691, -56, -1023};
+
+#endif
@@ -0,0 +1,83 @@
+// snapshot ring file written by the scheduler (-Y) and read by ringquery:
+// per-task history at a fixed interval in a fixed-size memory-mapped file.
+//
+// file   = ring_hdr_t (one 4 KiB page), then slots fixed-width records
+// record = one task at one snapshot, 32 bytes. record n (counted from 1
+//          since the file was created) lives in slot (n - 1) % slots, so
+//          the oldest records are overwritten once the ring is full
+// order  = seq and time_ms never decrease from the oldest record to the
+//          newest, so the newest record and any time can be found by
+//          binary search over the slots instead of a scan
+// crash  = the scheduler writes through the mapping, so every record is in
+//          the page cache as soon as it is written and survives a crash of
+//          the scheduler. a record cut short by a crash fails its check and
+//          is skipped. hdr.head is a hint only; readers trust the records
+//
+// headers and records are in host byte order; the magic rejects files from
+// a foreign-endian host
+
+#ifndef CFS_RING_H
+#define CFS_RING_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define RING_MAGIC "CFSRNG1"          // 8 bytes with the nul
+#define RING_VERSION 1
+#define RING_HDR_SIZE 4096
+#define RING_GROUPS 16
+#define RING_GROUP_NAME 32
+#define RING_TASKS 64
+
+// throttle bits: why a runnable task was kept off the cpu at the snapshot
+#define RING_THROTTLE_MEM 1           // parked under memory pressure (-R)
+#define RING_THROTTLE_ADMIT 2         // queued by admission control (-O)
+#define RING_THROTTLE_DRF 4           // memory does not fit (-D)
+
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t record_size;
+    uint64_t slots;
+    uint32_t interval_ms;
+    uint32_t num_groups;
+    uint64_t start_unix_ns;       // wall clock at time_ms 0
+    uint64_t head;                // records written, updated after each snapshot
+    char groups[RING_GROUPS][RING_GROUP_NAME];
+} ring_hdr_t;
+
+typedef struct {
+    uint64_t seq;                 // record number from 1, 0 = slot never written
+    uint32_t time_ms;             // since the scheduler started
+    uint16_t task;
+    uint8_t group;                // index into ring_hdr_t.groups
+    uint8_t state;                // cfs_task_state_t (cfs_stats.h)
+    uint16_t share_bp;            // cpu share over the last interval, basis points
+    uint16_t runnable;            // tasks on the run queue at the snapshot
+    uint32_t wait_ms;             // wait accrued over the last interval
+    uint32_t cpu_ms;              // cpu charged since the task arrived
+    uint8_t throttle;             // RING_THROTTLE_* bits
+    uint8_t reserved;
+    uint16_t check;               // ring_check() of the fields above
+} ring_rec_t;
+
+_Static_assert(sizeof(ring_hdr_t) <= RING_HDR_SIZE, "ring header does not fit its page");
+_Static_assert(sizeof(ring_rec_t) == 32, "ring records are 32 bytes");
+
+// fletcher-16 over the record without its check field; 30 bytes cannot
+// overflow the sums, so they are reduced once at the end
+static inline uint16_t ring_check(const ring_rec_t *r) {
+    const uint8_t *p = (const uint8_t *)r;
+    uint32_t a = 0, b = 0;
+    for (size_t i = 0; i < offsetof(ring_rec_t, check); i++) {
+        a += p[i];
+        b += a;
+    }
+    return (uint16_t)(b % 255 << 8 | a % 255);
+}
+
+static inline int ring_valid(const ring_rec_t *r, uint64_t slot, uint64_t slots) {
+    return r->seq != 0 && (r->seq - 1) % slots == slot && r->check == ring_check(r);
+}
+
+#endif
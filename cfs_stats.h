@@ -0,0 +1,195 @@
+// shared-memory stats page published by the scheduler (-K NAME) for
+// external monitors, and the reader side of it. after the mapping, reading
+// costs no system calls and never blocks the dispatcher.
+//
+// page   = cfs_stats_page_t in a posix shared memory object (/dev/shm/NAME),
+//          created by the scheduler and mapped read-only by readers
+// record = the global counters, the self-profile and one record per task
+//          slot, each on its own cache line behind its own sequence counter.
+//          the self-profile is only filled by a scheduler built with
+//          -DCFS_PROFILE, otherwise its enabled flag stays 0
+// seqlock= the single writer makes the counter odd, updates the record and
+//          makes it even again. a reader copies the record and keeps the
+//          copy only if the counter was even and unchanged around it, so a
+//          snapshot of a record is always consistent; records are not
+//          consistent with each other
+//
+// writers: cfs_stats_write_begin(&rec->seq), update rec->data,
+//          cfs_stats_write_end(&rec->seq)
+// readers: page = cfs_stats_open(name), CFS_STATS_READ(&page->tasks[i], &t),
+//          cfs_stats_close(page)
+
+#ifndef CFS_STATS_H
+#define CFS_STATS_H
+
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <stdatomic.h>
+#include <sched.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define CFS_STATS_MAGIC 0x53534643u   // "CFSS"
+#define CFS_STATS_VERSION 3
+#define CFS_STATS_MAX_TASKS 64
+#define CFS_STATS_PHASES 7            // phases of a scheduling decision (-DCFS_PROFILE)
+#define CFS_STATS_PHASE_BUCKETS 40    // log2(ns) histogram buckets per phase
+#define CFS_STATS_SPINS 64            // reader retries before yielding the cpu
+
+typedef enum {
+    CFS_TASK_EMPTY,               // slot not used by the workload
+    CFS_TASK_WAITING,             // not arrived yet or blocked on parents
+    CFS_TASK_READY,
+    CFS_TASK_RUNNING,
+    CFS_TASK_SLEEPING,            // emulated i/o
+    CFS_TASK_HELD,                // arrived but off the run queue (admission, memory)
+    CFS_TASK_DONE,
+    CFS_TASK_STATES
+} cfs_task_state_t;
+
+static const char *const cfs_task_state_names[CFS_TASK_STATES] = {
+    "-", "wait", "ready", "run", "sleep", "held", "done"
+};
+
+typedef struct {
+    int64_t elapsed_ms;           // since the scheduler started
+    uint64_t slices;              // slices run
+    uint64_t dispatches;          // switch-ins
+    uint64_t min_vruntime_ns;
+    int32_t num_tasks;
+    int32_t completed;
+    int32_t runnable;             // tasks on the run queue, the running one included
+    int32_t running_task;         // task id, -1 = idle
+    int32_t active_policy;
+    int32_t finished;             // the scheduler has exited the dispatch loop
+} cfs_stats_global_t;
+
+static const char *const cfs_stats_phase_names[CFS_STATS_PHASES] = {
+    "event wait", "metrics", "pick", "signal send", "confirm wait", "accounting", "tracing"
+};
+
+// per-phase time of each decision; bucket b counts decisions that spent
+// [2^b, 2^(b+1)) ns in the phase, the last bucket everything above
+typedef struct {
+    int32_t enabled;              // the scheduler was built with -DCFS_PROFILE
+    int32_t phases;               // CFS_STATS_PHASES
+    uint64_t decisions;
+    uint64_t samples[CFS_STATS_PHASES];     // decisions that spent time in the phase
+    uint64_t total_ns[CFS_STATS_PHASES];
+    uint64_t max_ns[CFS_STATS_PHASES];
+    uint32_t hist[CFS_STATS_PHASES][CFS_STATS_PHASE_BUCKETS];
+} cfs_stats_profile_t;
+
+typedef struct {
+    int32_t task_id;
+    int32_t state;                // cfs_task_state_t
+    uint64_t vruntime_ns;
+    int32_t weight;
+    int32_t aging_boost;
+    int64_t wait_ms;              // accumulated runnable time without the cpu
+    int64_t cpu_ms;               // cpu charged so far
+    int64_t remaining_ms;
+    int32_t wait_p50_ms;          // dispatch waits over the task's last 64 dispatches
+    int32_t wait_p99_ms;
+} cfs_stats_task_t;
+
+typedef struct {
+    _Alignas(64) _Atomic uint32_t seq;
+    cfs_stats_global_t data;
+} cfs_stats_global_rec_t;
+
+typedef struct {
+    _Alignas(64) _Atomic uint32_t seq;
+    cfs_stats_profile_t data;
+} cfs_stats_profile_rec_t;
+
+typedef struct {
+    _Alignas(64) _Atomic uint32_t seq;
+    cfs_stats_task_t data;
+} cfs_stats_task_rec_t;
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t max_tasks;
+    int32_t pid;                  // of the scheduler
+    cfs_stats_global_rec_t global;
+    cfs_stats_profile_rec_t profile;
+    cfs_stats_task_rec_t tasks[CFS_STATS_MAX_TASKS];
+} cfs_stats_page_t;
+
+/* ---- writer ---- */
+
+static inline void cfs_stats_write_begin(_Atomic uint32_t *seq) {
+    uint32_t s = atomic_load_explicit(seq, memory_order_relaxed);
+    atomic_store_explicit(seq, s + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+}
+
+static inline void cfs_stats_write_end(_Atomic uint32_t *seq) {
+    uint32_t s = atomic_load_explicit(seq, memory_order_relaxed);
+    atomic_store_explicit(seq, s + 1, memory_order_release);
+}
+
+/* ---- reader ---- */
+
+// copies n bytes of a record into out; returns the number of retries
+static inline unsigned cfs_stats_read(const _Atomic uint32_t *seq, const void *data,
+                                      void *out, size_t n) {
+    for (unsigned retries = 0;; retries++) {
+        if (retries && retries % CFS_STATS_SPINS == 0) sched_yield();
+        uint32_t before = atomic_load_explicit(seq, memory_order_acquire);
+        if (before & 1) continue;
+        memcpy(out, data, n);
+        atomic_thread_fence(memory_order_acquire);
+        if (atomic_load_explicit(seq, memory_order_relaxed) == before) return retries;
+    }
+}
+
+#define CFS_STATS_READ(rec, out) \
+    cfs_stats_read(&(rec)->seq, &(rec)->data, (out), sizeof((rec)->data))
+
+// upper bound of the bucket holding the pct-th percentile of a phase, in ns
+static inline uint64_t cfs_stats_phase_percentile_ns(const cfs_stats_profile_t *p, int phase, int pct) {
+    uint64_t rank = (p->samples[phase] * pct + 99) / 100, seen = 0;
+    for (int b = 0; b < CFS_STATS_PHASE_BUCKETS; b++) {
+        seen += p->hist[phase][b];
+        if (seen >= rank) return 1ULL << (b + 1);
+    }
+    return 1ULL << CFS_STATS_PHASE_BUCKETS;
+}
+
+// maps the page published under name (with or without the leading slash);
+// NULL with errno set when it does not exist or is not a stats page
+static inline const cfs_stats_page_t *cfs_stats_open(const char *name) {
+    char path[256] = "/";
+    strncat(path, name + (name[0] == '/'), sizeof(path) - 2);
+    int fd = shm_open(path, O_RDONLY, 0);
+    if (fd < 0) return NULL;
+
+    struct stat st;
+    if (fstat(fd, &st) < 0 || st.st_size < (off_t)sizeof(cfs_stats_page_t)) {
+        close(fd);
+        errno = EINVAL;
+        return NULL;
+    }
+    const cfs_stats_page_t *page = mmap(NULL, sizeof(cfs_stats_page_t), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (page == MAP_FAILED) return NULL;
+    if (page->magic != CFS_STATS_MAGIC || page->version != CFS_STATS_VERSION ||
+        page->max_tasks != CFS_STATS_MAX_TASKS) {
+        munmap((void *)page, sizeof(cfs_stats_page_t));
+        errno = EPROTO;
+        return NULL;
+    }
+    return page;
+}
+
+static inline void cfs_stats_close(const cfs_stats_page_t *page) {
+    munmap((void *)page, sizeof(cfs_stats_page_t));
+}
+
+#endif
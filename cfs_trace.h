@@ -0,0 +1,425 @@
+// compact on-disk trace format written by the scheduler (-T) and read by
+// trace_analyzer. shared by both so the encoder and decoder cannot drift.
+//
+// file   = trace_file_hdr_t, then blocks until end of file
+// block  = trace_block_hdr_t, then stored_len payload bytes
+// stream = every block belongs to one stream (one cpu); timestamps are
+//          delta-coded within a stream and each block restarts from its
+//          base_us, so blocks decode independently and in any order
+// event  = 1 byte    type << 4 | task, where task 14 means the task of
+//                    the previous event in the block and 15 that the
+//                    task follows as a varint
+//          varint    microseconds since the previous event of the stream
+//          varint    zigzag argument, only for types in trace_has_arg
+// explain  = an event (task = the picked task) followed by the rival's task
+//          varint, a flags byte and the zigzag score terms (us) of the
+//          winner, then of the rival, in trace_term_t order
+//
+// payloads are stored raw or compressed per block. TRACE_CODEC_LZ4 is the
+// lz4 block format: produced by liblz4 when built with -DCFS_TRACE_LZ4
+// -llz4, otherwise by the small encoder below, and always decoded here.
+// TRACE_CODEC_ZSTD needs -DCFS_TRACE_ZSTD -lzstd on both sides. headers are
+// written in host byte order; the magic rejects foreign-endian files
+
+#ifndef CFS_TRACE_H
+#define CFS_TRACE_H
+
+#include <stdint.h>
+#include <string.h>
+
+#if defined(CFS_TRACE_ZSTD) && defined(__has_include)
+#if __has_include(<zstd.h>)
+#include <zstd.h>
+#define CFS_TRACE_HAVE_ZSTD 1
+#endif
+#endif
+
+#if defined(CFS_TRACE_LZ4) && defined(__has_include)
+#if __has_include(<lz4.h>)
+#include <lz4.h>
+#define CFS_TRACE_HAVE_LZ4 1
+#endif
+#endif
+
+#define TRACE_MAGIC "CFSTRC1"         // 8 bytes with the nul
+#define TRACE_VERSION 1
+#define TRACE_MAX_STREAMS 64
+#define TRACE_BLOCK_SIZE 65536        // raw payload bytes per block
+#define TRACE_EVENT_MAX 128           // longest encoded event (an explain record), rounded up
+#define TRACE_TASK_INLINE 14          // task ids below this fit in the type byte
+#define TRACE_TASK_SAME 14            // same task as the previous event
+#define TRACE_TASK_VARINT 15
+#define TRACE_TASK_NONE UINT32_MAX    // no previous event in the block
+
+typedef enum {
+    TR_ARRIVE = 1,
+    TR_WAKE,
+    TR_THROTTLE,                  // arg: throttle cause
+    TR_AGING,                     // arg: new aging boost
+    TR_PICK,
+    TR_MIGRATE,                   // arg: policy index switched to
+    TR_SWITCH_IN,                 // arg: ms waited since ready
+    TR_SWITCH_OUT,                // arg: ms executed in the slice
+    TR_COMPLETE,                  // arg: turnaround ms
+    TR_SLEEP,                     // arg: planned sleep ms
+    TR_EXPLAIN,                   // score breakdown of a sampled pick, see trace_explain_t
+    TR_TYPES
+} trace_type_t;
+
+static const char *const trace_type_names[TR_TYPES] = {
+    "?", "arrive", "wake", "throttle", "aging", "pick",
+    "migrate", "switch_in", "switch_out", "complete", "sleep", "explain"
+};
+
+static const uint8_t trace_has_arg[TR_TYPES] = {0, 0, 0, 1, 1, 0, 1, 1, 1, 1, 1, 0};
+
+// terms of the heuristic score; a candidate's score is their sum and the
+// lowest score wins
+typedef enum {
+    TRACE_TERM_VRUNTIME,          // vruntime above the lowest candidate's
+    TRACE_TERM_AGING,
+    TRACE_TERM_INTERACTIVE,
+    TRACE_TERM_LONG_TASK,
+    TRACE_TERM_CRITICAL_PATH,
+    TRACE_TERMS
+} trace_term_t;
+
+static const char *const trace_term_names[TRACE_TERMS] = {
+    "vruntime", "aging", "interactive", "long_task", "critical_path"
+};
+
+#define TRACE_EXPLAIN_VRUNTIME_RIVAL 1    // rival is first in pure vruntime order, else the runner-up
+
+typedef struct {
+    uint32_t rival;
+    uint8_t flags;
+    int64_t terms[2][TRACE_TERMS];        // [0] winner, [1] rival, us of score
+} trace_explain_t;
+
+typedef enum {
+    TRACE_CODEC_RAW,
+    TRACE_CODEC_LZ4,
+    TRACE_CODEC_ZSTD
+} trace_codec_t;
+
+static const char *const trace_codec_names[] = {"raw", "lz4", "zstd"};
+
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t streams;
+    uint64_t start_ns;            // CLOCK_MONOTONIC at time 0
+} trace_file_hdr_t;
+
+typedef struct {
+    uint8_t stream;
+    uint8_t codec;
+    uint16_t reserved;
+    uint32_t raw_len;
+    uint32_t stored_len;
+    uint32_t events;
+    uint64_t base_us;             // time of the event before the first one
+} trace_block_hdr_t;
+
+_Static_assert(sizeof(trace_file_hdr_t) == 24, "trace file header layout");
+_Static_assert(sizeof(trace_block_hdr_t) == 24, "trace block header layout");
+
+/* ---- varints ---- */
+
+static inline uint8_t *trace_put_varint(uint8_t *p, uint64_t v) {
+    while (v >= 0x80) {
+        *p++ = (uint8_t)v | 0x80;
+        v >>= 7;
+    }
+    *p++ = (uint8_t)v;
+    return p;
+}
+
+// NULL when the varint runs past end
+static inline const uint8_t *trace_get_varint(const uint8_t *p, const uint8_t *end, uint64_t *v) {
+    uint64_t x = 0;
+    for (int shift = 0; p < end && shift < 64; shift += 7) {
+        uint8_t b = *p++;
+        x |= (uint64_t)(b & 0x7f) << shift;
+        if (!(b & 0x80)) {
+            *v = x;
+            return p;
+        }
+    }
+    return NULL;
+}
+
+static inline uint64_t trace_zigzag(int64_t v) {
+    return ((uint64_t)v << 1) ^ (uint64_t)(v >> 63);
+}
+
+static inline int64_t trace_unzigzag(uint64_t v) {
+    return (int64_t)(v >> 1) ^ -(int64_t)(v & 1);
+}
+
+/* ---- events ---- */
+
+// *prev_task is the task of the previous event in the block, start each
+// block with TRACE_TASK_NONE
+static inline uint8_t *trace_put_event(uint8_t *p, uint32_t *prev_task, int type, uint32_t task,
+                                       uint64_t delta_us, int64_t arg) {
+    if (task == *prev_task) {
+        *p++ = (uint8_t)(type << 4 | TRACE_TASK_SAME);
+    } else if (task < TRACE_TASK_INLINE) {
+        *p++ = (uint8_t)(type << 4 | task);
+    } else {
+        *p++ = (uint8_t)(type << 4 | TRACE_TASK_VARINT);
+        p = trace_put_varint(p, task);
+    }
+    *prev_task = task;
+    p = trace_put_varint(p, delta_us);
+    if (trace_has_arg[type]) p = trace_put_varint(p, trace_zigzag(arg));
+    return p;
+}
+
+static inline uint8_t *trace_put_explain(uint8_t *p, const trace_explain_t *x) {
+    p = trace_put_varint(p, x->rival);
+    *p++ = x->flags;
+    for (int side = 0; side < 2; side++) {
+        for (int k = 0; k < TRACE_TERMS; k++) p = trace_put_varint(p, trace_zigzag(x->terms[side][k]));
+    }
+    return p;
+}
+
+typedef struct {
+    int type;
+    uint32_t task;
+    uint64_t time_us;
+    int64_t arg;
+    trace_explain_t explain;      // TR_EXPLAIN only
+} trace_event_t;
+
+// decodes one event and advances *time_us and *prev_task (start each block
+// with its base_us and TRACE_TASK_NONE); NULL on a malformed event
+static inline const uint8_t *trace_get_event(const uint8_t *p, const uint8_t *end, uint64_t *time_us,
+                                             uint32_t *prev_task, trace_event_t *ev) {
+    if (p >= end) return NULL;
+    uint64_t v;
+    ev->type = *p >> 4;
+    ev->task = *p & 0xf;
+    p++;
+    if (ev->type == 0 || ev->type >= TR_TYPES) return NULL;
+    if (ev->task == TRACE_TASK_SAME) {
+        if (*prev_task == TRACE_TASK_NONE) return NULL;
+        ev->task = *prev_task;
+    } else if (ev->task == TRACE_TASK_VARINT) {
+        if (!(p = trace_get_varint(p, end, &v)) || v >= TRACE_TASK_NONE) return NULL;
+        ev->task = (uint32_t)v;
+    }
+    *prev_task = ev->task;
+    if (!(p = trace_get_varint(p, end, &v))) return NULL;
+    *time_us += v;
+    ev->time_us = *time_us;
+    ev->arg = 0;
+    if (trace_has_arg[ev->type]) {
+        if (!(p = trace_get_varint(p, end, &v))) return NULL;
+        ev->arg = trace_unzigzag(v);
+    }
+    if (ev->type == TR_EXPLAIN) {
+        trace_explain_t *x = &ev->explain;
+        if (!(p = trace_get_varint(p, end, &v)) || v >= TRACE_TASK_NONE || p >= end) return NULL;
+        x->rival = (uint32_t)v;
+        x->flags = *p++;
+        for (int side = 0; side < 2; side++) {
+            for (int k = 0; k < TRACE_TERMS; k++) {
+                if (!(p = trace_get_varint(p, end, &v))) return NULL;
+                x->terms[side][k] = trace_unzigzag(v);
+            }
+        }
+    }
+    return p;
+}
+
+/* ---- built-in lz4 block codec ---- */
+
+/* greedy single-probe matcher producing the lz4 block format, so the
+   output is readable by liblz4 and liblz4 output is readable here. it
+   honours the format's end rules: the last 5 bytes are literals and no
+   match starts in the last 12 */
+#define TRACE_LZ_HASH_BITS 12
+#define TRACE_LZ_MIN_MATCH 4
+#define TRACE_LZ_LAST_LITERALS 5
+#define TRACE_LZ_MATCH_LIMIT 12
+
+// worst case for incompressible input
+#define TRACE_LZ_BOUND(n) ((n) + (n) / 255 + 16)
+
+static inline uint32_t trace_lz_read32(const uint8_t *p) {
+    uint32_t v;
+    memcpy(&v, p, 4);
+    return v;
+}
+
+static inline uint8_t *trace_lz_put_length(uint8_t *op, size_t len) {
+    for (; len >= 255; len -= 255) *op++ = 255;
+    *op++ = (uint8_t)len;
+    return op;
+}
+
+static inline size_t trace_lz_compress(const uint8_t *src, size_t n, uint8_t *dst) {
+    uint32_t table[1 << TRACE_LZ_HASH_BITS];
+    memset(table, 0, sizeof(table));
+
+    const uint8_t *ip = src, *anchor = src;
+    const uint8_t *limit = n > TRACE_LZ_MATCH_LIMIT ? src + n - TRACE_LZ_MATCH_LIMIT : src;
+    const uint8_t *match_end = src + n - TRACE_LZ_LAST_LITERALS;
+    uint8_t *op = dst;
+
+    // positions are stored +1 so that 0 means empty
+    while (ip < limit) {
+        uint32_t seq = trace_lz_read32(ip);
+        uint32_t h = (seq * 2654435761u) >> (32 - TRACE_LZ_HASH_BITS);
+        uint32_t cand = table[h];
+        table[h] = (uint32_t)(ip - src) + 1;
+        if (!cand || (size_t)(ip - src) - (cand - 1) > 65535 || trace_lz_read32(src + cand - 1) != seq) {
+            ip++;
+            continue;
+        }
+
+        const uint8_t *ref = src + cand - 1;
+        const uint8_t *mp = ip + TRACE_LZ_MIN_MATCH;
+        const uint8_t *rp = ref + TRACE_LZ_MIN_MATCH;
+        while (mp < match_end && *mp == *rp) {
+            mp++;
+            rp++;
+        }
+
+        size_t lit = ip - anchor, mlen = (mp - ip) - TRACE_LZ_MIN_MATCH;
+        uint8_t *token = op++;
+        *token = (uint8_t)((lit < 15 ? lit : 15) << 4 | (mlen < 15 ? mlen : 15));
+        if (lit >= 15) op = trace_lz_put_length(op, lit - 15);
+        memcpy(op, anchor, lit);
+        op += lit;
+        uint16_t off = (uint16_t)(ip - ref);
+        *op++ = (uint8_t)off;
+        *op++ = (uint8_t)(off >> 8);
+        if (mlen >= 15) op = trace_lz_put_length(op, mlen - 15);
+
+        ip = anchor = mp;
+    }
+
+    size_t lit = src + n - anchor;
+    *op++ = (uint8_t)((lit < 15 ? lit : 15) << 4);
+    if (lit >= 15) op = trace_lz_put_length(op, lit - 15);
+    memcpy(op, anchor, lit);
+    op += lit;
+    return op - dst;
+}
+
+// decompressed size, or -1 if the block is malformed or overflows cap
+static inline long trace_lz_decompress(const uint8_t *src, size_t n, uint8_t *dst, size_t cap) {
+    const uint8_t *ip = src, *end = src + n;
+    uint8_t *op = dst, *oend = dst + cap;
+
+    while (ip < end) {
+        uint8_t token = *ip++;
+        size_t lit = token >> 4;
+        if (lit == 15) {
+            uint8_t b;
+            do {
+                if (ip >= end) return -1;
+                lit += b = *ip++;
+            } while (b == 255);
+        }
+        if (lit > (size_t)(end - ip) || lit > (size_t)(oend - op)) return -1;
+        memcpy(op, ip, lit);
+        op += lit;
+        ip += lit;
+        if (ip == end) break;    // last sequence has no match
+
+        if (end - ip < 2) return -1;
+        size_t off = ip[0] | (size_t)ip[1] << 8;
+        ip += 2;
+        if (off == 0 || off > (size_t)(op - dst)) return -1;
+
+        size_t mlen = token & 15;
+        if (mlen == 15) {
+            uint8_t b;
+            do {
+                if (ip >= end) return -1;
+                mlen += b = *ip++;
+            } while (b == 255);
+        }
+        mlen += TRACE_LZ_MIN_MATCH;
+        if (mlen > (size_t)(oend - op)) return -1;
+        const uint8_t *ref = op - off;
+        if (off >= mlen) {
+            memcpy(op, ref, mlen);
+            op += mlen;
+        } else {
+            while (mlen--) *op++ = *ref++;    // overlapping: repeats the last off bytes
+        }
+    }
+    return op - dst;
+}
+
+/* ---- block codecs ---- */
+
+#if defined(CFS_TRACE_HAVE_ZSTD)
+#define TRACE_CODEC_DEFAULT TRACE_CODEC_ZSTD
+#define TRACE_ZSTD_LEVEL 1
+#else
+#define TRACE_CODEC_DEFAULT TRACE_CODEC_LZ4
+#endif
+
+// room a compressed block may need
+#define TRACE_STORED_MAX TRACE_LZ_BOUND(TRACE_BLOCK_SIZE)
+
+// compresses a raw block into dst (TRACE_STORED_MAX bytes) and returns the
+// codec used; blocks that do not shrink are stored raw
+static inline int trace_encode_block(int codec, const uint8_t *src, size_t n, uint8_t *dst, size_t *stored) {
+    size_t len = 0;
+    switch (codec) {
+#if defined(CFS_TRACE_HAVE_ZSTD)
+    case TRACE_CODEC_ZSTD: {
+        size_t r = ZSTD_compress(dst, TRACE_STORED_MAX, src, n, TRACE_ZSTD_LEVEL);
+        if (!ZSTD_isError(r)) len = r;
+        break;
+    }
+#endif
+    case TRACE_CODEC_LZ4:
+#if defined(CFS_TRACE_HAVE_LZ4)
+        len = LZ4_compress_default((const char *)src, (char *)dst, (int)n, TRACE_STORED_MAX);
+#else
+        len = trace_lz_compress(src, n, dst);
+#endif
+        break;
+    default:
+        break;
+    }
+
+    if (len == 0 || len >= n) {
+        memcpy(dst, src, n);
+        *stored = n;
+        return TRACE_CODEC_RAW;
+    }
+    *stored = len;
+    return codec;
+}
+
+// raw length, or -1 for a malformed block or a codec not compiled in
+static inline long trace_decode_block(int codec, const uint8_t *src, size_t n, uint8_t *dst, size_t cap) {
+    switch (codec) {
+    case TRACE_CODEC_RAW:
+        if (n > cap) return -1;
+        memcpy(dst, src, n);
+        return (long)n;
+    case TRACE_CODEC_LZ4:
+        return trace_lz_decompress(src, n, dst, cap);
+#if defined(CFS_TRACE_HAVE_ZSTD)
+    case TRACE_CODEC_ZSTD: {
+        size_t r = ZSTD_decompress(dst, cap, src, n);
+        return ZSTD_isError(r) ? -1 : (long)r;
+    }
+#endif
+    default:
+        return -1;
+    }
+}
+
+#endif
@@ -0,0 +1,140 @@
+// binary workload format written by wlconvert from the text workload format
+// and memory-mapped by the scheduler (-f) and scheduler_simulation.py:
+// startup iterates fixed-width records in place instead of parsing lines.
+//
+// file    = wl_hdr_t, then num_tasks wl_task_t records, then num_deps
+//           uint32 parent ids, then the string table; sections 8-aligned
+// order   = records are sorted by release time (arrival, or the release of
+//           a later parent), so admitting tasks as their time comes is a
+//           sequential read. parents always precede their children and
+//           task ids are record indexes
+// strings = nul-terminated names referenced by byte offset; offset 0 is
+//           "default". the text format names only groups, so that is all
+//           the table holds today
+//
+// headers and records are in host byte order; the magic rejects files from
+// a foreign-endian host
+
+#ifndef CFS_WORKLOAD_H
+#define CFS_WORKLOAD_H
+
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define WL_MAGIC "CFSWKL1"            // 8 bytes with the nul
+#define WL_VERSION 1
+
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t record_size;
+    uint64_t num_tasks;
+    uint64_t tasks_offset;
+    uint64_t deps_offset;
+    uint64_t num_deps;
+    uint64_t strings_offset;
+    uint64_t strings_size;
+} wl_hdr_t;
+
+typedef struct {
+    uint32_t release_ms;          // sort key: arrival, or the latest parent release
+    uint32_t arrival_ms;
+    uint32_t burst_ms;
+    uint32_t line;                // index of the task in the source text
+    int32_t nice;
+    uint32_t slo_ms;              // 0 = none
+    uint32_t io_run_ms;           // 0 = never blocks
+    uint32_t io_sleep_ms;
+    uint32_t warm_ms;
+    uint32_t lock_hold_ms;        // 0 = no shared lock
+    uint32_t lock_period_ms;
+    uint32_t disk_kb;
+    uint32_t mem_mb;
+    uint32_t group;               // string table offset of the group name
+    uint32_t deps_first;          // index of the first parent in the dependency array
+    uint32_t deps_count;
+} wl_task_t;
+
+_Static_assert(sizeof(wl_hdr_t) == 64, "workload header is 64 bytes");
+_Static_assert(sizeof(wl_task_t) == 64, "workload records are 64 bytes");
+
+// a mapped workload; every pointer is into the mapping
+typedef struct {
+    const wl_hdr_t *hdr;
+    const wl_task_t *tasks;
+    const uint32_t *deps;
+    const char *strings;
+    size_t size;
+} wl_view_t;
+
+static inline int wl_is_binary(const char *path) {
+    char magic[8];
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return 0;
+    int is = read(fd, magic, sizeof(magic)) == (ssize_t)sizeof(magic) &&
+             memcmp(magic, WL_MAGIC, sizeof(magic)) == 0;
+    close(fd);
+    return is;
+}
+
+// section inside the file, 8-aligned
+static inline int wl_section_ok(uint64_t offset, uint64_t count, uint64_t size, size_t file) {
+    return offset % 8 == 0 && offset <= file && (size == 0 || count <= (file - offset) / size);
+}
+
+// maps and checks a workload; -1 with errno set on failure. the records
+// themselves are checked by the reader as it goes (wl_string, dependency ids)
+static inline int wl_open(const char *path, wl_view_t *wl) {
+    int fd = open(path, O_RDONLY);
+    struct stat st;
+    if (fd < 0) return -1;
+    if (fstat(fd, &st) < 0) {
+        close(fd);
+        return -1;
+    }
+    if ((size_t)st.st_size < sizeof(wl_hdr_t)) {
+        close(fd);
+        errno = EPROTO;
+        return -1;
+    }
+    void *map = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) return -1;
+    madvise(map, st.st_size, MADV_SEQUENTIAL);
+
+    const wl_hdr_t *hdr = map;
+    size_t size = st.st_size;
+    if (memcmp(hdr->magic, WL_MAGIC, sizeof(hdr->magic)) != 0 || hdr->version != WL_VERSION ||
+        hdr->record_size != sizeof(wl_task_t) ||
+        !wl_section_ok(hdr->tasks_offset, hdr->num_tasks, sizeof(wl_task_t), size) ||
+        !wl_section_ok(hdr->deps_offset, hdr->num_deps, sizeof(uint32_t), size) ||
+        !wl_section_ok(hdr->strings_offset, hdr->strings_size, 1, size) ||
+        hdr->strings_size == 0 || ((const char *)map)[hdr->strings_offset + hdr->strings_size - 1] != '\0') {
+        munmap(map, size);
+        errno = EPROTO;
+        return -1;
+    }
+    wl->hdr = hdr;
+    wl->tasks = (const wl_task_t *)((const char *)map + hdr->tasks_offset);
+    wl->deps = (const uint32_t *)((const char *)map + hdr->deps_offset);
+    wl->strings = (const char *)map + hdr->strings_offset;
+    wl->size = size;
+    return 0;
+}
+
+// NULL when the offset is outside the string table
+static inline const char *wl_string(const wl_view_t *wl, uint32_t offset) {
+    return offset < wl->hdr->strings_size ? wl->strings + offset : NULL;
+}
+
+static inline void wl_close(wl_view_t *wl) {
+    munmap((void *)wl->hdr, wl->size);
+    wl->hdr = NULL;
+}
+
+#endif
@@ -0,0 +1,241 @@
+// time-range queries over a snapshot ring file (-Y)
+// compile: gcc -O2 -o ringquery ringquery.c -Wall -Wextra
+// usage:   ./ringquery [-t task] [-g group] [-s ms] [-e ms] [-a] [-i] ring.bin
+//
+// the newest record and the start of the range are found by binary search
+// over the slots (cfs_ring.h), then only the range itself is read. works on
+// the file of a scheduler that is still running or that crashed: records
+// that fail their check are skipped
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "cfs_ring.h"
+#include "cfs_stats.h"        // task state names
+
+static const ring_hdr_t *hdr;
+static const ring_rec_t *recs;
+static uint64_t slots;
+static uint64_t oldest, count;    // slot of the oldest record, records held
+static long examined;
+
+// seq of a slot, 0 when never written or torn
+static uint64_t slot_seq(uint64_t slot) {
+    examined++;
+    return ring_valid(&recs[slot], slot, slots) ? recs[slot].seq : 0;
+}
+
+static const ring_rec_t *logical(uint64_t i) {
+    return &recs[(oldest + i) % slots];
+}
+
+// slots 0..h hold the newest lap in increasing seq, the rest the previous
+// lap (smaller seqs) or nothing: h is the last slot at or above slot 0
+static void locate(void) {
+    uint64_t first = slot_seq(0);
+    if (first == 0) {
+        // empty, or only a torn first record
+        oldest = count = 0;
+        return;
+    }
+    uint64_t lo = 0, hi = slots - 1;
+    while (lo < hi) {
+        uint64_t mid = lo + (hi - lo + 1) / 2;
+        if (slot_seq(mid) >= first) lo = mid;
+        else hi = mid - 1;
+    }
+    uint64_t newest = recs[lo].seq;
+    if (newest <= slots) {
+        oldest = 0;
+        count = newest;
+    } else {
+        oldest = (lo + 1) % slots;
+        count = slots;
+    }
+}
+
+// first logical index whose time is at least ms; a torn record can only be
+// the oldest (it was overwriting it), so invalid records count as old
+static uint64_t lower_bound(uint32_t ms) {
+    uint64_t lo = 0, hi = count;
+    while (lo < hi) {
+        uint64_t mid = lo + (hi - lo) / 2;
+        uint64_t slot = (oldest + mid) % slots;
+        if (slot_seq(slot) == 0 || recs[slot].time_ms < ms) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+static const char *group_name(int g) {
+    return g < (int)hdr->num_groups && hdr->groups[g][0] ? hdr->groups[g] : "?";
+}
+
+static void print_throttle(int bits) {
+    if (!bits) {
+        printf("-");
+        return;
+    }
+    const char *sep = "";
+    if (bits & RING_THROTTLE_MEM) printf("%smem", sep), sep = ",";
+    if (bits & RING_THROTTLE_ADMIT) printf("%sadmit", sep), sep = ",";
+    if (bits & RING_THROTTLE_DRF) printf("%sdrf", sep);
+}
+
+static void print_usage(const char *prog) {
+    fprintf(stderr,
+            "usage: %s [-t task] [-g group] [-s ms] [-e ms] [-a] [-i] ring\n"
+            "  -t N     only task N\n"
+            "  -g NAME  only tasks of group NAME\n"
+            "  -s MS    from this time since the scheduler started (default: oldest held)\n"
+            "  -e MS    up to this time (default: newest)\n"
+            "  -a       one line per snapshot, summed over the selected tasks\n"
+            "  -i       print the header and the time range held, then exit\n",
+            prog);
+}
+
+int main(int argc, char **argv) {
+    int opt, task = -1, aggregate = 0, info = 0;
+    const char *group = NULL;
+    long from_ms = 0, to_ms = UINT32_MAX;
+    while ((opt = getopt(argc, argv, "t:g:s:e:aih")) != -1) {
+        switch (opt) {
+        case 't': task = atoi(optarg); break;
+        case 'g': group = optarg; break;
+        case 's': from_ms = atol(optarg); break;
+        case 'e': to_ms = atol(optarg); break;
+        case 'a': aggregate = 1; break;
+        case 'i': info = 1; break;
+        default:
+            print_usage(argv[0]);
+            return opt == 'h' ? 0 : 1;
+        }
+    }
+    if (optind != argc - 1 || from_ms < 0 || to_ms < from_ms) {
+        print_usage(argv[0]);
+        return 1;
+    }
+    const char *path = argv[optind];
+
+    int fd = open(path, O_RDONLY);
+    struct stat sb;
+    if (fd < 0 || fstat(fd, &sb) != 0) {
+        perror(path);
+        return 1;
+    }
+    if (sb.st_size < RING_HDR_SIZE) {
+        fprintf(stderr, "%s: not a ring file\n", path);
+        return 1;
+    }
+    void *map = mmap(NULL, sb.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        perror("mmap");
+        return 1;
+    }
+    hdr = map;
+    recs = (const ring_rec_t *)((const char *)map + RING_HDR_SIZE);
+    if (memcmp(hdr->magic, RING_MAGIC, sizeof(hdr->magic)) != 0 || hdr->version != RING_VERSION ||
+        hdr->record_size != sizeof(ring_rec_t) || hdr->slots == 0 ||
+        (uint64_t)sb.st_size < RING_HDR_SIZE + hdr->slots * sizeof(ring_rec_t)) {
+        fprintf(stderr, "%s: not a ring file (or from another version or host)\n", path);
+        return 1;
+    }
+    slots = hdr->slots;
+
+    int group_idx = -1;
+    if (group) {
+        for (uint32_t g = 0; g < hdr->num_groups && g < RING_GROUPS; g++) {
+            if (strncmp(hdr->groups[g], group, RING_GROUP_NAME) == 0) group_idx = g;
+        }
+        if (group_idx < 0) {
+            fprintf(stderr, "no group '%s' in %s\n", group, path);
+            return 1;
+        }
+    }
+
+    locate();
+    if (info) {
+        time_t start = hdr->start_unix_ns / 1000000000ULL;
+        char when[64];
+        strftime(when, sizeof(when), "%Y-%m-%d %H:%M:%S", localtime(&start));
+        printf("started     %s\n", when);
+        printf("interval    %u ms\n", hdr->interval_ms);
+        printf("slots       %llu (%llu held, head hint %llu)\n",
+               (unsigned long long)slots, (unsigned long long)count, (unsigned long long)hdr->head);
+        uint64_t i = 0;
+        while (i < count && slot_seq((oldest + i) % slots) == 0) i++;
+        if (i < count) {
+            const ring_rec_t *first = logical(i), *last = logical(count - 1);
+            printf("records     %llu to %llu\n", (unsigned long long)first->seq, (unsigned long long)last->seq);
+            printf("time        %u to %u ms\n", first->time_ms, last->time_ms);
+        }
+        printf("groups     ");
+        for (uint32_t g = 0; g < hdr->num_groups && g < RING_GROUPS; g++) printf(" %s", hdr->groups[g]);
+        printf("\n");
+        return 0;
+    }
+
+    if (aggregate) printf("time_ms\ttasks\tshare\trunnable\twait_ms\tcpu_ms\tthrottled\n");
+    else printf("time_ms\ttask\tgroup\tstate\tshare\trunnable\twait_ms\tcpu_ms\tthrottle\n");
+
+    long matched = 0, skipped = 0;
+    long snap_time = -1, snap_tasks = 0, snap_share = 0, snap_runnable = 0, snap_throttled = 0;
+    long long snap_wait = 0, snap_cpu = 0;
+    for (uint64_t i = lower_bound((uint32_t)from_ms); i < count; i++) {
+        uint64_t slot = (oldest + i) % slots;
+        const ring_rec_t *r = &recs[slot];
+        examined++;
+        if (!ring_valid(r, slot, slots)) {
+            skipped++;
+            continue;
+        }
+        if (r->time_ms > to_ms) break;
+        if (task >= 0 && r->task != task) continue;
+        if (group_idx >= 0 && r->group != group_idx) continue;
+        matched++;
+
+        if (!aggregate) {
+            int state = r->state < CFS_TASK_STATES ? r->state : CFS_TASK_EMPTY;
+            printf("%u\t%u\t%s\t%s\t%.2f\t%u\t%u\t%u\t", r->time_ms, r->task, group_name(r->group),
+                   cfs_task_state_names[state], r->share_bp / 100.0, r->runnable, r->wait_ms, r->cpu_ms);
+            print_throttle(r->throttle);
+            printf("\n");
+            continue;
+        }
+        if ((long)r->time_ms != snap_time) {
+            if (snap_time >= 0) {
+                printf("%ld\t%ld\t%.2f\t%ld\t%lld\t%lld\t%ld\n", snap_time, snap_tasks,
+                       snap_share / 100.0, snap_runnable, snap_wait, snap_cpu, snap_throttled);
+            }
+            snap_time = r->time_ms;
+            snap_tasks = snap_share = snap_throttled = 0;
+            snap_wait = snap_cpu = 0;
+        }
+        snap_tasks++;
+        snap_share += r->share_bp;
+        snap_runnable = r->runnable;
+        snap_wait += r->wait_ms;
+        snap_cpu += r->cpu_ms;
+        snap_throttled += r->throttle != 0;
+    }
+    if (aggregate && snap_time >= 0) {
+        printf("%ld\t%ld\t%.2f\t%ld\t%lld\t%lld\t%ld\n", snap_time, snap_tasks,
+               snap_share / 100.0, snap_runnable, snap_wait, snap_cpu, snap_throttled);
+    }
+
+    fprintf(stderr, "%ld records matched, %ld slots read of %llu held", matched, examined,
+            (unsigned long long)count);
+    if (skipped) fprintf(stderr, ", %ld torn records skipped", skipped);
+    fprintf(stderr, "\n");
+    munmap(map, sb.st_size);
+    return 0;
+}
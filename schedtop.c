@@ -0,0 +1,648 @@
+// live top-like view of the scheduler's shared-memory stats page (-K)
+// compile: gcc -O2 -o schedtop schedtop.c -lm -Wall -Wextra
+// usage:   ./schedtop [-r hz] [-s key] [-F states] [-n frames] [-b tasks] name
+//
+// the page is read through cfs_stats.h: no locks and no system calls, and
+// the scheduler never waits for the viewer. every frame re-reads the global
+// record and the task rows on screen. full passes over all task records
+// (share averages, filter and top-k selection) run at most SCAN_HZ times a
+// second, and less often when a pass costs more than SCAN_BUDGET of a core,
+// so a large page costs the same at 60 Hz as at 10 Hz. a scheduler built with
+// -DCFS_PROFILE also publishes its per-phase decision times, shown above the
+// task rows ('p' hides them). -b swaps the page for a synthetic one with that
+// many tasks to measure the viewer's cost
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <string.h>
+#include <stdarg.h>
+#include <errno.h>
+#include <math.h>
+#include <time.h>
+#include <poll.h>
+#include <signal.h>
+#include <termios.h>
+#include <sys/ioctl.h>
+
+#include "cfs_stats.h"
+
+#define DEFAULT_HZ 10
+#define MAX_HZ 60
+#define SCAN_HZ 10                    // full passes over the task records per second, at most
+#define SCAN_BUDGET 0.015             // cpu share full passes may take
+#define SHARE_TAU_S 1.0               // time constant of the share averages
+#define MAX_CPUS 256
+#define HEADER_LINES 7
+#define PROFILE_LINES (CFS_STATS_PHASES + 1)
+#define FRAME_MAX (1 << 20)
+#define BENCH_FRAMES 600              // -b without -n
+
+typedef enum {
+    KEY_ID,
+    KEY_STATE,
+    KEY_VRUNTIME,
+    KEY_SHARE,
+    KEY_DEFICIT,                  // entitled share minus share
+    KEY_WAIT,                     // p99 dispatch wait
+    KEY_AGING,
+    KEY_CPU,
+    KEYS
+} sort_key_t;
+
+static const char *const key_names[KEYS] = {
+    "id", "state", "vruntime", "share", "deficit", "wait", "aging", "cpu"
+};
+static const int key_desc[KEYS] = {0, 0, 0, 1, 1, 1, 1, 1};   // largest first by default
+
+// filter presets cycled by 'f', as masks of cfs_task_state_t
+static const struct {
+    const char *name;
+    unsigned mask;
+} filters[] = {
+    {"all", ~0u},
+    {"active", ~(1u << CFS_TASK_EMPTY | 1u << CFS_TASK_DONE)},
+    {"runnable", 1u << CFS_TASK_READY | 1u << CFS_TASK_RUNNING},
+    {"blocked", 1u << CFS_TASK_WAITING | 1u << CFS_TASK_SLEEPING | 1u << CFS_TASK_HELD},
+    {"done", 1u << CFS_TASK_DONE},
+};
+#define FILTERS ((int)(sizeof(filters) / sizeof(filters[0])))
+
+typedef struct {
+    cfs_stats_task_t t;
+    int64_t prev_cpu_ms;
+    double share;                 // of the dispatch cpu, averaged
+    double entitled;              // weight over the runnable weight, averaged
+    double key;
+} row_t;
+
+typedef struct {
+    unsigned long long busy, total;
+} cpu_times_t;
+
+static const cfs_stats_global_rec_t *global_rec;
+static const cfs_stats_task_rec_t *task_recs;
+static const cfs_stats_profile_rec_t *profile_rec;   // NULL for -b
+static int page_tasks;            // task records behind task_recs
+static pid_t page_pid;
+static const char *page_name;
+
+static row_t *rows;
+static int *top;                  // rows on screen, best first
+static int top_n, matched;
+static int sort_key = KEY_SHARE, reverse;
+static unsigned filter_mask = ~0u;
+static const char *filter_name = "all";
+
+static cfs_stats_global_t global;
+static cfs_stats_profile_t profile;
+static int show_profile = 1;
+static int64_t last_scan_elapsed = -1;
+static double dispatch_busy;
+static cpu_times_t cpu_prev[MAX_CPUS];
+static double cpu_busy[MAX_CPUS];
+static int num_cpus;
+
+static int term_rows = 24, term_cols = 100;
+static int tty_out;
+static struct termios term_saved;
+static int term_raw;
+static volatile sig_atomic_t stop;
+
+static char *frame;
+static size_t frame_len;
+
+// synthetic page for -b
+static cfs_stats_global_rec_t *bench_global;
+static cfs_stats_task_rec_t *bench_tasks;
+static uint32_t bench_rng = 12345;
+static int bench_running = -1;
+
+static double now_s(clockid_t clock) {
+    struct timespec ts;
+    clock_gettime(clock, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* ---- terminal ---- */
+
+static void term_restore(void) {
+    if (term_raw) tcsetattr(STDIN_FILENO, TCSANOW, &term_saved);
+    if (tty_out) fputs("\033[?25h", stdout);
+    fflush(stdout);
+}
+
+static void on_signal(int sig) {
+    (void)sig;
+    stop = 1;
+}
+
+static void term_setup(void) {
+    tty_out = isatty(STDOUT_FILENO);
+    if (isatty(STDIN_FILENO) && tcgetattr(STDIN_FILENO, &term_saved) == 0) {
+        struct termios raw = term_saved;
+        raw.c_lflag &= ~(ICANON | ECHO);
+        raw.c_cc[VMIN] = 0;
+        raw.c_cc[VTIME] = 0;
+        term_raw = tcsetattr(STDIN_FILENO, TCSANOW, &raw) == 0;
+    }
+    if (tty_out) fputs("\033[?25l\033[2J", stdout);
+    atexit(term_restore);
+    signal(SIGINT, on_signal);
+    signal(SIGTERM, on_signal);
+}
+
+static void term_size(void) {
+    struct winsize ws;
+    if (tty_out && ioctl(STDOUT_FILENO, TIOCGWINSZ, &ws) == 0 && ws.ws_row > 0) {
+        term_rows = ws.ws_row;
+        term_cols = ws.ws_col;
+    }
+}
+
+/* ---- sampling ---- */
+
+static int runnable_state(int state) {
+    return state == CFS_TASK_READY || state == CFS_TASK_RUNNING;
+}
+
+static double sort_value(const row_t *r) {
+    switch (sort_key) {
+    case KEY_ID: return r->t.task_id;
+    case KEY_STATE: return r->t.state;
+    case KEY_VRUNTIME: return (double)r->t.vruntime_ns;
+    case KEY_SHARE: return r->share;
+    case KEY_DEFICIT: return r->entitled - r->share;
+    case KEY_WAIT: return r->t.wait_p99_ms;
+    case KEY_AGING: return r->t.aging_boost;
+    default: return (double)r->t.cpu_ms;
+    }
+}
+
+// a ranks before b on screen
+static int better(int a, int b) {
+    double ka = rows[a].key, kb = rows[b].key;
+    if (ka != kb) return (ka > kb) == (key_desc[sort_key] != reverse);
+    return a < b;
+}
+
+// top holds a heap with the worst shown row at the root while scanning
+static void heap_sift(int i) {
+    for (;;) {
+        int worst = i, l = 2 * i + 1, r = l + 1;
+        if (l < top_n && better(top[worst], top[l])) worst = l;
+        if (r < top_n && better(top[worst], top[r])) worst = r;
+        if (worst == i) return;
+        int tmp = top[i];
+        top[i] = top[worst];
+        top[worst] = tmp;
+        i = worst;
+    }
+}
+
+static void heap_offer(int idx, int capacity) {
+    if (top_n < capacity) {
+        int i = top_n++;
+        top[i] = idx;
+        while (i > 0 && better(top[(i - 1) / 2], top[i])) {
+            int p = (i - 1) / 2, tmp = top[p];
+            top[p] = top[i];
+            top[i] = tmp;
+            i = p;
+        }
+    } else if (capacity > 0 && better(idx, top[0])) {
+        top[0] = idx;
+        heap_sift(0);
+    }
+}
+
+static int cmp_top(const void *a, const void *b) {
+    int x = *(const int *)a, y = *(const int *)b;
+    return better(x, y) ? -1 : better(y, x);
+}
+
+static void read_cpu_times(void) {
+    FILE *f = fopen("/proc/stat", "r");
+    if (!f) return;
+    char line[512];
+    int n = 0;
+    while (fgets(line, sizeof(line), f) && n < MAX_CPUS) {
+        if (strncmp(line, "cpu", 3) != 0) break;
+        if (line[3] == ' ') continue;         // the all-cpu line
+        unsigned long long v[8] = {0};
+        sscanf(line + 3, "%*d %llu %llu %llu %llu %llu %llu %llu %llu",
+               &v[0], &v[1], &v[2], &v[3], &v[4], &v[5], &v[6], &v[7]);
+        cpu_times_t now = {0, 0};
+        for (int i = 0; i < 8; i++) now.total += v[i];
+        now.busy = now.total - v[3] - v[4];   // minus idle and iowait
+        unsigned long long dt = now.total - cpu_prev[n].total;
+        if (cpu_prev[n].total && dt) cpu_busy[n] = (double)(now.busy - cpu_prev[n].busy) / dt;
+        cpu_prev[n++] = now;
+    }
+    fclose(f);
+    num_cpus = n;
+}
+
+// full pass: every record, the share averages and the top rows by sort key
+static void scan(int capacity) {
+    int n = global.num_tasks < page_tasks ? global.num_tasks : page_tasks;
+    double dt = last_scan_elapsed < 0 ? 0.0 : (global.elapsed_ms - last_scan_elapsed) / 1000.0;
+    static int averaging;         // the first interval seeds the averages
+    double alpha = dt > 0 ? (averaging++ ? 1.0 - exp(-dt / SHARE_TAU_S) : 1.0) : 0.0;
+    double per_ms = dt > 0 ? 1.0 / (dt * 1000.0) : 0.0;
+    last_scan_elapsed = global.elapsed_ms;
+
+    double weight_sum = 0;
+    int64_t cpu_total = 0;
+    for (int i = 0; i < n; i++) {
+        CFS_STATS_READ(&task_recs[i], &rows[i].t);
+        if (runnable_state(rows[i].t.state)) weight_sum += rows[i].t.weight;
+    }
+
+    top_n = matched = 0;
+    for (int i = 0; i < n; i++) {
+        row_t *r = &rows[i];
+        int64_t ran = r->t.cpu_ms - r->prev_cpu_ms;
+        r->prev_cpu_ms = r->t.cpu_ms;
+        if (alpha > 0) {
+            double entitled = runnable_state(r->t.state) && weight_sum > 0 ? r->t.weight / weight_sum : 0.0;
+            r->share += alpha * (ran * per_ms - r->share);
+            r->entitled += alpha * (entitled - r->entitled);
+            cpu_total += ran;
+        }
+        if (!(filter_mask & 1u << r->t.state)) continue;
+        matched++;
+        r->key = sort_value(r);
+        heap_offer(i, capacity);
+    }
+    if (alpha > 0) dispatch_busy += alpha * (cpu_total * per_ms - dispatch_busy);
+    qsort(top, top_n, sizeof(int), cmp_top);
+}
+
+// between scans only the rows on screen are re-read; order and shares stay
+static void refresh_rows(void) {
+    for (int i = 0; i < top_n; i++) {
+        CFS_STATS_READ(&task_recs[top[i]], &rows[top[i]].t);
+    }
+}
+
+/* ---- rendering ---- */
+
+static int profile_shown(void) {
+    return show_profile && profile.enabled;
+}
+
+static void emit(const char *fmt, ...) __attribute__((format(printf, 1, 2)));
+
+// appends one screen line, cut to the terminal width
+static void emit(const char *fmt, ...) {
+    char line[1024];
+    va_list ap;
+    va_start(ap, fmt);
+    int len = vsnprintf(line, sizeof(line), fmt, ap);
+    va_end(ap);
+    if (len < 0) len = 0;
+    if (len > (int)sizeof(line) - 1) len = sizeof(line) - 1;
+    if (len > term_cols) len = term_cols;
+    if (frame_len + len + 8 > FRAME_MAX) return;
+    memcpy(frame + frame_len, line, len);
+    frame_len += len;
+    if (tty_out) {
+        memcpy(frame + frame_len, "\033[K", 3);
+        frame_len += 3;
+    }
+    frame[frame_len++] = '\n';
+}
+
+static void render(int hz) {
+    frame_len = 0;
+    if (tty_out) {
+        memcpy(frame, "\033[H", 3);
+        frame_len = 3;
+    }
+
+    emit("schedtop - %s   pid %d   up %.1f s   policy #%d   %d Hz%s",
+         page_name, (int)page_pid, global.elapsed_ms / 1000.0, global.active_policy, hz,
+         global.finished ? "   [finished]" : "");
+    emit("tasks %d: %d runnable, %d done   slices %llu   switch-ins %llu   min_vruntime %.1f ms",
+         global.num_tasks, global.runnable, global.completed,
+         (unsigned long long)global.slices, (unsigned long long)global.dispatches,
+         global.min_vruntime_ns / 1e6);
+    if (global.running_task >= 0) {
+        emit("dispatch cpu %3.0f%% busy, running P%d", dispatch_busy * 100, global.running_task);
+    } else {
+        emit("dispatch cpu %3.0f%% busy, idle", dispatch_busy * 100);
+    }
+
+    // per-cpu occupancy from /proc/stat, two lines at most
+    char line[1024];
+    int used = 0, lines = 0;
+    for (int c = 0; c < num_cpus && lines < 2; c++) {
+        char cell[32], bar[11];
+        int filled = (int)(cpu_busy[c] * 10 + 0.5);
+        for (int b = 0; b < 10; b++) bar[b] = b < filled ? '#' : '.';
+        bar[10] = '\0';
+        int len = snprintf(cell, sizeof(cell), "cpu%-3d %s %3.0f%%  ", c, bar, cpu_busy[c] * 100);
+        if (used && used + len > term_cols) {
+            line[used] = '\0';
+            emit("%s", line);
+            used = 0;
+            lines++;
+            if (lines == 2) break;
+        }
+        memcpy(line + used, cell, len);
+        used += len;
+    }
+    if (used && lines < 2) {
+        line[used] = '\0';
+        emit("%s", line);
+        lines++;
+    }
+    for (; lines < 2; lines++) emit("%s", "");
+
+    // self-profile of the dispatcher, log2 buckets so percentiles are upper bounds
+    if (profile_shown()) {
+        uint64_t all = 0;
+        for (int ph = 0; ph < CFS_STATS_PHASES; ph++) all += profile.total_ns[ph];
+        emit("%-12s %9s %9s %9s %9s %9s %6s   %llu decisions",
+             "PHASE", "SAMPLES", "MEAN us", "p50 us<=", "p99 us<=", "MAX us", "SHARE",
+             (unsigned long long)profile.decisions);
+        for (int ph = 0; ph < CFS_STATS_PHASES; ph++) {
+            uint64_t n = profile.samples[ph];
+            emit("%-12s %9llu %9.1f %9.1f %9.1f %9.1f %5.1f%%",
+                 cfs_stats_phase_names[ph], (unsigned long long)n,
+                 n ? profile.total_ns[ph] / 1000.0 / n : 0.0,
+                 n ? cfs_stats_phase_percentile_ns(&profile, ph, 50) / 1000.0 : 0.0,
+                 n ? cfs_stats_phase_percentile_ns(&profile, ph, 99) / 1000.0 : 0.0,
+                 profile.max_ns[ph] / 1000.0, all ? 100.0 * profile.total_ns[ph] / all : 0.0);
+        }
+    }
+
+    emit("sort %s (%s)   filter %s: %d of %d   keys: s sort, r reverse, f filter, %s+/- rate, q quit",
+         key_names[sort_key], key_desc[sort_key] != reverse ? "desc" : "asc",
+         filter_name, matched, global.num_tasks, profile.enabled ? "p profile, " : "");
+    emit("%7s %-5s %12s %6s %6s %8s %7s %8s %5s %5s %9s %8s",
+         "TASK", "STATE", "VRUNTIME ms", "WEIGHT", "SHARE", "ENTITLED", "DEFICIT",
+         "WAIT p50", "p99", "AGING", "CPU ms", "LEFT ms");
+    for (int i = 0; i < top_n; i++) {
+        const row_t *r = &rows[top[i]];
+        int state = r->t.state >= 0 && r->t.state < CFS_TASK_STATES ? r->t.state : CFS_TASK_EMPTY;
+        emit("%7d %-5s %12.1f %6d %5.1f%% %7.1f%% %+6.1f%% %8d %5d %5d %9lld %8lld",
+             r->t.task_id, cfs_task_state_names[state], r->t.vruntime_ns / 1e6, r->t.weight,
+             r->share * 100, r->entitled * 100, (r->entitled - r->share) * 100,
+             r->t.wait_p50_ms, r->t.wait_p99_ms, r->t.aging_boost,
+             (long long)r->t.cpu_ms, (long long)r->t.remaining_ms);
+    }
+
+    if (tty_out) {
+        memcpy(frame + frame_len, "\033[J", 3);
+        frame_len += 3;
+    } else {
+        frame[frame_len++] = '\n';
+    }
+    for (size_t off = 0; off < frame_len;) {
+        ssize_t w = write(STDOUT_FILENO, frame + off, frame_len - off);
+        if (w <= 0) break;
+        off += w;
+    }
+}
+
+/* ---- synthetic page (-b) ---- */
+
+static uint32_t bench_next(void) {
+    bench_rng = bench_rng * 1664525u + 1013904223u;
+    return bench_rng >> 8;
+}
+
+static void bench_setup(int tasks) {
+    static const int weights[] = {335, 820, 1024, 1277, 3121, 9548};
+    bench_global = aligned_alloc(64, sizeof(*bench_global));
+    bench_tasks = aligned_alloc(64, (size_t)tasks * sizeof(*bench_tasks));
+    if (!bench_global || !bench_tasks) {
+        perror("malloc");
+        exit(1);
+    }
+    memset(bench_global, 0, sizeof(*bench_global));
+    memset(bench_tasks, 0, (size_t)tasks * sizeof(*bench_tasks));
+    for (int i = 0; i < tasks; i++) {
+        cfs_stats_task_t *t = &bench_tasks[i].data;
+        t->task_id = i;
+        uint32_t r = bench_next();
+        t->state = r % 10 < 6 ? CFS_TASK_READY : r % 10 < 8 ? CFS_TASK_SLEEPING : CFS_TASK_DONE;
+        t->weight = weights[r % 6];
+        t->vruntime_ns = (uint64_t)(r % 100000) * 1000;
+        t->remaining_ms = 1000 + r % 5000;
+    }
+    bench_global->data.num_tasks = tasks;
+    bench_global->data.running_task = -1;
+    global_rec = bench_global;
+    task_recs = bench_tasks;
+    page_tasks = tasks;
+    page_pid = getpid();
+}
+
+// stands in for the dispatcher between frames: one slice per elapsed ms / 10
+static void bench_advance(int ms) {
+    int n = bench_global->data.num_tasks;
+    for (int s = 0; s < ms / 10 + 1; s++) {
+        if (bench_running >= 0) {
+            cfs_stats_task_rec_t *prev = &bench_tasks[bench_running];
+            cfs_stats_write_begin(&prev->seq);
+            prev->data.state = CFS_TASK_READY;
+            cfs_stats_write_end(&prev->seq);
+        }
+        bench_running = bench_next() % n;
+        cfs_stats_task_rec_t *rec = &bench_tasks[bench_running];
+        cfs_stats_write_begin(&rec->seq);
+        rec->data.state = CFS_TASK_RUNNING;
+        rec->data.cpu_ms += 10;
+        rec->data.vruntime_ns += 10000000ULL * 1024 / rec->data.weight;
+        rec->data.wait_p99_ms = bench_next() % 100;
+        rec->data.wait_p50_ms = rec->data.wait_p99_ms / 4;
+        cfs_stats_write_end(&rec->seq);
+
+        cfs_stats_write_begin(&bench_global->seq);
+        bench_global->data.elapsed_ms += 10;
+        bench_global->data.slices++;
+        bench_global->data.dispatches++;
+        bench_global->data.running_task = rec->data.task_id;
+        cfs_stats_write_end(&bench_global->seq);
+    }
+}
+
+/* ---- main loop ---- */
+
+static void print_usage(const char *prog) {
+    fprintf(stderr,
+            "usage: %s [-r hz] [-s key] [-F states] [-n frames] [-b tasks] name\n"
+            "  -r HZ     refresh rate, 1-%d (default %d)\n"
+            "  -s KEY    sort by id, state, vruntime, share, deficit, wait, aging or cpu\n"
+            "            (default share); a leading '-' reverses the order\n"
+            "  -F LIST   show only these states: comma list of wait, ready, run, sleep,\n"
+            "            held, done\n"
+            "  -n N      exit after N frames\n"
+            "  -b N      measure the viewer on a synthetic page of N tasks instead of\n"
+            "            the scheduler's (name is not needed); cost goes to stderr\n"
+            "  name      the scheduler's -K NAME\n",
+            prog, MAX_HZ, DEFAULT_HZ);
+}
+
+static int handle_key(int c, int *hz) {
+    switch (c) {
+    case 'q': stop = 1; return 0;
+    case 's': sort_key = (sort_key + 1) % KEYS; reverse = 0; return 1;
+    case 'r': reverse = !reverse; return 1;
+    case 'p': show_profile = !show_profile; return 1;
+    case 'f': {
+        int f = 0;
+        while (f < FILTERS && filters[f].mask != filter_mask) f++;
+        f = (f + 1) % FILTERS;
+        filter_mask = filters[f].mask;
+        filter_name = filters[f].name;
+        return 1;
+    }
+    case '+': if (*hz < MAX_HZ) (*hz)++; return 0;
+    case '-': if (*hz > 1) (*hz)--; return 0;
+    default: return 0;
+    }
+}
+
+int main(int argc, char **argv) {
+    int opt, hz = DEFAULT_HZ, bench_n = 0;
+    long max_frames = 0;
+    while ((opt = getopt(argc, argv, "r:s:F:n:b:h")) != -1) {
+        switch (opt) {
+        case 'r':
+            hz = atoi(optarg);
+            if (hz < 1 || hz > MAX_HZ) {
+                fprintf(stderr, "refresh rate must be 1-%d\n", MAX_HZ);
+                return 1;
+            }
+            break;
+        case 's': {
+            const char *name = optarg + (optarg[0] == '-');
+            sort_key = -1;
+            for (int k = 0; k < KEYS; k++) {
+                if (strcmp(name, key_names[k]) == 0) sort_key = k;
+            }
+            if (sort_key < 0) {
+                fprintf(stderr, "unknown sort key '%s'\n", name);
+                return 1;
+            }
+            reverse = optarg[0] == '-';
+            break;
+        }
+        case 'F':
+            filter_mask = 0;
+            filter_name = "custom";
+            for (char *name = strtok(optarg, ","); name; name = strtok(NULL, ",")) {
+                int found = 0;
+                for (int s = 1; s < CFS_TASK_STATES; s++) {
+                    if (strcmp(name, cfs_task_state_names[s]) == 0) {
+                        filter_mask |= 1u << s;
+                        found = 1;
+                    }
+                }
+                if (!found) {
+                    fprintf(stderr, "unknown task state '%s'\n", name);
+                    return 1;
+                }
+            }
+            break;
+        case 'n': max_frames = atol(optarg); break;
+        case 'b': bench_n = atoi(optarg); break;
+        default:
+            print_usage(argv[0]);
+            return opt == 'h' ? 0 : 1;
+        }
+    }
+    if (bench_n <= 0 && optind != argc - 1) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    const cfs_stats_page_t *page = NULL;
+    if (bench_n > 0) {
+        bench_setup(bench_n);
+        page_name = "synthetic";
+        if (max_frames == 0) max_frames = BENCH_FRAMES;
+    } else {
+        page_name = argv[optind];
+        page = cfs_stats_open(page_name);
+        if (!page) {
+            fprintf(stderr, "no stats page '%s': %s (start the scheduler with -K %s)\n",
+                    page_name, strerror(errno), page_name);
+            return 1;
+        }
+        global_rec = &page->global;
+        task_recs = page->tasks;
+        profile_rec = &page->profile;
+        page_tasks = page->max_tasks;
+        page_pid = page->pid;
+    }
+
+    rows = calloc(page_tasks, sizeof(row_t));
+    top = calloc(page_tasks, sizeof(int));
+    frame = malloc(FRAME_MAX);
+    if (!rows || !top || !frame) {
+        perror("malloc");
+        return 1;
+    }
+    term_setup();
+
+    double start = now_s(CLOCK_MONOTONIC), next = start, next_scan = start;
+    double cpu_start = now_s(CLOCK_PROCESS_CPUTIME_ID), bench_cpu = 0;
+    long frames = 0, scans = 0;
+    int rescan = 1, exited = 0;
+    while (!stop) {
+        CFS_STATS_READ(global_rec, &global);
+        if (profile_rec) CFS_STATS_READ(profile_rec, &profile);
+        double now = now_s(CLOCK_MONOTONIC);
+        if (rescan || now >= next_scan) {
+            double scan_start = now_s(CLOCK_THREAD_CPUTIME_ID);
+            term_size();
+            read_cpu_times();
+            int capacity = term_rows - HEADER_LINES - (profile_shown() ? PROFILE_LINES : 0);
+            if (capacity < 1) capacity = 1;
+            scan(capacity < page_tasks ? capacity : page_tasks);
+            double cost = now_s(CLOCK_THREAD_CPUTIME_ID) - scan_start;
+            double interval = cost / SCAN_BUDGET > 1.0 / SCAN_HZ ? cost / SCAN_BUDGET : 1.0 / SCAN_HZ;
+            // a frame early is as good as on time
+            next_scan = now + interval - 0.5 / hz;
+            scans++;
+            rescan = 0;
+            if (!bench_n && kill(page_pid, 0) != 0 && errno == ESRCH) exited = 1;
+        } else {
+            refresh_rows();
+        }
+        render(hz);
+        frames++;
+        if (global.finished || exited || (max_frames && frames >= max_frames)) break;
+
+        next += 1.0 / hz;
+        double wait = next - now_s(CLOCK_MONOTONIC);
+        if (wait < 0) next = now_s(CLOCK_MONOTONIC);
+        if (bench_n) {
+            double b0 = now_s(CLOCK_THREAD_CPUTIME_ID);
+            bench_advance(1000 / hz);
+            bench_cpu += now_s(CLOCK_THREAD_CPUTIME_ID) - b0;
+        }
+        struct pollfd pfd = {STDIN_FILENO, POLLIN, 0};
+        if (poll(&pfd, term_raw ? 1 : 0, wait > 0 ? (int)(wait * 1000) : 0) > 0) {
+            char c;
+            while (read(STDIN_FILENO, &c, 1) == 1) rescan |= handle_key(c, &hz);
+        }
+    }
+    if (exited) fprintf(stderr, "scheduler (pid %d) exited\n", (int)page_pid);
+
+    if (bench_n) {
+        double wall = now_s(CLOCK_MONOTONIC) - start;
+        double cpu = now_s(CLOCK_PROCESS_CPUTIME_ID) - cpu_start - bench_cpu;
+        fprintf(stderr, "%d tasks, %ld frames at %d Hz (%ld full scans) in %.2f s: "
+                "%.0f us cpu per frame, %.2f%% of one core\n",
+                bench_n, frames, hz, scans, wall, cpu / frames * 1e6, cpu / wall * 100);
+    }
+    if (page) cfs_stats_close(page);
+    return 0;
+}
@@ -1,15 +1,29 @@
 # cpu scheduling simulation - compares FCFS, SJF, SRTF, Priority, Round Robin, and Heuristic CFS
+#
+# usage: python scheduler_simulation.py [results_dir]
+#        with a directory written by the C scheduler (-o), plots that run instead
 
+import os
+import sys
 import matplotlib.pyplot as plt
 import matplotlib.patches as mpatches
+import matplotlib.colors as mcolors
 from matplotlib.animation import FuncAnimation
+from matplotlib.collections import PolyCollection
 import numpy as np
 from dataclasses import dataclass, field
 from typing import List, Tuple, Optional
 from copy import deepcopy
+from collections import deque
 import random
 import time
 
+try:
+    import pyarrow as pa
+    import pyarrow.ipc
+except ImportError:      # only needed for the columnar export and loading
+    pa = None
+
 
 @dataclass
 class Process:
@@ -33,6 +47,16 @@ class Process:
     aging_boost: int = 0
     last_scheduled: int = 0
 
+    # dag workloads: pids that must finish before this process can run
+    deps: List[int] = field(default_factory=list)
+    # p99 dispatch latency target, 0 = throughput only
+    slo: int = 0
+    # emulated blocking: sleep io_sleep after every io_run units of cpu
+    io_run: int = 0
+    io_sleep: int = 0
+    # cache refill after switching onto a cpu that ran something else, makes no progress
+    warm: int = 0
+
     def __post_init__(self):
         self.remaining_time = self.burst_time
         self.weight = self._nice_to_weight(self.nice_value)
@@ -65,6 +89,20 @@ class GanttEntry:
     pid: int
     start: int
     end: int
+    cpu: int = 0
+
+
+@dataclass
+class DecisionEntry:
+    """one pick: who got a cpu, in what state, for how long"""
+    time: int
+    pid: int
+    vruntime: float
+    runnable: int
+    slice: int
+    ran: int
+    dispatch_wait: int
+    cpu: int = 0
 
 
 @dataclass
@@ -78,13 +116,20 @@ class SchedulerResult:
     throughput: float
     cpu_utilization: float
     total_time: int
+    decisions: List[DecisionEntry] = field(default_factory=list)
+    # set by load_results_arrow: numpy views of the gantt intervals and the
+    # memory-mapped pyarrow tables
+    gantt_columns: Optional[dict] = None
+    tables: Optional[dict] = None
 
 
 class SchedulerBase:
     def __init__(self, name: str):
         self.name = name
         self.current_time = 0
+        self.num_cpus = 1
         self.gantt_chart: List[GanttEntry] = []
+        self.decisions: List[DecisionEntry] = []
 
     def schedule(self, processes: List[Process]) -> SchedulerResult:
         raise NotImplementedError
@@ -105,8 +150,9 @@ class SchedulerBase:
             avg_turnaround_time=total_turnaround / n,
             avg_response_time=total_response / n,
             throughput=n / self.current_time if self.current_time > 0 else 0,
-            cpu_utilization=(total_burst / self.current_time * 100) if self.current_time > 0 else 0,
-            total_time=self.current_time
+            cpu_utilization=(total_burst / (self.current_time * self.num_cpus) * 100) if self.current_time > 0 else 0,
+            total_time=self.current_time,
+            decisions=self.decisions
         )
 
 
@@ -350,16 +396,89 @@ class RoundRobinScheduler(SchedulerBase):
         return self.calculate_metrics(procs)
 
 
+FEATURE_MAX = 4095
+MODEL_FEATURE_NAMES = ['vruntime_delta', 'wait', 'remaining', 'sleep_ratio', 'log2_weight']
+
+
+def clamp_feature(value: int) -> int:
+    return max(0, min(FEATURE_MAX, value))
+
+
+def log2_q4(value: int) -> int:
+    """log2 in 1/16 steps using only the leading bit and the 4 bits after it"""
+    if value <= 0:
+        return 0
+    top = value.bit_length() - 1
+    frac = (value << 4 >> top) & 0xF if top >= 4 else (value << (4 - top)) & 0xF
+    return top * 16 + frac
+
+
 class HeuristicCFSScheduler(SchedulerBase):
     """CFS with heuristic enhancements - aging, interactivity detection, burst estimation"""
 
-    def __init__(self, time_quantum: int = 4):
+    PLACEMENTS = ('legacy', 'debit', 'lag')
+
+    def __init__(self, time_quantum: int = 4, num_cpus: int = 1, critical_path: bool = True,
+                 slo_control: bool = True, placement: str = 'debit', adaptive_quantum: bool = False,
+                 min_granularity: int = 2, switch_cost=0, timer_slack=0, startup: int = 0,
+                 full_slices: bool = False, seed: int = 0):
         super().__init__("Heuristic AI CFS")
+        if placement not in self.PLACEMENTS:
+            raise ValueError(f"unknown placement policy '{placement}'")
         self.time_quantum = time_quantum
+        self.num_cpus = num_cpus
+        self.critical_path = critical_path
+        self.slo_control = slo_control
+        self.placement = placement
+        self.adaptive_quantum = adaptive_quantum
+        self.min_granularity = min_granularity
         self.min_vruntime = 0.0
         self.WEIGHT_NICE_0 = 1024
         self.MAX_WAIT_THRESHOLD = 50
         self.INTERACTIVE_THRESHOLD = 20
+        self.CRITICAL_PATH_BIAS = 5.0    # score bonus per unit of downstream dag path
+        self.upward_rank = {}
+
+        # slo pi controller, mirrors the C scheduler
+        self.SLO_WINDOW = 64
+        self.SLO_CONTROL_PERIOD = 20
+        self.SLO_KP = 0.02               # weight change per unit of p99 error
+        self.SLO_KI = 0.004
+        self.SLO_INTEGRAL_LIMIT = 200
+        self.SLO_MAX_STEP = 0.25
+        self.latency_samples = {}        # pid -> every dispatch latency (for reporting)
+
+        # placement, mirrors the C scheduler
+        self.SLEEPER_CREDIT = self.time_quantum      # half the sched latency of two quanta
+        self.lag = {}
+        self.ready_since = {}            # pid -> when it last became runnable
+        self.slept = {}                  # pid -> total emulated i/o time
+
+        # per-task quantum bandit, mirrors the C scheduler (quanta at 1/2, 1, 2, 4x)
+        self.QUANTUM_ARMS = [max(1, time_quantum * m // 2) for m in (1, 2, 4, 8)]
+        self.BANDIT_EXPLORE = 0.3
+        self.BANDIT_LATENCY_COST = 1.0   # reward lost per sched latency a sensitive task waits
+        self.SCHED_LATENCY = 2 * time_quantum
+        self.bandit = {}                 # pid -> (pulls, values), each [context][arm]
+        self.arm_pulls = {}              # pid -> pulls per arm over both contexts (reporting)
+
+        # overheads of the live scheduler, zero by default (calibrate.py fits them).
+        # each is a constant or a list of samples drawn uniformly, i.e. an
+        # empirical distribution: switch_cost is the dispatcher time between
+        # slices when a cpu changes task, timer_slack how far a slice overruns.
+        # startup delays the first pick (the live scheduler forks first) and
+        # full_slices runs every slice to its end like the live dispatcher,
+        # which sleeps through it instead of stopping at an arrival or exit
+        self.switch_cost = switch_cost
+        self.timer_slack = timer_slack
+        self.startup = startup
+        self.full_slices = full_slices
+        self.seed = seed
+
+    def _overhead(self, model) -> int:
+        if isinstance(model, (list, tuple)):
+            return self.overhead_rng.choice(model) if model else 0
+        return model
 
     def _compute_heuristic_metrics(self, proc: Process, current_time: int):
         # aging boost for starvation prevention
@@ -375,96 +494,675 @@ class HeuristicCFSScheduler(SchedulerBase):
         delta_vruntime = (executed_time * self.WEIGHT_NICE_0) / proc.weight
         proc.vruntime += delta_vruntime
 
-    def _select_next_process(self, available: List[Process], current_time: int) -> Optional[Process]:
-        if not available:
-            return None
+    @staticmethod
+    def _percentile(samples, pct: int) -> float:
+        if not samples:
+            return 0
+        ordered = sorted(samples)
+        rank = max(1, -(-len(ordered) * pct // 100))
+        return ordered[rank - 1]
+
+    def _slo_control_step(self, proc: Process, window, integral: dict):
+        # raise weight while p99 misses the target, give it back once met
+        error = self._percentile(window, 99) - proc.slo
+        integral[proc.pid] = max(-self.SLO_INTEGRAL_LIMIT,
+                                 min(self.SLO_INTEGRAL_LIMIT, integral[proc.pid] + error))
+        step = self.SLO_KP * error + self.SLO_KI * integral[proc.pid]
+        step = max(-self.SLO_MAX_STEP, min(self.SLO_MAX_STEP, step))
+        base = Process._nice_to_weight(proc.nice_value)
+        proc.weight = max(base, min(Process._nice_to_weight(-20), proc.weight * (1 + step)))
+
+    def _vslice(self, proc: Process) -> float:
+        return self.time_quantum * self.WEIGHT_NICE_0 / proc.weight
 
-        best_proc = None
-        best_score = float('inf')
+    @staticmethod
+    def _avg_vruntime(queued: List[Process], default: float) -> float:
+        total_weight = sum(p.weight for p in queued)
+        if total_weight == 0:
+            return default
+        return sum(p.vruntime * p.weight for p in queued) / total_weight
+
+    def _place(self, proc: Process, queued: List[Process], wakeup: bool):
+        # legacy: new at min_vruntime, sleepers untouched
+        # debit: new one slice behind min_vruntime, sleepers get bounded credit
+        # lag: new at the weighted average, sleepers keep their lag (clamped)
+        if self.placement == 'legacy':
+            if not wakeup:
+                proc.vruntime = self.min_vruntime
+        elif self.placement == 'debit':
+            if wakeup:
+                proc.vruntime = max(proc.vruntime, self.min_vruntime - self.SLEEPER_CREDIT)
+            else:
+                proc.vruntime = self.min_vruntime + self._vslice(proc)
+        else:
+            limit = 2 * self._vslice(proc)
+            lag = max(-limit, min(limit, self.lag.get(proc.pid, 0))) if wakeup else 0
+            proc.vruntime = self._avg_vruntime(queued, self.min_vruntime) - lag
 
+    @staticmethod
+    def _latency_sensitive(proc: Process) -> bool:
+        return proc.slo > 0 or proc.io_run > 0
+
+    def _bandit_pick(self, pid: int, context: int) -> int:
+        """ucb1 over the quantum arms; untried arms first"""
+        pulls, values = self.bandit.setdefault(
+            pid, ([[0] * len(self.QUANTUM_ARMS) for _ in range(2)],
+                  [[0.0] * len(self.QUANTUM_ARMS) for _ in range(2)]))
+        total = sum(pulls[context])
+        best, best_bound = 0, float('-inf')
+        for arm, n in enumerate(pulls[context]):
+            if n == 0:
+                return arm
+            bound = values[context][arm] + self.BANDIT_EXPLORE * np.sqrt(np.log(total) / n)
+            if bound > best_bound:
+                best, best_bound = arm, bound
+        return best
+
+    def _bandit_update(self, pid: int, context: int, arm: int, reward: float):
+        pulls, values = self.bandit[pid]
+        pulls[context][arm] += 1
+        values[context][arm] += (reward - values[context][arm]) / pulls[context][arm]
+        self.arm_pulls.setdefault(pid, [0] * len(self.QUANTUM_ARMS))[arm] += 1
+
+    def _features(self, proc: Process) -> List[int]:
+        """integer features shared with the learned model in the C scheduler"""
+        lifetime = max(1, self.current_time - proc.arrival_time)
+        return [
+            clamp_feature(int(proc.vruntime - self.min_vruntime)),
+            clamp_feature(self.current_time - self.ready_since.get(proc.pid, proc.arrival_time)),
+            clamp_feature(proc.remaining_time),
+            clamp_feature(self.slept.get(proc.pid, 0) * 1000 // lifetime),
+            log2_q4(int(proc.weight)),
+        ]
+
+    def _compute_upward_ranks(self, procs: List[Process], children: dict):
+        # longest path from each process to a sink, parents listed before children
+        self.upward_rank = {}
+        for proc in sorted(procs, key=lambda p: p.pid, reverse=True):
+            longest = max((self.upward_rank[c.pid] for c in children[proc.pid]), default=0)
+            self.upward_rank[proc.pid] = proc.burst_time + longest
+
+    def _score(self, proc: Process) -> float:
+        score = proc.vruntime
+        score -= proc.aging_boost * 100          # aging bonus
+        if proc.remaining_time < self.INTERACTIVE_THRESHOLD:
+            score -= 50                          # interactive bonus
+        if proc.remaining_time > 50:
+            score += 10                          # long process penalty
+        if self.critical_path:
+            downstream = self.upward_rank.get(proc.pid, proc.burst_time) - proc.burst_time
+            score -= downstream * self.CRITICAL_PATH_BIAS
+        return score
+
+    def _select_processes(self, available: List[Process], current_time: int, count: int) -> List[Process]:
         for proc in available:
             self._compute_heuristic_metrics(proc, current_time)
+        return sorted(available, key=self._score)[:count]
 
-            score = proc.vruntime
-            score -= proc.aging_boost * 100          # aging bonus
-            if proc.remaining_time < self.INTERACTIVE_THRESHOLD:
-                score -= 50                          # interactive bonus
-            if proc.remaining_time > 50:
-                score += 10                          # long process penalty
-
-            if score < best_score:
-                best_score = score
-                best_proc = proc
-
-        return best_proc
+    def _select_next_process(self, available: List[Process], current_time: int) -> Optional[Process]:
+        if not available:
+            return None
+        return self._select_processes(available, current_time, 1)[0]
 
     def schedule(self, processes: List[Process]) -> SchedulerResult:
         procs = deepcopy(processes)
+        children = {p.pid: [] for p in procs}
+        pending = {}
+        for p in procs:
+            pending[p.pid] = len(p.deps)
+            for parent in p.deps:
+                children[parent].append(p)
+        self._compute_upward_ranks(procs, children)
 
         for p in procs:
-            p.vruntime = self.min_vruntime
+            p.vruntime = 0.0
             p.last_scheduled = p.arrival_time
 
-        self.current_time = 0
+        self.ready_since = {p.pid: p.arrival_time for p in procs}
+        windows = {p.pid: deque(maxlen=self.SLO_WINDOW) for p in procs}
+        integral = {p.pid: 0 for p in procs}
+        self.latency_samples = {p.pid: [] for p in procs}
+        last_control = 0
+
+        self.min_vruntime = 0.0
+        self.lag = {}
+        queued = {}                      # pid -> process on the run queue
+        arrived = set()
+        sleep_until = {}                 # pid -> wake time of blocked processes
+        ran_since_wake = {p.pid: 0 for p in procs}
+        self.slept = {p.pid: 0 for p in procs}
+        self.bandit = {}
+        self.arm_pulls = {}
+        warm_left = {}                   # pid -> cache refill still owed this slice
+        cpu_cache = [None] * self.num_cpus     # pid whose working set each cpu holds
+        sensitive = [p for p in procs if self._latency_sensitive(p)]
+
+        self.current_time = self.startup
         self.gantt_chart = []
+        self.decisions = []
+        self.overhead_rng = random.Random(self.seed)
         completed = 0
         n = len(procs)
-        last_proc_pid = None
-        last_start = 0
+        cpu_pid = [None] * self.num_cpus
+        cpu_start = [0] * self.num_cpus
 
         while completed < n:
-            available = [p for p in procs
-                        if p.arrival_time <= self.current_time and p.remaining_time > 0]
+            if self.slo_control and self.current_time - last_control >= self.SLO_CONTROL_PERIOD:
+                last_control = self.current_time
+                for p in procs:
+                    if p.slo > 0 and p.remaining_time > 0 and windows[p.pid]:
+                        self._slo_control_step(p, windows[p.pid], integral)
+
+            # wake sleepers, then enqueue processes that arrived and are released
+            for pid, wake in list(sleep_until.items()):
+                if wake <= self.current_time:
+                    del sleep_until[pid]
+                    proc = next(p for p in procs if p.pid == pid)
+                    proc.last_scheduled = self.current_time
+                    self.ready_since[pid] = self.current_time
+                    self._place(proc, list(queued.values()), wakeup=True)
+                    queued[pid] = proc
+            for p in procs:
+                if (p.pid not in arrived and p.arrival_time <= self.current_time
+                        and pending[p.pid] == 0):
+                    arrived.add(p.pid)
+                    self._place(p, list(queued.values()), wakeup=False)
+                    queued[p.pid] = p
+
+            available = list(queued.values())
 
             if not available:
-                next_arrival = min(p.arrival_time for p in procs if p.remaining_time > 0)
-                self.current_time = next_arrival
+                future = [p.arrival_time for p in procs
+                          if p.remaining_time > 0 and p.arrival_time > self.current_time]
+                future += list(sleep_until.values())
+                if not future:
+                    raise ValueError("dependency cycle: no runnable process left")
+                self.current_time = min(future)
                 continue
 
-            current_proc = self._select_next_process(available, self.current_time)
+            chosen = self._select_processes(available, self.current_time, self.num_cpus)
 
-            if current_proc.response_time == -1:
-                current_proc.response_time = self.current_time - current_proc.arrival_time
-                current_proc.start_time = self.current_time
+            # keep processes on the cpu they already occupy, fill the rest in order
+            assignment = [None] * self.num_cpus
+            unplaced = []
+            for proc in chosen:
+                if proc.pid in cpu_pid:
+                    assignment[cpu_pid.index(proc.pid)] = proc
+                else:
+                    unplaced.append(proc)
+            for cpu in range(self.num_cpus):
+                if assignment[cpu] is None and unplaced:
+                    assignment[cpu] = unplaced.pop(0)
 
-            # time slice from weight
-            time_slice = max(2, (self.time_quantum * self.WEIGHT_NICE_0) // current_proc.weight)
+            # the dispatcher's own time: nobody runs while it stops one task and starts the next
+            switching = any(proc is not None and proc.pid != cpu_pid[cpu] for cpu, proc in enumerate(assignment))
+            start = self.current_time + (self._overhead(self.switch_cost) if switching else 0)
 
             next_arrival = float('inf')
             for p in procs:
                 if p.arrival_time > self.current_time and p.remaining_time > 0:
                     next_arrival = min(next_arrival, p.arrival_time)
+            next_arrival = min([next_arrival] + list(sleep_until.values()))
+
+            for cpu in range(self.num_cpus):
+                proc = assignment[cpu]
+                if proc is not None and cpu_cache[cpu] != proc.pid:
+                    warm_left[proc.pid] = proc.warm
+
+            # context: is anyone latency sensitive still around to be delayed
+            arms = {}
+            if self.adaptive_quantum:
+                for proc in chosen:
+                    context = int(any(p is not proc and p.remaining_time > 0 for p in sensitive))
+                    arms[proc.pid] = (context, self._bandit_pick(proc.pid, context))
+
+            exec_time = None
+            picks = []
+            for proc in chosen:
+                if proc.response_time == -1:
+                    proc.response_time = self.current_time - proc.arrival_time
+                    proc.start_time = self.current_time
+
+                latency = max(0, self.current_time - self.ready_since[proc.pid])
+                windows[proc.pid].append(latency)
+                self.latency_samples[proc.pid].append(latency)
+
+                # time slice from weight
+                quantum = self.QUANTUM_ARMS[arms[proc.pid][1]] if proc.pid in arms else self.time_quantum
+                time_slice = max(self.min_granularity, (quantum * self.WEIGHT_NICE_0) // proc.weight)
+                owed = warm_left.get(proc.pid, 0)
+                if proc.io_run > 0:
+                    time_slice = min(time_slice, owed + proc.io_run - ran_since_wake[proc.pid])
+                run = time_slice if self.full_slices else min(
+                    time_slice, proc.remaining_time + owed,
+                    int(next_arrival - start) if next_arrival != float('inf') else time_slice)
+                exec_time = run if exec_time is None else min(exec_time, run)
+                picks.append((proc, proc.vruntime, time_slice, latency))
+            exec_time = max(1, exec_time) + self._overhead(self.timer_slack)
+            for proc, vruntime, time_slice, latency in picks:
+                self.decisions.append(DecisionEntry(start, proc.pid, vruntime, len(available),
+                                                    time_slice, exec_time, latency, assignment.index(proc)))
+
+            for cpu in range(self.num_cpus):
+                proc = assignment[cpu]
+                pid = proc.pid if proc else None
+                if cpu_pid[cpu] != pid:
+                    if cpu_pid[cpu] is not None and cpu_start[cpu] < self.current_time:
+                        self.gantt_chart.append(GanttEntry(cpu_pid[cpu], cpu_start[cpu], self.current_time, cpu))
+                    cpu_pid[cpu] = pid
+                    cpu_start[cpu] = start
+
+            self.current_time = start + exec_time
+            for cpu in range(self.num_cpus):
+                if assignment[cpu] is not None:
+                    cpu_cache[cpu] = assignment[cpu].pid
+            for proc in chosen:
+                owed = warm_left.get(proc.pid, 0)
+                progress = min(max(0, exec_time - owed), proc.remaining_time)
+                warm_left[proc.pid] = max(0, owed - exec_time)
+                proc.remaining_time -= progress
+                self._update_vruntime(proc, exec_time)
+                self.ready_since[proc.pid] = self.current_time
+                ran_since_wake[proc.pid] += progress
+
+                if proc.pid in arms:
+                    # progress per unit of cpu, minus what the slice cost waiting sensitive tasks
+                    delayed = sum(min(exec_time, self.current_time - self.ready_since[p.pid])
+                                  for p in sensitive if p.pid in queued and p not in chosen)
+                    reward = progress / exec_time - self.BANDIT_LATENCY_COST * delayed / self.SCHED_LATENCY
+                    self._bandit_update(proc.pid, *arms[proc.pid], reward)
+
+            # min_vruntime only moves forward
+            if queued:
+                self.min_vruntime = max(self.min_vruntime, min(p.vruntime for p in queued.values()))
+
+            for cpu in range(self.num_cpus):
+                proc = assignment[cpu]
+                if proc is None:
+                    continue
+
+                if proc.remaining_time > 0:
+                    if proc.io_run > 0 and ran_since_wake[proc.pid] >= proc.io_run:
+                        # blocks on emulated i/o, remembering its lag
+                        self.lag[proc.pid] = self._avg_vruntime(list(queued.values()), self.min_vruntime) - proc.vruntime
+                        del queued[proc.pid]
+                        sleep_until[proc.pid] = self.current_time + proc.io_sleep
+                        self.slept[proc.pid] += proc.io_sleep
+                        ran_since_wake[proc.pid] = 0
+                        if cpu_start[cpu] < self.current_time:
+                            self.gantt_chart.append(GanttEntry(proc.pid, cpu_start[cpu], self.current_time, cpu))
+                        cpu_pid[cpu] = None
+                    continue
+
+                del queued[proc.pid]
+                proc.finish_time = self.current_time
+                proc.turnaround_time = proc.finish_time - proc.arrival_time
+                proc.waiting_time = proc.turnaround_time - proc.burst_time - self.slept[proc.pid]
+                completed += 1
+                if cpu_start[cpu] < self.current_time:
+                    self.gantt_chart.append(GanttEntry(proc.pid, cpu_start[cpu], self.current_time, cpu))
+                cpu_pid[cpu] = None
 
-            exec_time = min(time_slice, current_proc.remaining_time,
-                           int(next_arrival - self.current_time) if next_arrival != float('inf') else time_slice)
-            exec_time = max(1, exec_time)
+                # release children whose last parent just finished
+                for child in children[proc.pid]:
+                    pending[child.pid] -= 1
+                    if pending[child.pid] == 0:
+                        child.last_scheduled = max(child.arrival_time, self.current_time)
+                        self.ready_since[child.pid] = child.last_scheduled
 
-            if last_proc_pid != current_proc.pid:
-                if last_proc_pid is not None and last_start < self.current_time:
-                    self.gantt_chart.append(GanttEntry(last_proc_pid, last_start, self.current_time))
-                last_proc_pid = current_proc.pid
-                last_start = self.current_time
+        return self.calculate_metrics(procs)
 
-            self.current_time += exec_time
-            current_proc.remaining_time -= exec_time
-            self._update_vruntime(current_proc, exec_time)
 
-            active_vruntimes = [p.vruntime for p in procs if p.remaining_time > 0]
-            if active_vruntimes:
-                self.min_vruntime = min(active_vruntimes)
+class LearnedCFSScheduler(HeuristicCFSScheduler):
+    """CFS where the hand-written score is replaced by a linear model over
+    integer features, trained offline (train_model.py) and exported to cfs_model.h"""
 
-            if current_proc.remaining_time == 0:
-                current_proc.finish_time = self.current_time
-                current_proc.turnaround_time = current_proc.finish_time - current_proc.arrival_time
-                current_proc.waiting_time = current_proc.turnaround_time - current_proc.burst_time
+    def __init__(self, weights: List[int] = None, model_path: str = "cfs_model.h", **kwargs):
+        super().__init__(**kwargs)
+        self.name = "Learned CFS"
+        self.model_weights = weights if weights is not None else load_model_header(model_path)
+
+    def _score(self, proc: Process) -> float:
+        return sum(w * f for w, f in zip(self.model_weights, self._features(proc)))
+
+
+class AdaptivePolicyScheduler(SchedulerBase):
+    """meta-scheduler: classifies the workload regime over a sliding window
+    (arrival rate, burst-size variance, interactive fraction) and hot-switches
+    between registered policies. with `policy` set it runs that one policy in
+    the same loop, so fixed and adaptive runs are directly comparable"""
+
+    POLICIES = {
+        'srtf': lambda p, s: (p.remaining_time, p.pid),
+        'rr':   lambda p, s: (s.ready_since[p.pid], p.pid),
+        'cfs':  lambda p, s: (p.vruntime, p.pid),
+    }
+    PREEMPTIVE = {'srtf'}            # re-pick at every event, not just at slice end
+
+    def __init__(self, time_quantum: int = 4, policy: Optional[str] = None,
+                 window: int = 100, period: int = 10, hold: int = 2):
+        super().__init__(f"Adaptive ({policy})" if policy else "Adaptive Meta-Scheduler")
+        if policy is not None and policy not in self.POLICIES:
+            raise ValueError(f"unknown policy '{policy}'")
+        self.time_quantum = time_quantum
+        self.fixed_policy = policy
+        self.WINDOW = window             # regime features look this far back
+        self.PERIOD = period             # classify this often
+        self.HOLD = hold                 # consecutive votes needed to switch
+        self.INTERACTIVE_FRACTION = 0.4
+        self.SIZE_CV = 0.75
+        self.MIN_ARRIVALS = 2
+        self.SCHED_LATENCY = 2 * time_quantum
+        self.switches = []               # (time, policy)
+
+    def _regime(self, alive: List[Process], recent: List[Process]) -> Tuple[float, float, float]:
+        """arrival rate (per quantum), burst-size cv and interactive fraction"""
+        rate = len(recent) * self.time_quantum / self.WINDOW
+        sizes = [p.burst_time for p in recent if p.io_run == 0]
+        cv = float(np.std(sizes) / np.mean(sizes)) if len(sizes) >= 2 else 0.0
+        interactive = sum(1 for p in alive if p.io_run > 0) / len(alive) if alive else 0.0
+        return rate, cv, interactive
+
+    def _classify(self, alive: List[Process], recent: List[Process]) -> str:
+        rate, cv, interactive = self._regime(alive, recent)
+        if interactive >= self.INTERACTIVE_FRACTION:
+            return 'rr'                  # response time matters most
+        if len(recent) >= self.MIN_ARRIVALS and cv >= self.SIZE_CV:
+            return 'srtf'                # mixed known sizes: shortest first cuts wait
+        return 'cfs'                     # similar sizes: plain fairness
+
+    def _migrate(self, queued: List[Process], policy: str):
+        # vruntime kept ticking under every policy; bound the lag it built up
+        # so a task starved by srtf can't monopolize the cpu under cfs
+        if policy == 'cfs' and queued:
+            avg = sum(p.vruntime for p in queued) / len(queued)
+            for p in queued:
+                p.vruntime = max(avg - self.SCHED_LATENCY, min(avg + self.SCHED_LATENCY, p.vruntime))
+
+    def schedule(self, processes: List[Process]) -> SchedulerResult:
+        procs = deepcopy(processes)
+        for p in procs:
+            p.vruntime = 0.0
+
+        self.current_time = 0
+        self.gantt_chart = []
+        self.switches = []
+        self.ready_since = {}
+        policy = self.fixed_policy or 'cfs'
+        self.switches.append((0, policy))
+        pending, votes = None, 0
+        last_classify = -self.PERIOD
+
+        queued = {}
+        sleep_until = {}
+        slept = {p.pid: 0 for p in procs}
+        ran_since_wake = {p.pid: 0 for p in procs}
+        arrivals = []                    # processes in arrival order
+        admitted = set()
+        current, slice_left = None, 0
+        completed, n = 0, len(procs)
+
+        while completed < n:
+            t = self.current_time
+            for pid, wake in list(sleep_until.items()):
+                if wake <= t:
+                    del sleep_until[pid]
+                    queued[pid] = next(p for p in procs if p.pid == pid)
+                    self.ready_since[pid] = wake
+            for p in procs:
+                if p.pid not in admitted and p.arrival_time <= t:
+                    admitted.add(p.pid)
+                    arrivals.append(p)
+                    if queued:
+                        p.vruntime = min(q.vruntime for q in queued.values())
+                    queued[p.pid] = p
+                    self.ready_since[p.pid] = p.arrival_time
+
+            if self.fixed_policy is None and t - last_classify >= self.PERIOD:
+                last_classify = t
+                alive = [p for p in procs if p.pid in admitted and p.remaining_time > 0]
+                recent = [p for p in arrivals if p.arrival_time > t - self.WINDOW]
+                vote = self._classify(alive, recent)
+                if vote == policy:
+                    pending, votes = None, 0
+                else:
+                    votes = votes + 1 if vote == pending else 1
+                    pending = vote
+                    if votes >= self.HOLD:
+                        policy, pending, votes = vote, None, 0
+                        self._migrate(list(queued.values()), policy)
+                        self.switches.append((t, policy))
+                        slice_left = 0
+
+            future = [p.arrival_time for p in procs if p.pid not in admitted]
+            future += list(sleep_until.values())
+            next_event = min(future) if future else float('inf')
+
+            if not queued:
+                self.current_time = next_event
+                current = None
+                continue
+
+            if current not in queued or slice_left <= 0 or policy in self.PREEMPTIVE:
+                key = self.POLICIES[policy]
+                pick = min(queued.values(), key=lambda p: key(p, self))
+                if pick.pid != current or slice_left <= 0:
+                    slice_left = self.time_quantum
+                current = pick.pid
+            proc = queued[current]
+
+            if proc.response_time == -1:
+                proc.response_time = t - proc.arrival_time
+                proc.start_time = t
+
+            run = min(slice_left, proc.remaining_time)
+            if proc.io_run > 0:
+                run = min(run, proc.io_run - ran_since_wake[proc.pid])
+            if next_event != float('inf'):
+                run = min(run, max(1, int(next_event - t)))
+            if self.fixed_policy is None:
+                run = min(run, max(1, last_classify + self.PERIOD - t))
+
+            if self.gantt_chart and self.gantt_chart[-1].pid == proc.pid and self.gantt_chart[-1].end == t:
+                self.gantt_chart[-1].end = t + run
+            else:
+                self.gantt_chart.append(GanttEntry(proc.pid, t, t + run))
+
+            self.current_time = t + run
+            proc.remaining_time -= run
+            proc.vruntime += run * 1024 / proc.weight
+            ran_since_wake[proc.pid] += run
+            slice_left -= run
+
+            if proc.remaining_time == 0:
+                del queued[proc.pid]
+                proc.finish_time = self.current_time
+                proc.turnaround_time = proc.finish_time - proc.arrival_time
+                proc.waiting_time = proc.turnaround_time - proc.burst_time - slept[proc.pid]
                 completed += 1
-                if last_start < self.current_time:
-                    self.gantt_chart.append(GanttEntry(current_proc.pid, last_start, self.current_time))
-                last_proc_pid = None
+                current = None
+            elif proc.io_run > 0 and ran_since_wake[proc.pid] >= proc.io_run:
+                del queued[proc.pid]
+                sleep_until[proc.pid] = self.current_time + proc.io_sleep
+                slept[proc.pid] += proc.io_sleep
+                ran_since_wake[proc.pid] = 0
+                current = None
+            elif slice_left <= 0:
+                self.ready_since[proc.pid] = self.current_time
 
         return self.calculate_metrics(procs)
 
 
+def load_model_header(path: str) -> List[int]:
+    """pulls the weight table out of the generated C header"""
+    with open(path) as f:
+        text = f.read()
+    start = text.index('model_weights[MODEL_FEATURES] = {') + len('model_weights[MODEL_FEATURES] = {')
+    return [int(w) for w in text[start:text.index('}', start)].split(',') if w.strip()]
+
+
+# columnar results: arrow ipc (or parquet) tables shared with the C scheduler
+# (-o) and trace_analyzer (-a). tasks, gantt and decisions use the same column
+# names on both sides; times are ms from C and ticks from the simulator, as
+# the time_unit schema metadata says. int32 code columns name their values
+# in a "<column>.names" metadata entry
+
+GANTT_ENTRY_LIMIT = 100000      # loaded intervals are also built as GanttEntry up to this many
+
+
+def _require_pyarrow():
+    if pa is None:
+        raise ImportError("columnar results need pyarrow (pip install -r requirements.txt)")
+
+
+def _write_table(table, path: str, fmt: str):
+    if fmt == 'arrow':
+        with pa.OSFile(path, 'wb') as sink, pa.ipc.new_file(sink, table.schema) as writer:
+            writer.write_table(table)
+    elif fmt == 'parquet':
+        import pyarrow.parquet as pq
+        pq.write_table(table, path)
+    else:
+        raise ValueError(f"unknown columnar format '{fmt}'")
+
+
+def export_results_arrow(result: SchedulerResult, directory: str, fmt: str = 'arrow'):
+    """writes tasks, gantt and decisions of a run as <directory>/<table>.arrow
+    (or .parquet). a loaded result is written back with its tables as they
+    are, which also converts C results to parquet"""
+    _require_pyarrow()
+    os.makedirs(directory, exist_ok=True)
+    tables = result.tables
+    if tables is None:
+        procs = result.processes
+        num_cpus = max((e.cpu for e in result.gantt_chart), default=0) + 1
+        meta = {'producer': 'scheduler_simulation', 'time_unit': 'tick', 'vruntime_unit': 'tick'}
+        tables = {
+            'tasks': pa.table({
+                'task': pa.array([p.pid for p in procs], pa.int32()),
+                'nice': pa.array([p.nice_value for p in procs], pa.int32()),
+                'weight': pa.array([p.weight for p in procs], pa.int32()),
+                'priority': pa.array([p.priority for p in procs], pa.int32()),
+                'arrival': pa.array([p.arrival_time for p in procs], pa.int64()),
+                'burst': pa.array([p.burst_time for p in procs], pa.int64()),
+                'start': pa.array([p.start_time for p in procs], pa.int64()),
+                'finish': pa.array([p.finish_time for p in procs], pa.int64()),
+                'response': pa.array([p.response_time for p in procs], pa.int64()),
+                'turnaround': pa.array([p.turnaround_time for p in procs], pa.int64()),
+                'wait': pa.array([p.waiting_time for p in procs], pa.int64()),
+                'vruntime': pa.array([p.vruntime for p in procs], pa.float64()),
+            }, metadata=dict(meta, name=result.name, total_time=str(result.total_time), num_cpus=str(num_cpus))),
+            'gantt': pa.table({
+                'task': pa.array([e.pid for e in result.gantt_chart], pa.int32()),
+                'start': pa.array([e.start for e in result.gantt_chart], pa.int64()),
+                'end': pa.array([e.end for e in result.gantt_chart], pa.int64()),
+                'cpu': pa.array([e.cpu for e in result.gantt_chart], pa.int32()),
+            }, metadata=meta),
+            'decisions': pa.table({
+                'time': pa.array([d.time for d in result.decisions], pa.int64()),
+                'task': pa.array([d.pid for d in result.decisions], pa.int32()),
+                'vruntime': pa.array([d.vruntime for d in result.decisions], pa.float64()),
+                'runnable': pa.array([d.runnable for d in result.decisions], pa.int32()),
+                'slice': pa.array([d.slice for d in result.decisions], pa.int32()),
+                'ran': pa.array([d.ran for d in result.decisions], pa.int64()),
+                'dispatch_wait': pa.array([d.dispatch_wait for d in result.decisions], pa.int64()),
+                'cpu': pa.array([d.cpu for d in result.decisions], pa.int32()),
+            }, metadata=meta),
+        }
+    for name, table in tables.items():
+        _write_table(table, os.path.join(directory, f'{name}.{fmt}'), fmt)
+
+
+def read_arrow_table(path: str):
+    """memory-maps an arrow ipc file into a pyarrow Table without copying (a
+    .parquet file is read instead). code columns become dictionary columns
+    over the same index buffers"""
+    _require_pyarrow()
+    if path.endswith('.parquet'):
+        import pyarrow.parquet as pq
+        table = pq.read_table(path, memory_map=True)
+    else:
+        table = pa.ipc.open_file(pa.memory_map(path, 'r')).read_all()
+    for key, value in (table.schema.metadata or {}).items():
+        column = key.decode()[:-len('.names')]
+        if not key.endswith(b'.names') or column not in table.column_names:
+            continue
+        codes = table.column(column)
+        if not pa.types.is_integer(codes.type):
+            continue
+        dictionary = pa.array(value.decode().split(','))
+        chunks = [pa.DictionaryArray.from_arrays(c, dictionary) for c in codes.chunks]
+        table = table.set_column(table.column_names.index(column), column,
+                                 pa.chunked_array(chunks, pa.dictionary(codes.type, pa.string())))
+    return table
+
+
+def _column_view(table, name: str) -> np.ndarray:
+    """numpy view of a column; only a column split over several batches is copied"""
+    column = table.column(name)
+    if column.num_chunks == 1:
+        return column.chunk(0).to_numpy(zero_copy_only=True)
+    return column.to_numpy()
+
+
+def load_results_arrow(directory: str) -> SchedulerResult:
+    """a run written by the C scheduler (-o) or export_results_arrow() as a
+    SchedulerResult. the tables stay memory-mapped and gantt_columns are views
+    of them, so loading costs the same for millions of rows as for ten"""
+    _require_pyarrow()
+    tables = {}
+    for name in ('tasks', 'gantt', 'decisions'):
+        for fmt in ('arrow', 'parquet'):
+            path = os.path.join(directory, f'{name}.{fmt}')
+            if os.path.exists(path):
+                tables[name] = read_arrow_table(path)
+                break
+    if 'tasks' not in tables or 'gantt' not in tables:
+        raise FileNotFoundError(f"no tasks and gantt tables in {directory}")
+
+    tasks = tables['tasks']
+    meta = {k.decode(): v.decode() for k, v in (tasks.schema.metadata or {}).items()}
+    processes = []
+    for row in tasks.to_pylist():
+        proc = Process(pid=row['task'], arrival_time=row['arrival'], burst_time=row['burst'],
+                       priority=row.get('priority', 0), nice_value=row.get('nice', 0))
+        proc.remaining_time = 0
+        proc.weight = row['weight']
+        proc.start_time = row['start']
+        proc.finish_time = row['finish']
+        proc.response_time = row['response']
+        proc.turnaround_time = row['turnaround']
+        proc.waiting_time = row['wait']
+        proc.vruntime = row['vruntime']
+        processes.append(proc)
+
+    gantt = tables['gantt']
+    columns = {'pid': _column_view(gantt, 'task'), 'start': _column_view(gantt, 'start'),
+               'end': _column_view(gantt, 'end'), 'cpu': _column_view(gantt, 'cpu')}
+    entries = []
+    if gantt.num_rows <= GANTT_ENTRY_LIMIT:
+        entries = [GanttEntry(*row) for row in zip(*(columns[k].tolist() for k in ('pid', 'start', 'end', 'cpu')))]
+
+    n = max(1, len(processes))
+    response = _column_view(tasks, 'response')
+    total_time = int(meta.get('total_time', max((p.finish_time for p in processes), default=0)))
+    num_cpus = int(meta.get('num_cpus', 1))
+    return SchedulerResult(
+        name=meta.get('name', directory),
+        gantt_chart=entries,
+        processes=processes,
+        avg_waiting_time=float(_column_view(tasks, 'wait').sum()) / n,
+        avg_turnaround_time=float(_column_view(tasks, 'turnaround').sum()) / n,
+        avg_response_time=float(response[response >= 0].sum()) / n,
+        throughput=len(processes) / total_time if total_time > 0 else 0,
+        cpu_utilization=(float(_column_view(tasks, 'burst').sum()) / (total_time * num_cpus) * 100)
+        if total_time > 0 else 0,
+        total_time=total_time,
+        gantt_columns=columns,
+        tables=tables
+    )
+
+
 # visualization stuff
 
 class SchedulerVisualizer:
@@ -474,16 +1172,57 @@ class SchedulerVisualizer:
         '#F8B500', '#00CED1', '#FF69B4', '#32CD32', '#FFD700'
     ]
 
+    GANTT_RASTER_LIMIT = 20000       # columnar charts with more intervals are drawn as an image
+    GANTT_RASTER_COLUMNS = 4000
+
     def __init__(self, results: List[SchedulerResult]):
         self.results = results
         self.process_colors = {}
         all_pids = set()
         for result in results:
+            if result.gantt_columns is not None:
+                all_pids.update(np.unique(result.gantt_columns['pid']).tolist())
+                continue
             for entry in result.gantt_chart:
                 all_pids.add(entry.pid)
         for i, pid in enumerate(sorted(all_pids)):
             self.process_colors[pid] = self.COLORS[i % len(self.COLORS)]
 
+    def _draw_gantt_columns(self, ax, columns: dict, y_pos: float, height: float):
+        """one PolyCollection per process instead of a patch per interval. past
+        GANTT_RASTER_LIMIT intervals most are narrower than a pixel: the chart
+        becomes one image row, colored by the interval covering each column"""
+        pids, start, end = columns['pid'], columns['start'], columns['end']
+        if len(pids) > self.GANTT_RASTER_LIMIT:
+            if np.any(start[1:] < start[:-1]):
+                order = np.argsort(start, kind='stable')
+                pids, start, end = pids[order], start[order], end[order]
+            edges = np.linspace(start[0], end.max(), self.GANTT_RASTER_COLUMNS + 1)
+            centers = (edges[:-1] + edges[1:]) / 2
+            idx = np.maximum(np.searchsorted(start, centers, side='right') - 1, 0)
+            covered = end[idx] > centers
+            image = np.ones((1, len(centers), 4))
+            for pid in np.unique(pids[idx[covered]]):
+                image[0, covered & (pids[idx] == pid)] = mcolors.to_rgba(self.process_colors.get(int(pid), '#808080'))
+            ax.imshow(image, extent=(edges[0], edges[-1], y_pos - height/2, y_pos + height/2),
+                      aspect='auto', interpolation='nearest')
+            return
+        verts = np.empty((len(pids), 4, 2))
+        verts[:, 0, 0] = verts[:, 1, 0] = start
+        verts[:, 2, 0] = verts[:, 3, 0] = end
+        verts[:, 0, 1] = verts[:, 3, 1] = y_pos - height/2
+        verts[:, 1, 1] = verts[:, 2, 1] = y_pos + height/2
+        few = len(pids) <= 1000
+        for pid in np.unique(pids):
+            ax.add_collection(PolyCollection(verts[pids == pid],
+                                             facecolors=self.process_colors.get(int(pid), '#808080'),
+                                             edgecolors='black' if few else 'none', linewidths=1.5))
+        if few:
+            for pid, s, e in zip(pids.tolist(), start.tolist(), end.tolist()):
+                if e - s >= 3:
+                    ax.text((s + e) / 2, y_pos, f'P{pid}', ha='center', va='center',
+                            fontsize=9, fontweight='bold', color='white')
+
     def draw_gantt_chart(self, ax, result: SchedulerResult, title: str = None):
         ax.clear()
         if title:
@@ -494,7 +1233,12 @@ class SchedulerVisualizer:
         y_pos = 0.5
         height = 0.6
 
-        for entry in result.gantt_chart:
+        entries = result.gantt_chart
+        if result.gantt_columns is not None:
+            self._draw_gantt_columns(ax, result.gantt_columns, y_pos, height)
+            entries = []
+
+        for entry in entries:
             color = self.process_colors.get(entry.pid, '#808080')
             rect = mpatches.FancyBboxPatch(
                 (entry.start, y_pos - height/2),
@@ -768,6 +1512,110 @@ def generate_random_processes(n: int, max_arrival: int = 50,
     return processes
 
 
+def generate_random_dag(n: int, edge_prob: float = 0.25, max_burst: int = 20,
+                        seed: int = None) -> List[Process]:
+    """batch pipeline: everything arrives at t=0, each process may depend on earlier ones"""
+    if seed is not None:
+        random.seed(seed)
+
+    processes = []
+    for i in range(n):
+        deps = [j for j in range(i) if random.random() < edge_prob / max(1, i ** 0.5)]
+        processes.append(Process(
+            pid=i,
+            arrival_time=0,
+            burst_time=random.randint(1, max_burst),
+            nice_value=0,
+            deps=deps
+        ))
+    return processes
+
+
+# binary workload format (cfs_workload.h), written by wlconvert
+WORKLOAD_MAGIC = b'CFSWKL1\0'
+WORKLOAD_VERSION = 1
+WORKLOAD_HEADER_DTYPE = np.dtype([
+    ('magic', 'S8'), ('version', '<u4'), ('record_size', '<u4'), ('num_tasks', '<u8'),
+    ('tasks_offset', '<u8'), ('deps_offset', '<u8'), ('num_deps', '<u8'),
+    ('strings_offset', '<u8'), ('strings_size', '<u8')])
+WORKLOAD_TASK_DTYPE = np.dtype([
+    ('release', '<u4'), ('arrival', '<u4'), ('burst', '<u4'), ('line', '<u4'), ('nice', '<i4'),
+    ('slo', '<u4'), ('io_run', '<u4'), ('io_sleep', '<u4'), ('warm', '<u4'),
+    ('lock_hold', '<u4'), ('lock_period', '<u4'), ('disk_kb', '<u4'), ('mem_mb', '<u4'),
+    ('group', '<u4'), ('deps_first', '<u4'), ('deps_count', '<u4')])
+WORKLOAD_CHUNK = 65536
+
+
+def is_binary_workload(path: str) -> bool:
+    with open(path, 'rb') as f:
+        return f.read(len(WORKLOAD_MAGIC)) == WORKLOAD_MAGIC
+
+
+def map_workload(path: str):
+    """memory-maps a binary workload: (tasks, deps, strings) are numpy views of
+    the file, nothing is read until it is touched. tasks are in release order
+    and deps holds the parents of task i at deps_first:deps_first+deps_count"""
+    data = np.memmap(path, dtype=np.uint8, mode='r')
+    if data.size < WORKLOAD_HEADER_DTYPE.itemsize:
+        raise ValueError(f"{path}: bad binary workload")
+    hdr = data[:WORKLOAD_HEADER_DTYPE.itemsize].view(WORKLOAD_HEADER_DTYPE)[0]
+    n, num_deps = int(hdr['num_tasks']), int(hdr['num_deps'])
+    tasks_end = int(hdr['tasks_offset']) + n * WORKLOAD_TASK_DTYPE.itemsize
+    deps_end = int(hdr['deps_offset']) + num_deps * 4
+    strings_end = int(hdr['strings_offset']) + int(hdr['strings_size'])
+    if (hdr['magic'] + b'\0' != WORKLOAD_MAGIC or hdr['version'] != WORKLOAD_VERSION or
+            hdr['record_size'] != WORKLOAD_TASK_DTYPE.itemsize or
+            max(tasks_end, deps_end, strings_end) > data.size):
+        raise ValueError(f"{path}: bad binary workload")
+    tasks = data[int(hdr['tasks_offset']):tasks_end].view(WORKLOAD_TASK_DTYPE)
+    deps = data[int(hdr['deps_offset']):deps_end].view('<u4')
+    strings = data[int(hdr['strings_offset']):strings_end]
+    return tasks, deps, strings
+
+
+def iter_workload(path: str):
+    """Processes of a binary workload in release order, so a caller can admit
+    them as it goes; only one chunk of records is converted at a time"""
+    tasks, deps, strings = map_workload(path)
+    for base in range(0, len(tasks), WORKLOAD_CHUNK):
+        chunk = tasks[base:base + WORKLOAD_CHUNK]
+        columns = [chunk[k].tolist() for k in ('arrival', 'burst', 'nice', 'slo', 'io_run',
+                                                'io_sleep', 'warm', 'deps_first', 'deps_count')]
+        for i, (arrival, burst, nice, slo, io_run, io_sleep, warm, first, count) in enumerate(zip(*columns)):
+            yield Process(pid=base + i, arrival_time=arrival, burst_time=burst, nice_value=nice,
+                          deps=deps[first:first + count].tolist() if count else [],
+                          slo=slo, io_run=io_run, io_sleep=io_sleep, warm=warm)
+
+
+def load_workload(path: str) -> List[Process]:
+    """reads the text workload format shared with the C scheduler:
+    <arrival_ms> <burst_ms> <nice> [key=value ...] per line, '#' starts a comment.
+    binary workloads from wlconvert are recognised by their magic"""
+    if is_binary_workload(path):
+        return list(iter_workload(path))
+    processes = []
+    with open(path) as f:
+        for line in f:
+            fields = line.split('#', 1)[0].split()
+            if not fields:
+                continue
+            proc = Process(pid=len(processes), arrival_time=int(fields[0]),
+                           burst_time=int(fields[1]), nice_value=int(fields[2]))
+            for item in fields[3:]:
+                key, _, value = item.partition('=')
+                if key == 'deps':
+                    proc.deps = [int(d) for d in value.split(',') if d]
+                elif key == 'slo':
+                    proc.slo = int(value)
+                elif key == 'io':
+                    run, _, sleep = value.partition(':')
+                    proc.io_run, proc.io_sleep = int(run), int(sleep)
+                elif key == 'warm':
+                    proc.warm = int(value)
+            processes.append(proc)
+    return processes
+
+
 def run_all_schedulers(processes: List[Process]) -> List[SchedulerResult]:
     schedulers = [
         FCFSScheduler(),
@@ -820,6 +1668,302 @@ def run_load_analysis(load_levels: List[int], seed: int = 42) -> Tuple[List[int]
     return load_levels, metrics_by_scheduler
 
 
+def run_dag_analysis(num_cpus: int = 4, num_tasks: int = 30, trials: int = 20,
+                     seed: int = 42) -> List[Tuple[int, int]]:
+    """makespan of heuristic CFS with and without the critical-path bias on random dags"""
+    makespans = []
+    for trial in range(trials):
+        processes = generate_random_dag(num_tasks, seed=seed + trial)
+        oblivious = HeuristicCFSScheduler(num_cpus=num_cpus, critical_path=False)
+        aware = HeuristicCFSScheduler(num_cpus=num_cpus, critical_path=True)
+        makespans.append((oblivious.schedule(deepcopy(processes)).total_time,
+                          aware.schedule(deepcopy(processes)).total_time))
+    return makespans
+
+
+def print_dag_report(makespans: List[Tuple[int, int]], num_cpus: int):
+    print("\n" + "="*70)
+    print(f"          DAG MAKESPAN ({num_cpus} CPUs, {len(makespans)} random pipelines)")
+    print("="*70)
+    print(f"{'Trial':<8} {'Oblivious CFS':>15} {'Critical Path':>15} {'Improvement':>14}")
+    print("-"*70)
+    for i, (oblivious, aware) in enumerate(makespans):
+        gain = (oblivious - aware) / oblivious * 100
+        print(f"{i:<8} {oblivious:>15} {aware:>15} {gain:>13.1f}%")
+    print("-"*70)
+    total_oblivious = sum(m[0] for m in makespans)
+    total_aware = sum(m[1] for m in makespans)
+    print(f"{'Mean':<8} {total_oblivious / len(makespans):>15.1f} {total_aware / len(makespans):>15.1f} "
+          f"{(total_oblivious - total_aware) / total_oblivious * 100:>13.1f}%")
+    print("="*70)
+
+
+def generate_slo_workload(num_batch: int = 5, num_services: int = 2,
+                          seed: int = None) -> List[Process]:
+    """long throughput-only batch jobs plus latency-sensitive services with p99 targets"""
+    if seed is not None:
+        random.seed(seed)
+
+    processes = []
+    for i in range(num_batch):
+        processes.append(Process(pid=i, arrival_time=0, burst_time=random.randint(150, 250)))
+    for i in range(num_services):
+        processes.append(Process(pid=num_batch + i,
+                                 arrival_time=random.randint(0, 20),
+                                 burst_time=random.randint(100, 200),
+                                 slo=random.choice([10, 15, 20])))
+    return processes
+
+
+def run_slo_analysis(trials: int = 20, seed: int = 42) -> dict:
+    """slo attainment and throughput cost of the pi weight controller.
+    a service meets its slo when the p99 over its last half-window of
+    dispatches (steady state, once the controller has converged) is within target"""
+    summary = {}
+    for control in (False, True):
+        met = services = 0
+        attained = samples = 0
+        batch_tat = []
+        throughput = []
+        for trial in range(trials):
+            processes = generate_slo_workload(seed=seed + trial)
+            scheduler = HeuristicCFSScheduler(slo_control=control)
+            result = scheduler.schedule(deepcopy(processes))
+            throughput.append(result.throughput)
+            for p in result.processes:
+                if p.slo == 0:
+                    batch_tat.append(p.turnaround_time)
+                    continue
+                lat = scheduler.latency_samples[p.pid]
+                services += 1
+                met += scheduler._percentile(lat[-scheduler.SLO_WINDOW // 2:], 99) <= p.slo
+                attained += sum(1 for l in lat if l <= p.slo)
+                samples += len(lat)
+        summary[control] = {
+            'slo_met': met / services * 100,
+            'samples_within': attained / samples * 100,
+            'batch_tat': sum(batch_tat) / len(batch_tat),
+            'throughput': sum(throughput) / len(throughput),
+        }
+    return summary
+
+
+def print_slo_report(summary: dict):
+    print("\n" + "="*78)
+    print("              LATENCY SLO CONTROL (mixed batch + service workload)")
+    print("="*78)
+    print(f"{'Controller':<14} {'p99 SLOs met':>14} {'Dispatches ok':>15} {'Batch TAT':>12} {'Throughput':>12}")
+    print("-"*78)
+    for control in (False, True):
+        m = summary[control]
+        name = "PI weights" if control else "none"
+        print(f"{name:<14} {m['slo_met']:>13.1f}% {m['samples_within']:>14.1f}% "
+              f"{m['batch_tat']:>12.1f} {m['throughput']:>12.4f}")
+    print("-"*78)
+    base, ctl = summary[False], summary[True]
+    print(f"Batch turnaround cost: {(ctl['batch_tat'] - base['batch_tat']) / base['batch_tat'] * 100:+.1f}%   "
+          f"Throughput cost: {(base['throughput'] - ctl['throughput']) / base['throughput'] * 100:+.1f}%")
+    print("="*78)
+
+
+def generate_fork_heavy_workload(num_runners: int = 3, num_forks: int = 15,
+                                 num_interactive: int = 2, seed: int = None) -> List[Process]:
+    """long runners already making progress, then a storm of forked children,
+    plus interactive processes that block on emulated i/o. fork bursts stay
+    above INTERACTIVE_THRESHOLD so placement, not the interactive bonus,
+    decides where they land"""
+    if seed is not None:
+        random.seed(seed)
+
+    processes = []
+    for i in range(num_runners):
+        processes.append(Process(pid=len(processes), arrival_time=0, burst_time=300))
+    for i in range(num_interactive):
+        processes.append(Process(pid=len(processes), arrival_time=0, burst_time=40,
+                                 io_run=2, io_sleep=12))
+    t = 60
+    for i in range(num_forks):
+        processes.append(Process(pid=len(processes), arrival_time=t,
+                                 burst_time=random.randint(25, 45)))
+        t += random.randint(3, 8)
+    return processes
+
+
+def run_placement_analysis(trials: int = 20, seed: int = 42) -> dict:
+    """fork response time, runner progress during the storm and interactive
+    wait for each placement policy"""
+    summary = {}
+    for placement in HeuristicCFSScheduler.PLACEMENTS:
+        fork_resp, interactive_wait, runner_share = [], [], []
+        for trial in range(trials):
+            processes = generate_fork_heavy_workload(seed=seed + trial)
+            result = HeuristicCFSScheduler(placement=placement).schedule(deepcopy(processes))
+
+            forks = [p for p in result.processes if p.arrival_time > 0]
+            runners = {p.pid for p in result.processes if p.burst_time == 300}
+            storm_start = min(p.arrival_time for p in forks)
+            storm_end = max(p.finish_time for p in forks)
+
+            fork_resp += [p.response_time for p in forks]
+            interactive_wait += [p.waiting_time for p in result.processes if p.io_run > 0]
+            runner_time = sum(max(0, min(e.end, storm_end) - max(e.start, storm_start))
+                              for e in result.gantt_chart if e.pid in runners)
+            runner_share.append(runner_time / (storm_end - storm_start) * 100)
+        summary[placement] = {
+            'fork_response': sum(fork_resp) / len(fork_resp),
+            'fork_response_max': max(fork_resp),
+            'runner_share': sum(runner_share) / len(runner_share),
+            'interactive_wait': sum(interactive_wait) / len(interactive_wait),
+        }
+    return summary
+
+
+def print_placement_report(summary: dict):
+    print("\n" + "="*78)
+    print("            TASK PLACEMENT POLICIES (fork-heavy workload)")
+    print("="*78)
+    print(f"{'Policy':<10} {'Fork Resp':>11} {'Fork Resp Max':>15} {'Runner CPU':>18} {'Interactive Wait':>18}")
+    print(f"{'':<10} {'(avg)':>11} {'':>15} {'(during storm)':>18} {'(avg)':>18}")
+    print("-"*78)
+    for placement, m in summary.items():
+        print(f"{placement:<10} {m['fork_response']:>11.1f} {m['fork_response_max']:>15} "
+              f"{m['runner_share']:>17.1f}% {m['interactive_wait']:>18.1f}")
+    print("="*78)
+
+
+def generate_cache_mix_workload(num_cache_heavy: int = 3, num_plain: int = 2,
+                                num_interactive: int = 2, seed: int = None) -> List[Process]:
+    """cache-heavy batch jobs that lose `warm` units every time they are switched
+    in, plain batch jobs, and latency-targeted interactive tasks that block on i/o"""
+    if seed is not None:
+        random.seed(seed)
+
+    processes = []
+    for i in range(num_cache_heavy):
+        processes.append(Process(pid=len(processes), arrival_time=random.randint(0, 10),
+                                 burst_time=random.randint(150, 250), warm=2))
+    for i in range(num_plain):
+        processes.append(Process(pid=len(processes), arrival_time=random.randint(0, 10),
+                                 burst_time=random.randint(100, 200)))
+    for i in range(num_interactive):
+        processes.append(Process(pid=len(processes), arrival_time=random.randint(0, 20),
+                                 burst_time=random.randint(30, 50), io_run=2, io_sleep=10, slo=6))
+    return processes
+
+
+def run_quantum_analysis(trials: int = 20, seed: int = 42) -> dict:
+    """fixed time quantum vs the per-task quantum bandit on the cache mix"""
+    summary = {}
+    for label, adaptive in (("fixed", False), ("bandit", True)):
+        batch_tat, makespan, p99, wasted = [], [], [], []
+        arm_share = np.zeros(4)
+        for trial in range(trials):
+            processes = generate_cache_mix_workload(seed=seed + trial)
+            scheduler = HeuristicCFSScheduler(adaptive_quantum=adaptive)
+            result = scheduler.schedule(deepcopy(processes))
+
+            batch = [p for p in result.processes if p.slo == 0]
+            batch_tat.append(sum(p.turnaround_time for p in batch) / len(batch))
+            makespan.append(max(p.finish_time for p in result.processes))
+            lat = [l for p in result.processes if p.slo > 0 for l in scheduler.latency_samples[p.pid]]
+            p99.append(float(np.percentile(lat, 99)))
+            busy = sum(e.end - e.start for e in result.gantt_chart)
+            wasted.append((busy - sum(p.burst_time for p in result.processes)) / busy * 100)
+            for p in batch:
+                if p.warm > 0 and p.pid in scheduler.arm_pulls:
+                    arm_share += scheduler.arm_pulls[p.pid]
+        summary[label] = {
+            'batch_turnaround': float(np.mean(batch_tat)),
+            'makespan': float(np.mean(makespan)),
+            'interactive_p99': float(np.mean(p99)),
+            'warmup_waste': float(np.mean(wasted)),
+            'cache_heavy_arms': (arm_share / arm_share.sum() * 100) if arm_share.sum() else None,
+            'quanta': scheduler.QUANTUM_ARMS,
+        }
+    return summary
+
+
+def print_quantum_report(summary: dict):
+    print("\n" + "="*78)
+    print("            ADAPTIVE TIME QUANTUM (cache-heavy + interactive mix)")
+    print("="*78)
+    print(f"{'Quantum':<10} {'Batch TAT':>12} {'Makespan':>12} {'Interactive p99':>18} {'Warm-up Waste':>16}")
+    print("-"*78)
+    for label, m in summary.items():
+        print(f"{label:<10} {m['batch_turnaround']:>12.1f} {m['makespan']:>12.1f} "
+              f"{m['interactive_p99']:>18.1f} {m['warmup_waste']:>15.1f}%")
+    print("-"*78)
+    arms = summary['bandit']['cache_heavy_arms']
+    if arms is not None:
+        picks = ", ".join(f"{q}: {share:.0f}%" for q, share in zip(summary['bandit']['quanta'], arms))
+        print(f"Quanta picked for cache-heavy tasks: {picks}")
+    fixed, bandit = summary['fixed'], summary['bandit']
+    gain = (fixed['batch_turnaround'] - bandit['batch_turnaround']) / fixed['batch_turnaround'] * 100
+    print(f"Batch turnaround gain over the fixed quantum: {gain:.1f}%")
+    print("="*78)
+
+
+def generate_regime_shift_workload(shift_time: int = 450, seed: int = None) -> List[Process]:
+    """a batch stream with heavy-tailed sizes (shortest-first territory), then
+    a phase of cpu-bound jobs mixed with interactive tasks (response territory)"""
+    if seed is not None:
+        random.seed(seed)
+
+    processes = []
+    t = 0
+    while t < shift_time - 50:
+        burst = random.randint(40, 80) if random.random() < 0.15 else random.randint(2, 8)
+        processes.append(Process(pid=len(processes), arrival_time=t, burst_time=burst))
+        t += random.randint(10, 20)
+    for i in range(4):
+        processes.append(Process(pid=len(processes), arrival_time=shift_time + 2 * i,
+                                 burst_time=random.randint(20, 30)))
+    for i in range(6):
+        processes.append(Process(pid=len(processes), arrival_time=shift_time + 3 * i,
+                                 burst_time=40, io_run=2, io_sleep=10))
+    return processes
+
+
+def run_regime_analysis(trials: int = 20, shift_time: int = 450, seed: int = 42) -> dict:
+    """each fixed policy vs the meta-scheduler on the regime-shift workload"""
+    summary = {}
+    for policy in list(AdaptivePolicyScheduler.POLICIES) + [None]:
+        batch_wait, late_resp, slowdown, max_wait, switches = [], [], [], [], []
+        for trial in range(trials):
+            processes = generate_regime_shift_workload(shift_time, seed=seed + trial)
+            scheduler = AdaptivePolicyScheduler(policy=policy)
+            result = scheduler.schedule(deepcopy(processes))
+
+            early = [p for p in result.processes if p.arrival_time < shift_time]
+            late = [p for p in result.processes if p.arrival_time >= shift_time]
+            batch_wait.append(np.mean([p.waiting_time for p in early]))
+            late_resp.append(np.mean([p.response_time for p in late]))
+            slowdown.append(np.mean([p.turnaround_time / p.burst_time for p in late]))
+            max_wait.append(max(p.waiting_time for p in result.processes))
+            switches.append(len(scheduler.switches) - 1)
+        summary[policy or 'adaptive'] = {
+            'batch_wait': float(np.mean(batch_wait)),
+            'late_response': float(np.mean(late_resp)),
+            'late_slowdown': float(np.mean(slowdown)),
+            'max_wait': float(np.mean(max_wait)),
+            'switches': float(np.mean(switches)),
+        }
+    return summary
+
+
+def print_regime_report(summary: dict):
+    print("\n" + "="*78)
+    print("            ADAPTIVE POLICY SELECTION (regime-shift workload)")
+    print("="*78)
+    print(f"{'Policy':<10} {'Phase 1 Wait':>14} {'Phase 2 Resp':>14} {'Phase 2 Slowdown':>18} "
+          f"{'Max Wait':>10} {'Switches':>9}")
+    print("-"*78)
+    for policy, m in summary.items():
+        print(f"{policy:<10} {m['batch_wait']:>14.1f} {m['late_response']:>14.1f} "
+              f"{m['late_slowdown']:>18.2f} {m['max_wait']:>10.1f} {m['switches']:>9.1f}")
+    print("="*78)
+
+
 def print_comparison_table(results: List[SchedulerResult]):
     print("\n" + "="*90)
     print("                    SCHEDULING ALGORITHM COMPARISON")
@@ -846,6 +1990,13 @@ def print_comparison_table(results: List[SchedulerResult]):
 
 
 def main():
+    if len(sys.argv) > 1:
+        result = load_results_arrow(sys.argv[1])
+        print_comparison_table([result])
+        SchedulerVisualizer([result]).plot_all_gantt_charts()
+        plt.show()
+        return
+
     print("="*70)
     print("   CPU SCHEDULING ALGORITHMS SIMULATION WITH VISUALIZATION")
     print("="*70)
@@ -885,6 +2036,21 @@ def main():
     load_levels, metrics = run_load_analysis(load_levels)
     fig3, _ = visualizer.plot_performance_vs_load(load_levels, metrics)
 
+    print("\nRunning DAG analysis...")
+    print_dag_report(run_dag_analysis(num_cpus=4), num_cpus=4)
+
+    print("\nRunning SLO controller analysis...")
+    print_slo_report(run_slo_analysis())
+
+    print("\nRunning placement policy analysis...")
+    print_placement_report(run_placement_analysis())
+
+    print("\nRunning adaptive quantum analysis...")
+    print_quantum_report(run_quantum_analysis())
+
+    print("\nRunning adaptive policy selection analysis...")
+    print_regime_report(run_regime_analysis())
+
     print("\nCreating animation...")
     rt_visualizer = RealTimeVisualizer(results)
     fig4, anim = rt_visualizer.animate_gantt_charts(interval=200)
@@ -0,0 +1,848 @@
+// one-pass latency and fairness metrics over a binary trace (-T)
+// compile: gcc -O2 -pthread -o trace_analyzer trace_analyzer.c -Wall -Wextra
+// usage:   ./trace_analyzer [-w ms] [-s ms] [-j threads] [-o json|tsv] [-e] [-a file] trace.bin
+//
+// the file is memory-mapped and its block headers indexed by stream. worker
+// threads take whole streams, decode their blocks in order and keep
+// per-stream task state; the partial results are merged at the end. a task
+// is followed within a stream: its wait restarts on the first event it has
+// on another stream
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <stdatomic.h>
+#include <pthread.h>
+
+#include "cfs_trace.h"
+#include "cfs_arrow.h"
+
+#define WAIT_BUCKETS 1024             // log-linear: exact below 32 us, then 16 per power of two
+#define DEFAULT_WINDOW_MS 1000
+#define DEFAULT_STEP_MS 250
+#define UNSET UINT64_MAX
+#define EXPORT_BATCH_EVENTS (1 << 20)    // rows per record batch of -a
+
+typedef enum {
+    TS_UNKNOWN,                   // no event yet on this stream
+    TS_READY,
+    TS_RUNNING,
+    TS_SLEEPING,
+    TS_DONE
+} task_state_t;
+
+typedef struct {
+    int seen;
+    task_state_t state;
+    uint64_t ready_since, run_since;
+    uint64_t arrive, first_in, complete;
+    long switches;
+    uint64_t cpu_us;
+    uint64_t waits, wait_sum, wait_max;
+    uint32_t *wait_hist;          // WAIT_BUCKETS, allocated on the first wait
+    uint32_t *step_us;            // cpu us per share step
+    long steps;                   // allocated length of step_us
+    long losses;                  // explained picks this task lost as the rival
+    long loss_terms[TRACE_TERMS]; // ... decided by this term alone
+    long loss_joint;              // ... decided by no single term
+    long loss_ties;               // ... on equal scores, by table order
+} task_stat_t;
+
+// explain records (scheduler -E): a term decides a pick when dropping it
+// from both scores alone would leave the winner no longer strictly ahead
+typedef struct {
+    long long records;
+    long long reordered;          // winner was not first in vruntime order
+    long long changed[TRACE_TERMS];    // reordered, and this term decided it
+    long long joint;              // reordered by terms together, none alone
+    long long outside;            // reordered against the score (dominant share, -D)
+    long long ties;               // equal scores, decided by table order
+    long long kept[TRACE_TERMS];  // vruntime order kept, and this term decided it
+} explain_stat_t;
+
+typedef struct {
+    const trace_block_hdr_t **blocks;
+    long num_blocks, cap_blocks;
+
+    // results, owned by the worker that took the stream
+    task_stat_t *tasks;
+    uint32_t num_tasks;
+    long long events, type_counts[TR_TYPES];
+    uint64_t first_us, last_us;
+    int runnable;
+    uint64_t *runq_time;          // runnable-count timeline: change points
+    int *runq_count;
+    long runq_len, runq_cap;
+    explain_stat_t explain;
+    long errors;
+} stream_t;
+
+static const uint8_t *trace_map;
+static size_t trace_size;
+static stream_t *streams;
+static int num_streams;
+static atomic_int next_stream;
+static uint64_t step_us = DEFAULT_STEP_MS * 1000ULL;
+
+static void *xrealloc(void *p, size_t n) {
+    p = realloc(p, n);
+    if (!p) {
+        perror("realloc");
+        exit(1);
+    }
+    return p;
+}
+
+/* ---- wait histograms ---- */
+
+static int wait_bucket(uint64_t v) {
+    if (v < 32) return (int)v;
+    int e = 63 - __builtin_clzll(v);
+    return 32 + (e - 5) * 16 + (int)((v >> (e - 4)) & 15);
+}
+
+// midpoint of a bucket
+static uint64_t wait_bucket_value(int b) {
+    if (b < 32) return b;
+    int e = (b - 32) / 16 + 5;
+    uint64_t width = 1ULL << (e - 4);
+    return (uint64_t)(16 + (b - 32) % 16) * width + width / 2;
+}
+
+// bucket midpoints can overshoot the largest sample, so max caps them
+static uint64_t hist_percentile(const uint32_t *hist, uint64_t count, int pct, uint64_t max) {
+    if (count == 0) return 0;
+    uint64_t rank = (count * pct + 99) / 100, seen = 0;
+    for (int b = 0; b < WAIT_BUCKETS; b++) {
+        seen += hist[b];
+        if (seen >= rank) return wait_bucket_value(b) < max ? wait_bucket_value(b) : max;
+    }
+    return max;
+}
+
+/* ---- per-stream pass ---- */
+
+static task_stat_t *stream_task(stream_t *st, uint32_t id) {
+    if (id >= st->num_tasks) {
+        uint32_t n = st->num_tasks ? st->num_tasks : 64;
+        while (n <= id) n *= 2;
+        st->tasks = xrealloc(st->tasks, n * sizeof(task_stat_t));
+        memset(st->tasks + st->num_tasks, 0, (n - st->num_tasks) * sizeof(task_stat_t));
+        for (uint32_t i = st->num_tasks; i < n; i++) {
+            st->tasks[i].arrive = st->tasks[i].first_in = st->tasks[i].complete = UNSET;
+        }
+        st->num_tasks = n;
+    }
+    task_stat_t *t = &st->tasks[id];
+    t->seen = 1;
+    return t;
+}
+
+static void runq_change(stream_t *st, uint64_t time, int delta) {
+    st->runnable += delta;
+    if (st->runq_len > 0 && st->runq_time[st->runq_len - 1] == time) {
+        st->runq_count[st->runq_len - 1] = st->runnable;
+        return;
+    }
+    if (st->runq_len == st->runq_cap) {
+        st->runq_cap = st->runq_cap ? st->runq_cap * 2 : 4096;
+        st->runq_time = xrealloc(st->runq_time, st->runq_cap * sizeof(uint64_t));
+        st->runq_count = xrealloc(st->runq_count, st->runq_cap * sizeof(int));
+    }
+    st->runq_time[st->runq_len] = time;
+    st->runq_count[st->runq_len] = st->runnable;
+    st->runq_len++;
+}
+
+// charges the run [from, to) to the share steps it overlaps
+static void charge_cpu(task_stat_t *t, uint64_t from, uint64_t to) {
+    t->cpu_us += to - from;
+    long last = (long)(to / step_us);
+    if (last >= t->steps) {
+        long n = t->steps ? t->steps : 256;
+        while (n <= last) n *= 2;
+        t->step_us = xrealloc(t->step_us, n * sizeof(uint32_t));
+        memset(t->step_us + t->steps, 0, (n - t->steps) * sizeof(uint32_t));
+        t->steps = n;
+    }
+    while (from < to) {
+        uint64_t step_end = (from / step_us + 1) * step_us;
+        uint64_t end = step_end < to ? step_end : to;
+        t->step_us[from / step_us] += (uint32_t)(end - from);
+        from = end;
+    }
+}
+
+static void make_ready(stream_t *st, task_stat_t *t, uint64_t time) {
+    if (t->state != TS_READY && t->state != TS_RUNNING) runq_change(st, time, +1);
+    t->state = TS_READY;
+    t->ready_since = time;
+}
+
+static void end_run(stream_t *st, task_stat_t *t, uint64_t time, task_state_t next) {
+    if (t->state == TS_RUNNING) charge_cpu(t, t->run_since, time);
+    if ((t->state == TS_READY || t->state == TS_RUNNING) && next != TS_READY) runq_change(st, time, -1);
+    if (next == TS_READY && t->state != TS_READY && t->state != TS_RUNNING) runq_change(st, time, +1);
+    t->state = next;
+    if (next == TS_READY) t->ready_since = time;
+}
+
+static void apply_explain(stream_t *st, const trace_explain_t *x) {
+    explain_stat_t *e = &st->explain;
+    task_stat_t *rival = stream_task(st, x->rival);
+    int reordered = x->flags & TRACE_EXPLAIN_VRUNTIME_RIVAL;
+
+    int64_t diff = 0;             // winner minus rival; < 0 when the score decided
+    for (int k = 0; k < TRACE_TERMS; k++) diff += x->terms[0][k] - x->terms[1][k];
+
+    e->records++;
+    e->reordered += reordered != 0;
+    rival->losses++;
+    if (diff > 0) {
+        e->outside++;
+        return;
+    }
+    if (diff == 0) {
+        e->ties++;
+        rival->loss_ties++;
+        return;
+    }
+
+    int decided = 0;
+    for (int k = 0; k < TRACE_TERMS; k++) {
+        if (diff - (x->terms[0][k] - x->terms[1][k]) < 0) continue;
+        decided = 1;
+        rival->loss_terms[k]++;
+        if (reordered) e->changed[k]++;
+        else e->kept[k]++;
+    }
+    if (!decided) {
+        rival->loss_joint++;
+        if (reordered) e->joint++;
+    }
+}
+
+static void apply_event(stream_t *st, const trace_event_t *ev) {
+    task_stat_t *t = stream_task(st, ev->task);
+    uint64_t now = ev->time_us;
+
+    switch (ev->type) {
+    case TR_ARRIVE:
+        if (t->arrive == UNSET) t->arrive = now;
+        make_ready(st, t, now);
+        break;
+    case TR_WAKE:
+        make_ready(st, t, now);
+        break;
+    case TR_SWITCH_IN:
+        if (t->state == TS_READY) {
+            uint64_t wait = now - t->ready_since;
+            if (!t->wait_hist) t->wait_hist = calloc(WAIT_BUCKETS, sizeof(uint32_t));
+            if (!t->wait_hist) {
+                perror("calloc");
+                exit(1);
+            }
+            t->wait_hist[wait_bucket(wait)]++;
+            t->waits++;
+            t->wait_sum += wait;
+            if (wait > t->wait_max) t->wait_max = wait;
+        } else if (t->state != TS_RUNNING) {
+            runq_change(st, now, +1);
+        }
+        if (t->first_in == UNSET) t->first_in = now;
+        if (t->state != TS_RUNNING) {
+            t->switches++;
+            t->run_since = now;
+        }
+        t->state = TS_RUNNING;
+        break;
+    case TR_SWITCH_OUT:
+        if (t->state == TS_RUNNING) end_run(st, t, now, TS_READY);
+        break;
+    case TR_SLEEP:
+        end_run(st, t, now, TS_SLEEPING);
+        break;
+    case TR_COMPLETE:
+        t->complete = now;
+        end_run(st, t, now, TS_DONE);
+        break;
+    case TR_THROTTLE:
+        if (ev->arg == 4 && t->state == TS_UNKNOWN) t->state = TS_DONE;    // rejected at admission
+        break;
+    case TR_EXPLAIN:
+        apply_explain(st, &ev->explain);
+        break;
+    default:
+        break;
+    }
+}
+
+static void analyze_stream(stream_t *st) {
+    static _Thread_local uint8_t raw[TRACE_BLOCK_SIZE];
+    st->first_us = UNSET;
+
+    for (long i = 0; i < st->num_blocks; i++) {
+        const trace_block_hdr_t *hdr = st->blocks[i];
+        long n = trace_decode_block(hdr->codec, (const uint8_t *)(hdr + 1), hdr->stored_len, raw, sizeof(raw));
+        if (n != (long)hdr->raw_len) {
+            st->errors++;
+            continue;
+        }
+
+        uint64_t time = hdr->base_us;
+        uint32_t prev_task = TRACE_TASK_NONE;
+        const uint8_t *p = raw, *end = raw + n;
+        trace_event_t ev = {0};
+        while (p < end) {
+            p = trace_get_event(p, end, &time, &prev_task, &ev);
+            if (!p) {
+                st->errors++;
+                break;
+            }
+            if (st->first_us == UNSET) st->first_us = ev.time_us;
+            st->last_us = ev.time_us;
+            st->type_counts[ev.type]++;
+            st->events++;
+            apply_event(st, &ev);
+        }
+    }
+}
+
+static void *worker(void *arg) {
+    (void)arg;
+    int s;
+    while ((s = atomic_fetch_add(&next_stream, 1)) < num_streams) analyze_stream(&streams[s]);
+    return NULL;
+}
+
+/* ---- indexing ---- */
+
+// block headers by stream; a truncated last block (a run that did not
+// close its trace) ends the index with a warning
+static void index_blocks(const char *path) {
+    trace_file_hdr_t fh;
+    if (trace_size < sizeof(fh)) {
+        fprintf(stderr, "%s: too short for a trace\n", path);
+        exit(1);
+    }
+    memcpy(&fh, trace_map, sizeof(fh));
+    if (memcmp(fh.magic, TRACE_MAGIC, sizeof(fh.magic)) != 0 || fh.version != TRACE_VERSION ||
+        fh.streams == 0 || fh.streams > TRACE_MAX_STREAMS) {
+        fprintf(stderr, "%s: not a version %d trace\n", path, TRACE_VERSION);
+        exit(1);
+    }
+    num_streams = (int)fh.streams;
+    streams = calloc(num_streams, sizeof(stream_t));
+    if (!streams) {
+        perror("calloc");
+        exit(1);
+    }
+
+    size_t off = sizeof(fh);
+    while (off < trace_size) {
+        const trace_block_hdr_t *hdr = (const trace_block_hdr_t *)(trace_map + off);
+        if (trace_size - off < sizeof(*hdr) || hdr->stored_len > trace_size - off - sizeof(*hdr)) {
+            fprintf(stderr, "%s: truncated block at offset %zu, ignoring the rest\n", path, off);
+            break;
+        }
+        if (hdr->stream >= num_streams || hdr->raw_len > TRACE_BLOCK_SIZE) {
+            fprintf(stderr, "%s: bad block header at offset %zu, ignoring the rest\n", path, off);
+            break;
+        }
+        stream_t *st = &streams[hdr->stream];
+        if (st->num_blocks == st->cap_blocks) {
+            st->cap_blocks = st->cap_blocks ? st->cap_blocks * 2 : 1024;
+            st->blocks = xrealloc(st->blocks, st->cap_blocks * sizeof(*st->blocks));
+        }
+        st->blocks[st->num_blocks++] = hdr;
+        off += sizeof(*hdr) + hdr->stored_len;
+    }
+}
+
+/* ---- merge and output ---- */
+
+typedef struct {
+    task_stat_t *tasks;
+    uint32_t num_tasks;
+    long long events, type_counts[TR_TYPES];
+    long switches, errors;
+    uint64_t duration_us;
+    long steps;                   // share steps covering the trace
+    uint32_t wait_hist[WAIT_BUCKETS];
+    uint64_t waits, wait_max;
+    explain_stat_t explain;
+} summary_t;
+
+static void merge(summary_t *sum) {
+    uint64_t first = UNSET, last = 0;
+    for (int s = 0; s < num_streams; s++) {
+        if (streams[s].num_tasks > sum->num_tasks) sum->num_tasks = streams[s].num_tasks;
+        if (streams[s].events == 0) continue;
+        if (streams[s].first_us < first) first = streams[s].first_us;
+        if (streams[s].last_us > last) last = streams[s].last_us;
+    }
+    sum->duration_us = first == UNSET ? 0 : last - first;
+    sum->steps = (long)(last / step_us) + 1;
+
+    sum->tasks = calloc(sum->num_tasks ? sum->num_tasks : 1, sizeof(task_stat_t));
+    if (!sum->tasks) {
+        perror("calloc");
+        exit(1);
+    }
+    for (uint32_t i = 0; i < sum->num_tasks; i++) {
+        task_stat_t *t = &sum->tasks[i];
+        t->arrive = t->first_in = t->complete = UNSET;
+        t->wait_hist = calloc(WAIT_BUCKETS, sizeof(uint32_t));
+        t->step_us = calloc(sum->steps, sizeof(uint32_t));
+        if (!t->wait_hist || !t->step_us) {
+            perror("calloc");
+            exit(1);
+        }
+        t->steps = sum->steps;
+    }
+
+    for (int s = 0; s < num_streams; s++) {
+        stream_t *st = &streams[s];
+        sum->events += st->events;
+        sum->errors += st->errors;
+        for (int k = 0; k < TR_TYPES; k++) sum->type_counts[k] += st->type_counts[k];
+        sum->explain.records += st->explain.records;
+        sum->explain.reordered += st->explain.reordered;
+        sum->explain.joint += st->explain.joint;
+        sum->explain.outside += st->explain.outside;
+        sum->explain.ties += st->explain.ties;
+        for (int k = 0; k < TRACE_TERMS; k++) {
+            sum->explain.changed[k] += st->explain.changed[k];
+            sum->explain.kept[k] += st->explain.kept[k];
+        }
+
+        for (uint32_t i = 0; i < st->num_tasks; i++) {
+            task_stat_t *from = &st->tasks[i], *t = &sum->tasks[i];
+            if (!from->seen) continue;
+            t->seen = 1;
+            t->switches += from->switches;
+            t->cpu_us += from->cpu_us;
+            t->waits += from->waits;
+            t->wait_sum += from->wait_sum;
+            if (from->wait_max > t->wait_max) t->wait_max = from->wait_max;
+            t->losses += from->losses;
+            t->loss_joint += from->loss_joint;
+            t->loss_ties += from->loss_ties;
+            for (int k = 0; k < TRACE_TERMS; k++) t->loss_terms[k] += from->loss_terms[k];
+            if (from->arrive < t->arrive) t->arrive = from->arrive;
+            if (from->first_in < t->first_in) t->first_in = from->first_in;
+            if (from->complete != UNSET && (t->complete == UNSET || from->complete > t->complete)) {
+                t->complete = from->complete;
+            }
+            if (from->wait_hist) {
+                for (int b = 0; b < WAIT_BUCKETS; b++) t->wait_hist[b] += from->wait_hist[b];
+            }
+            for (long k = 0; k < from->steps && k < sum->steps; k++) t->step_us[k] += from->step_us[k];
+        }
+    }
+
+    for (uint32_t i = 0; i < sum->num_tasks; i++) {
+        task_stat_t *t = &sum->tasks[i];
+        sum->switches += t->switches;
+        sum->waits += t->waits;
+        if (t->wait_max > sum->wait_max) sum->wait_max = t->wait_max;
+        for (int b = 0; b < WAIT_BUCKETS; b++) sum->wait_hist[b] += t->wait_hist[b];
+    }
+}
+
+static int cmp_u64(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return x < y ? -1 : x > y;
+}
+
+// exact percentiles of a per-task quantity over the tasks that have it
+typedef struct {
+    long count;
+    uint64_t p50, p99, max;
+} spread_t;
+
+static spread_t task_spread(const summary_t *sum, int turnaround) {
+    spread_t r = {0};
+    uint64_t *v = malloc((sum->num_tasks + 1) * sizeof(uint64_t));
+    if (!v) {
+        perror("malloc");
+        exit(1);
+    }
+    for (uint32_t i = 0; i < sum->num_tasks; i++) {
+        const task_stat_t *t = &sum->tasks[i];
+        uint64_t end = turnaround ? t->complete : t->first_in;
+        if (t->seen && t->arrive != UNSET && end != UNSET && end >= t->arrive) v[r.count++] = end - t->arrive;
+    }
+    if (r.count) {
+        qsort(v, r.count, sizeof(uint64_t), cmp_u64);
+        r.p50 = v[(r.count * 50 + 99) / 100 - 1];
+        r.p99 = v[(r.count * 99 + 99) / 100 - 1];
+        r.max = v[r.count - 1];
+    }
+    free(v);
+    return r;
+}
+
+static long window_steps(uint64_t window_us) {
+    long w = (long)((window_us + step_us - 1) / step_us);
+    return w > 0 ? w : 1;
+}
+
+// cpu share of task i in the window starting at step k, of all streams' capacity
+static double window_share(const summary_t *sum, uint32_t i, long k, long w) {
+    uint64_t us = 0;
+    for (long j = k; j < k + w && j < sum->steps; j++) us += sum->tasks[i].step_us[j];
+    return (double)us / ((double)w * step_us * num_streams);
+}
+
+static void print_json(const summary_t *sum, const char *path, uint64_t window_us) {
+    spread_t response = task_spread(sum, 0), turnaround = task_spread(sum, 1);
+    long w = window_steps(window_us);
+    long windows = sum->steps > w ? sum->steps - w + 1 : 1;
+
+    printf("{\n  \"file\": \"%s\",\n  \"streams\": %d,\n  \"events\": %lld,\n", path, num_streams, sum->events);
+    printf("  \"decode_errors\": %ld,\n  \"duration_us\": %llu,\n", sum->errors,
+           (unsigned long long)sum->duration_us);
+    printf("  \"event_counts\": {");
+    for (int k = 1; k < TR_TYPES; k++) {
+        printf("%s\"%s\": %lld", k > 1 ? ", " : "", trace_type_names[k], sum->type_counts[k]);
+    }
+    printf("},\n  \"context_switches\": %ld,\n", sum->switches);
+    printf("  \"wait_us\": {\"count\": %llu, \"p50\": %llu, \"p90\": %llu, \"p99\": %llu, \"max\": %llu},\n",
+           (unsigned long long)sum->waits,
+           (unsigned long long)hist_percentile(sum->wait_hist, sum->waits, 50, sum->wait_max),
+           (unsigned long long)hist_percentile(sum->wait_hist, sum->waits, 90, sum->wait_max),
+           (unsigned long long)hist_percentile(sum->wait_hist, sum->waits, 99, sum->wait_max),
+           (unsigned long long)sum->wait_max);
+    printf("  \"response_us\": {\"tasks\": %ld, \"p50\": %llu, \"p99\": %llu, \"max\": %llu},\n",
+           response.count, (unsigned long long)response.p50, (unsigned long long)response.p99,
+           (unsigned long long)response.max);
+    printf("  \"turnaround_us\": {\"tasks\": %ld, \"p50\": %llu, \"p99\": %llu, \"max\": %llu},\n",
+           turnaround.count, (unsigned long long)turnaround.p50, (unsigned long long)turnaround.p99,
+           (unsigned long long)turnaround.max);
+
+    printf("  \"tasks\": [");
+    int first = 1;
+    for (uint32_t i = 0; i < sum->num_tasks; i++) {
+        const task_stat_t *t = &sum->tasks[i];
+        if (!t->seen) continue;
+        printf("%s\n    {\"task\": %u, \"switches\": %ld, \"cpu_us\": %llu", first ? "" : ",", i, t->switches,
+               (unsigned long long)t->cpu_us);
+        first = 0;
+        if (t->arrive != UNSET && t->first_in != UNSET) {
+            printf(", \"response_us\": %llu", (unsigned long long)(t->first_in - t->arrive));
+        }
+        if (t->arrive != UNSET && t->complete != UNSET) {
+            printf(", \"turnaround_us\": %llu", (unsigned long long)(t->complete - t->arrive));
+        }
+        printf(", \"wait_us\": {\"count\": %llu, \"mean\": %.1f, \"p50\": %llu, \"p90\": %llu, \"p99\": %llu, "
+               "\"max\": %llu}}",
+               (unsigned long long)t->waits, t->waits ? (double)t->wait_sum / t->waits : 0.0,
+               (unsigned long long)hist_percentile(t->wait_hist, t->waits, 50, t->wait_max),
+               (unsigned long long)hist_percentile(t->wait_hist, t->waits, 90, t->wait_max),
+               (unsigned long long)hist_percentile(t->wait_hist, t->waits, 99, t->wait_max),
+               (unsigned long long)t->wait_max);
+    }
+    printf("\n  ],\n");
+
+    printf("  \"cpu_share\": {\"window_us\": %llu, \"step_us\": %llu, \"start_us\": [",
+           (unsigned long long)(w * step_us), (unsigned long long)step_us);
+    for (long k = 0; k < windows; k++) printf("%s%llu", k ? ", " : "", (unsigned long long)(k * step_us));
+    printf("],\n    \"tasks\": {");
+    first = 1;
+    for (uint32_t i = 0; i < sum->num_tasks; i++) {
+        if (!sum->tasks[i].seen) continue;
+        printf("%s\n      \"%u\": [", first ? "" : ",", i);
+        first = 0;
+        for (long k = 0; k < windows; k++) printf("%s%.4f", k ? ", " : "", window_share(sum, i, k, w));
+        printf("]");
+    }
+    printf("\n    }\n  },\n");
+
+    printf("  \"runnable\": [");
+    for (int s = 0; s < num_streams; s++) {
+        const stream_t *st = &streams[s];
+        printf("%s\n    {\"stream\": %d, \"time_us\": [", s ? "," : "", s);
+        for (long k = 0; k < st->runq_len; k++) {
+            printf("%s%llu", k ? ", " : "", (unsigned long long)st->runq_time[k]);
+        }
+        printf("], \"count\": [");
+        for (long k = 0; k < st->runq_len; k++) printf("%s%d", k ? ", " : "", st->runq_count[k]);
+        printf("]}");
+    }
+    printf("\n  ]\n}\n");
+}
+
+// tab-separated sections, one header row each
+static void print_tsv(const summary_t *sum, uint64_t window_us) {
+    long w = window_steps(window_us);
+    long windows = sum->steps > w ? sum->steps - w + 1 : 1;
+
+    printf("# tasks\n");
+    printf("task\tswitches\tcpu_us\tresponse_us\tturnaround_us\twaits\twait_mean_us\twait_p50_us"
+           "\twait_p90_us\twait_p99_us\twait_max_us\n");
+    for (uint32_t i = 0; i < sum->num_tasks; i++) {
+        const task_stat_t *t = &sum->tasks[i];
+        if (!t->seen) continue;
+        printf("%u\t%ld\t%llu\t", i, t->switches, (unsigned long long)t->cpu_us);
+        if (t->arrive != UNSET && t->first_in != UNSET) printf("%llu", (unsigned long long)(t->first_in - t->arrive));
+        printf("\t");
+        if (t->arrive != UNSET && t->complete != UNSET) printf("%llu", (unsigned long long)(t->complete - t->arrive));
+        printf("\t%llu\t%.1f\t%llu\t%llu\t%llu\t%llu\n", (unsigned long long)t->waits,
+               t->waits ? (double)t->wait_sum / t->waits : 0.0,
+               (unsigned long long)hist_percentile(t->wait_hist, t->waits, 50, t->wait_max),
+               (unsigned long long)hist_percentile(t->wait_hist, t->waits, 90, t->wait_max),
+               (unsigned long long)hist_percentile(t->wait_hist, t->waits, 99, t->wait_max),
+               (unsigned long long)t->wait_max);
+    }
+
+    printf("# cpu_share window_us=%llu\nstart_us", (unsigned long long)(w * step_us));
+    for (uint32_t i = 0; i < sum->num_tasks; i++) {
+        if (sum->tasks[i].seen) printf("\tP%u", i);
+    }
+    printf("\n");
+    for (long k = 0; k < windows; k++) {
+        printf("%llu", (unsigned long long)(k * step_us));
+        for (uint32_t i = 0; i < sum->num_tasks; i++) {
+            if (sum->tasks[i].seen) printf("\t%.4f", window_share(sum, i, k, w));
+        }
+        printf("\n");
+    }
+
+    printf("# runnable\nstream\ttime_us\trunnable\n");
+    for (int s = 0; s < num_streams; s++) {
+        for (long k = 0; k < streams[s].runq_len; k++) {
+            printf("%d\t%llu\t%d\n", s, (unsigned long long)streams[s].runq_time[k], streams[s].runq_count[k]);
+        }
+    }
+}
+
+// how often each heuristic term changed a pick away from pure vruntime
+// order, how often it kept it, and why each task lost
+static void print_explain(const summary_t *sum, const char *path, int tsv) {
+    const explain_stat_t *e = &sum->explain;
+    double picks = e->records ? (double)e->records : 1.0;
+
+    if (tsv) {
+        printf("# explain records=%lld reordered=%lld joint=%lld outside=%lld ties=%lld\n",
+               e->records, e->reordered, e->joint, e->outside, e->ties);
+        printf("term\tchanged\tchanged_pct\tkept\tkept_pct\n");
+        for (int k = 0; k < TRACE_TERMS; k++) {
+            printf("%s\t%lld\t%.2f\t%lld\t%.2f\n", trace_term_names[k], e->changed[k],
+                   100.0 * e->changed[k] / picks, e->kept[k], 100.0 * e->kept[k] / picks);
+        }
+        printf("# losses\ntask\tlost");
+        for (int k = 0; k < TRACE_TERMS; k++) printf("\t%s", trace_term_names[k]);
+        printf("\tjoint\ttie\n");
+        for (uint32_t i = 0; i < sum->num_tasks; i++) {
+            const task_stat_t *t = &sum->tasks[i];
+            if (!t->losses) continue;
+            printf("%u\t%ld", i, t->losses);
+            for (int k = 0; k < TRACE_TERMS; k++) printf("\t%ld", t->loss_terms[k]);
+            printf("\t%ld\t%ld\n", t->loss_joint, t->loss_ties);
+        }
+        return;
+    }
+
+    printf("{\n  \"file\": \"%s\",\n  \"explained_picks\": %lld,\n", path, e->records);
+    printf("  \"vruntime_order_kept\": %lld,\n  \"vruntime_order_changed\": %lld,\n",
+           e->records - e->reordered, e->reordered);
+    printf("  \"changed_jointly\": %lld,\n  \"changed_outside_score\": %lld,\n  \"ties\": %lld,\n",
+           e->joint, e->outside, e->ties);
+    printf("  \"terms\": [");
+    for (int k = 0; k < TRACE_TERMS; k++) {
+        printf("%s\n    {\"term\": \"%s\", \"changed\": %lld, \"changed_pct\": %.2f, "
+               "\"kept\": %lld, \"kept_pct\": %.2f}",
+               k ? "," : "", trace_term_names[k], e->changed[k], 100.0 * e->changed[k] / picks,
+               e->kept[k], 100.0 * e->kept[k] / picks);
+    }
+    printf("\n  ],\n  \"losses\": [");
+    int first = 1;
+    for (uint32_t i = 0; i < sum->num_tasks; i++) {
+        const task_stat_t *t = &sum->tasks[i];
+        if (!t->losses) continue;
+        printf("%s\n    {\"task\": %u, \"lost\": %ld, \"by\": {", first ? "" : ",", i, t->losses);
+        first = 0;
+        for (int k = 0; k < TRACE_TERMS; k++) {
+            printf("%s\"%s\": %ld", k ? ", " : "", trace_term_names[k], t->loss_terms[k]);
+        }
+        printf("}, \"joint\": %ld, \"tie\": %ld}", t->loss_joint, t->loss_ties);
+    }
+    printf("\n  ]\n}\n");
+}
+
+/* ---- columnar export ---- */
+
+// every event as one row of an arrow ipc file, stream by stream in time
+// order within each; type is a code into the type.names list in the schema
+// metadata. returns the rows written, -1 on failure
+static long long export_events(const char *out) {
+    static const arrow_field_t fields[] = {
+        { "time_us", ARROW_INT64 }, { "stream", ARROW_INT32 }, { "type", ARROW_INT32 },
+        { "task", ARROW_INT32 }, { "arg", ARROW_INT64 },
+    };
+    char names[256] = "";
+    for (int t = 0; t < TR_TYPES; t++) {
+        snprintf(names + strlen(names), sizeof(names) - strlen(names), "%s%s", t ? "," : "", trace_type_names[t]);
+    }
+    const arrow_meta_t meta[] = {
+        { "producer", "trace_analyzer" }, { "time_unit", "us" }, { "type.names", names },
+    };
+    arrow_writer_t w;
+    if (arrow_open(&w, out, fields, 5, meta, 3) < 0) {
+        perror(out);
+        return -1;
+    }
+
+    int64_t *time_us = xrealloc(NULL, EXPORT_BATCH_EVENTS * sizeof(int64_t));
+    int64_t *arg = xrealloc(NULL, EXPORT_BATCH_EVENTS * sizeof(int64_t));
+    int32_t *stream = xrealloc(NULL, EXPORT_BATCH_EVENTS * sizeof(int32_t));
+    int32_t *type = xrealloc(NULL, EXPORT_BATCH_EVENTS * sizeof(int32_t));
+    int32_t *task = xrealloc(NULL, EXPORT_BATCH_EVENTS * sizeof(int32_t));
+    const arrow_column_t cols[] = { { time_us, NULL }, { stream, NULL }, { type, NULL }, { task, NULL }, { arg, NULL } };
+    static uint8_t raw[TRACE_BLOCK_SIZE];
+    long long total = 0;
+    long rows = 0;
+
+    for (int s = 0; s < num_streams; s++) {
+        const stream_t *st = &streams[s];
+        for (long i = 0; i < st->num_blocks; i++) {
+            const trace_block_hdr_t *hdr = st->blocks[i];
+            long n = trace_decode_block(hdr->codec, (const uint8_t *)(hdr + 1), hdr->stored_len, raw, sizeof(raw));
+            if (n != (long)hdr->raw_len) continue;
+
+            uint64_t time = hdr->base_us;
+            uint32_t prev_task = TRACE_TASK_NONE;
+            const uint8_t *p = raw, *end = raw + n;
+            trace_event_t ev = {0};
+            while (p < end && (p = trace_get_event(p, end, &time, &prev_task, &ev))) {
+                time_us[rows] = (int64_t)ev.time_us;
+                stream[rows] = s;
+                type[rows] = ev.type;
+                task[rows] = (int32_t)ev.task;
+                arg[rows] = ev.arg;
+                if (++rows == EXPORT_BATCH_EVENTS) {
+                    arrow_write_batch(&w, cols, rows);
+                    total += rows;
+                    rows = 0;
+                }
+            }
+        }
+    }
+    if (rows || total == 0) arrow_write_batch(&w, cols, rows);
+    total += rows;
+
+    free(time_us);
+    free(arg);
+    free(stream);
+    free(type);
+    free(task);
+    if (arrow_close(&w) < 0) {
+        fprintf(stderr, "%s: write failed\n", out);
+        return -1;
+    }
+    return total;
+}
+
+void print_usage(const char *prog) {
+    fprintf(stderr,
+            "usage: %s [-w ms] [-s ms] [-j threads] [-o json|tsv] [-e] [-a file] trace\n"
+            "  -w MS    cpu share window (default %d)\n"
+            "  -s MS    cpu share window step (default %d)\n"
+            "  -j N     worker threads over streams (default: online cpus)\n"
+            "  -o FMT   json (default) or tsv\n"
+            "  -e       report which score terms decided the explained picks (scheduler -E)\n"
+            "  -a FILE  also write every event as a row of an arrow ipc file (cfs_arrow.h)\n",
+            prog, DEFAULT_WINDOW_MS, DEFAULT_STEP_MS);
+}
+
+int main(int argc, char **argv) {
+    int opt, threads = (int)sysconf(_SC_NPROCESSORS_ONLN), tsv = 0, explain = 0;
+    uint64_t window_us = DEFAULT_WINDOW_MS * 1000ULL;
+    const char *export_path = NULL;
+    while ((opt = getopt(argc, argv, "w:s:j:o:ea:h")) != -1) {
+        switch (opt) {
+        case 'w': window_us = strtoull(optarg, NULL, 10) * 1000; break;
+        case 's': step_us = strtoull(optarg, NULL, 10) * 1000; break;
+        case 'j': threads = atoi(optarg); break;
+        case 'e': explain = 1; break;
+        case 'a': export_path = optarg; break;
+        case 'o':
+            if (strcmp(optarg, "json") == 0) tsv = 0;
+            else if (strcmp(optarg, "tsv") == 0) tsv = 1;
+            else {
+                fprintf(stderr, "unknown output format '%s'\n", optarg);
+                return 1;
+            }
+            break;
+        default:
+            print_usage(argv[0]);
+            return opt == 'h' ? 0 : 1;
+        }
+    }
+    if (optind != argc - 1 || window_us == 0 || step_us == 0 || threads <= 0) {
+        print_usage(argv[0]);
+        return 1;
+    }
+    const char *path = argv[optind];
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    int fd = open(path, O_RDONLY);
+    struct stat sb;
+    if (fd < 0 || fstat(fd, &sb) != 0) {
+        perror(path);
+        return 1;
+    }
+    trace_size = sb.st_size;
+    trace_map = mmap(NULL, trace_size ? trace_size : 1, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (trace_map == MAP_FAILED) {
+        perror("mmap");
+        return 1;
+    }
+    madvise((void *)trace_map, trace_size, MADV_SEQUENTIAL);
+    close(fd);
+
+    index_blocks(path);
+    if (threads > num_streams) threads = num_streams;
+    pthread_t tids[TRACE_MAX_STREAMS];
+    for (int i = 0; i < threads; i++) {
+        if (pthread_create(&tids[i], NULL, worker, NULL) != 0) {
+            perror("pthread_create");
+            return 1;
+        }
+    }
+    for (int i = 0; i < threads; i++) pthread_join(tids[i], NULL);
+
+    summary_t sum = {0};
+    merge(&sum);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+
+    if (explain) print_explain(&sum, path, tsv);
+    else if (tsv) print_tsv(&sum, window_us);
+    else print_json(&sum, path, window_us);
+
+    fprintf(stderr, "%s: %.1f MB, %lld events, %d stream(s) on %d thread(s) in %.3f s: %.2f GB/s, %.1f M events/s\n",
+            path, trace_size / 1e6, sum.events, num_streams, threads, seconds, trace_size / seconds / 1e9,
+            sum.events / seconds / 1e6);
+    if (sum.errors) fprintf(stderr, "%s: %ld undecodable block(s) or event(s)\n", path, sum.errors);
+
+    if (export_path) {
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        long long rows = export_events(export_path);
+        if (rows < 0) return 1;
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+        fprintf(stderr, "%s: %lld events exported in %.3f s\n", export_path, rows, seconds);
+    }
+    return sum.errors != 0;
+}
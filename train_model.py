@@ -0,0 +1,188 @@
+# offline trainer for the learned scoring model used by the C scheduler (-L)
+# collects decision traces from the simulator, fits a linear model by softmax
+# regression over each decision's candidates, quantizes it to integers and writes cfs_model.h
+#
+# usage: python train_model.py [output_header]
+
+import random
+import sys
+from copy import deepcopy
+from typing import List, Tuple
+
+import numpy as np
+
+from scheduler_simulation import (HeuristicCFSScheduler, LearnedCFSScheduler, Process,
+                                  MODEL_FEATURE_NAMES, FEATURE_MAX,
+                                  generate_random_processes, generate_fork_heavy_workload)
+
+WAIT_CAP = 100          # teacher: anyone runnable this long goes first
+WEIGHT_LIMIT = 1023     # quantized weights fit in int16, sums stay inside int32
+
+
+class TraceCollector(HeuristicCFSScheduler):
+    """records (features of every candidate, teacher's pick) at each decision.
+    the teacher is clairvoyant shortest-remaining-first with a wait cap; the
+    run itself follows the teacher or the heuristic at random so the traces
+    also cover states the heuristic leads into"""
+
+    def __init__(self, rng: random.Random, **kwargs):
+        super().__init__(**kwargs)
+        self.rng = rng
+        self.decisions: List[Tuple[List[List[int]], int]] = []
+        self.teacher_matches = 0
+
+    def _teacher(self, available: List[Process]) -> int:
+        waits = [self.current_time - self.ready_since.get(p.pid, p.arrival_time) for p in available]
+        starving = [i for i, w in enumerate(waits) if w >= WAIT_CAP]
+        if starving:
+            return max(starving, key=lambda i: waits[i])
+        return min(range(len(available)), key=lambda i: (available[i].remaining_time, available[i].pid))
+
+    def _select_processes(self, available, current_time, count):
+        heuristic = super()._select_processes(available, current_time, count)
+        if len(available) < 2:
+            return heuristic
+
+        teacher = self._teacher(available)
+        self.decisions.append(([self._features(p) for p in available], teacher))
+        self.teacher_matches += heuristic[0] is available[teacher]
+
+        return [available[teacher]] if self.rng.random() < 0.5 else heuristic
+
+
+def training_workloads(seed: int, count: int) -> List[List[Process]]:
+    rng = random.Random(seed)
+    workloads = []
+    for i in range(count):
+        if i % 4 == 3:
+            workloads.append(generate_fork_heavy_workload(seed=rng.randrange(1 << 30)))
+        else:
+            n = rng.randint(8, 30)
+            workloads.append(generate_random_processes(n, max_arrival=2 * n, max_burst=20,
+                                                       seed=rng.randrange(1 << 30)))
+    return workloads
+
+
+def collect(workloads: List[List[Process]], seed: int) -> Tuple[list, float]:
+    rng = random.Random(seed)
+    decisions, matches = [], 0
+    for processes in workloads:
+        collector = TraceCollector(rng)
+        collector.schedule(deepcopy(processes))
+        decisions += collector.decisions
+        matches += collector.teacher_matches
+    return decisions, matches / max(1, len(decisions))
+
+
+def pack(decisions) -> Tuple[np.ndarray, np.ndarray, np.ndarray]:
+    # decisions padded to the widest one: features, valid-candidate mask, teacher index
+    width = max(len(features) for features, _ in decisions)
+    x = np.zeros((len(decisions), width, len(MODEL_FEATURE_NAMES)))
+    mask = np.zeros((len(decisions), width), dtype=bool)
+    picks = np.zeros(len(decisions), dtype=int)
+    for i, (features, teacher) in enumerate(decisions):
+        x[i, :len(features)] = features
+        mask[i, :len(features)] = True
+        picks[i] = teacher
+    return x, mask, picks
+
+
+def fit(decisions, epochs: int = 300, lr: float = 0.5, l2: float = 1e-4) -> np.ndarray:
+    """softmax over the candidates of each decision (lowest score most likely),
+    maximizing the likelihood of the teacher's pick. the vruntime weight is kept
+    non-negative: a model that rewards having run more than your share learns
+    to keep re-picking the current task and never gives the cpu back"""
+    x, mask, picks = pack(decisions)
+    scale = np.maximum(x[mask].std(axis=0), 1e-9)
+    x = x / scale
+    rows = np.arange(len(picks))
+    w = np.zeros(x.shape[2])
+    for _ in range(epochs):
+        logits = np.where(mask, -(x @ w), -np.inf)
+        p = np.exp(logits - logits.max(axis=1, keepdims=True))
+        p /= p.sum(axis=1, keepdims=True)
+        grad = (x[rows, picks] - np.einsum('ij,ijk->ik', p, x)).mean(axis=0) + l2 * w
+        w -= lr * grad
+        w[0] = max(w[0], 0.0)
+    return w / scale
+
+
+def quantize(w: np.ndarray) -> List[int]:
+    peak = np.abs(w).max()
+    return [int(round(v / peak * WEIGHT_LIMIT)) for v in w] if peak > 0 else [0] * len(w)
+
+
+def agreement(weights: List[int], decisions) -> float:
+    hits = 0
+    for features, teacher in decisions:
+        scores = [sum(w * f for w, f in zip(weights, fv)) for fv in features]
+        hits += scores.index(min(scores)) == teacher
+    return hits / max(1, len(decisions))
+
+
+def evaluate(weights: List[int], workloads: List[List[Process]]) -> dict:
+    stats = {}
+    for name, make in (("Heuristic CFS", lambda: HeuristicCFSScheduler()),
+                       ("Learned CFS", lambda: LearnedCFSScheduler(weights=weights))):
+        waits, responses, max_waits = [], [], []
+        for processes in workloads:
+            result = make().schedule(deepcopy(processes))
+            waits.append(result.avg_waiting_time)
+            responses.append(result.avg_response_time)
+            max_waits.append(max(p.waiting_time for p in result.processes))
+        stats[name] = (np.mean(waits), np.mean(responses), np.mean(max_waits))
+    return stats
+
+
+def write_header(path: str, weights: List[int], num_decisions: int, num_runs: int,
+                 model_agreement: float, heuristic_agreement: float):
+    with open(path, "w") as f:
+        f.write("// generated by train_model.py - do not edit\n")
+        f.write("// linear scoring model: score = sum(model_weights[i] * feature[i]),\n")
+        f.write("// lowest score runs next. features are integers clamped to\n")
+        f.write(f"// [0, {FEATURE_MAX}]: {', '.join(MODEL_FEATURE_NAMES)}\n")
+        f.write(f"// trained on {num_decisions} decisions from {num_runs} simulator runs,\n")
+        f.write(f"// held-out teacher agreement {model_agreement * 100:.1f}% "
+                f"(hand-written heuristic {heuristic_agreement * 100:.1f}%)\n\n")
+        f.write("#ifndef CFS_MODEL_H\n#define CFS_MODEL_H\n\n#include <stdint.h>\n\n")
+        f.write(f"#define MODEL_FEATURES {len(weights)}\n")
+        f.write(f"#define MODEL_FEATURE_MAX {FEATURE_MAX}\n\n")
+        f.write("static const int32_t model_weights[MODEL_FEATURES] = {"
+                + ", ".join(str(w) for w in weights) + "};\n\n")
+        f.write("#endif\n")
+
+
+def main():
+    output = sys.argv[1] if len(sys.argv) > 1 else "cfs_model.h"
+
+    train_runs = training_workloads(seed=1, count=200)
+    test_runs = training_workloads(seed=2, count=60)
+
+    print("Collecting decision traces...")
+    train, _ = collect(train_runs, seed=1)
+    test, heuristic_agreement = collect(test_runs, seed=2)
+    print(f"  {len(train)} training decisions, {len(test)} held-out decisions")
+
+    weights = quantize(fit(train))
+    model_agreement = agreement(weights, test)
+
+    print("\n" + "="*70)
+    print("                 LEARNED SCORING MODEL")
+    print("="*70)
+    for name, w in zip(MODEL_FEATURE_NAMES, weights):
+        print(f"  {name:<16} {w:>6}")
+    print("-"*70)
+    print(f"Teacher agreement (held out): model {model_agreement * 100:.1f}%, "
+          f"heuristic {heuristic_agreement * 100:.1f}%")
+    print("-"*70)
+    print(f"{'Scheduler':<16} {'Avg Wait':>10} {'Avg Resp':>10} {'Max Wait':>10}")
+    for name, (wait, resp, max_wait) in evaluate(weights, test_runs).items():
+        print(f"{name:<16} {wait:>10.2f} {resp:>10.2f} {max_wait:>10.2f}")
+    print("="*70)
+
+    write_header(output, weights, len(train), len(train_runs), model_agreement, heuristic_agreement)
+    print(f"\nWrote {output}")
+
+
+if __name__ == "__main__":
+    main()
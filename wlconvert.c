@@ -0,0 +1,459 @@
+// converts text workloads to the binary format of cfs_workload.h, and back
+// compile: gcc -O2 -o wlconvert wlconvert.c -Wall -Wextra
+// usage:   ./wlconvert [-o out.wl] workload.txt
+//          ./wlconvert -d workload.wl          (print as text)
+//          ./wlconvert -B tasks [-o out.wl]    (startup-time benchmark)
+//
+// the text format is parsed with the scheduler's rules. records are
+// stably sorted by release time and renumbered; dependency lists follow
+// the new numbering. the benchmark writes a synthetic workload in both
+// formats and times parsing the text against mapping the binary file
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+
+#include "cfs_workload.h"
+
+#define MAX_LINE_LEN 4096
+#define GROUP_SLOTS 4096              // open-addressing table of group names
+#define BENCH_GROUPS 16
+
+typedef struct {
+    wl_task_t *tasks;             // in text order until sorted
+    size_t num_tasks, cap_tasks;
+    uint32_t *deps;               // parent line numbers, per task in text order
+    size_t num_deps, cap_deps;
+    char *strings;
+    size_t strings_size, strings_cap;
+    uint32_t group_slots[GROUP_SLOTS];    // string offset + 1, 0 = empty
+    int num_groups;
+} workload_t;
+
+static void *xrealloc(void *p, size_t n) {
+    p = realloc(p, n);
+    if (!p) {
+        perror("realloc");
+        exit(1);
+    }
+    return p;
+}
+
+static double now_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static uint32_t intern(workload_t *w, const char *name) {
+    uint32_t h = 2166136261u;
+    for (const char *p = name; *p; p++) h = (h ^ (uint8_t)*p) * 16777619u;
+    for (uint32_t i = h % GROUP_SLOTS;; i = (i + 1) % GROUP_SLOTS) {
+        uint32_t slot = w->group_slots[i];
+        if (slot && strcmp(w->strings + slot - 1, name) == 0) return slot - 1;
+        if (slot) continue;
+        if (++w->num_groups > GROUP_SLOTS / 2) {
+            fprintf(stderr, "too many groups (max %d)\n", GROUP_SLOTS / 2);
+            exit(1);
+        }
+        size_t n = strlen(name) + 1;
+        if (w->strings_size + n > w->strings_cap) {
+            w->strings_cap = (w->strings_cap + n) * 2;
+            w->strings = xrealloc(w->strings, w->strings_cap);
+        }
+        memcpy(w->strings + w->strings_size, name, n);
+        w->group_slots[i] = (uint32_t)w->strings_size + 1;
+        w->strings_size += n;
+        return w->group_slots[i] - 1;
+    }
+}
+
+static wl_task_t *add_task(workload_t *w) {
+    if (w->num_tasks == w->cap_tasks) {
+        w->cap_tasks = w->cap_tasks ? w->cap_tasks * 2 : 1024;
+        w->tasks = xrealloc(w->tasks, w->cap_tasks * sizeof(wl_task_t));
+    }
+    wl_task_t *t = &w->tasks[w->num_tasks];
+    memset(t, 0, sizeof(*t));
+    t->line = (uint32_t)w->num_tasks++;
+    t->deps_first = (uint32_t)w->num_deps;
+    return t;
+}
+
+static void add_dep(workload_t *w, wl_task_t *t, long parent, const char *path, int line_no) {
+    if (parent < 0 || parent >= t->line) {
+        fprintf(stderr, "%s:%d: dependency on %ld must name an earlier task\n", path, line_no, parent);
+        exit(1);
+    }
+    for (uint32_t d = t->deps_first; d < t->deps_first + t->deps_count; d++) {
+        if (w->deps[d] == (uint32_t)parent) return;
+    }
+    if (w->num_deps == w->cap_deps) {
+        w->cap_deps = w->cap_deps ? w->cap_deps * 2 : 1024;
+        w->deps = xrealloc(w->deps, w->cap_deps * sizeof(uint32_t));
+    }
+    w->deps[w->num_deps++] = (uint32_t)parent;
+    t->deps_count++;
+}
+
+static int positive(const char *tok, int skip, uint32_t *out) {
+    char *end;
+    long v = strtol(tok + skip, &end, 10);
+    *out = (uint32_t)v;
+    return *end == '\0' && v > 0;
+}
+
+static int pair(const char *tok, int skip, uint32_t *a, uint32_t *b) {
+    int x, y;
+    if (sscanf(tok + skip, "%d:%d", &x, &y) != 2 || x <= 0 || y < 0) return 0;
+    *a = x;
+    *b = y;
+    return 1;
+}
+
+/* ---- text format ---- */
+
+// same rules and messages as the scheduler's load_workload_file()
+static void parse_text(workload_t *w, const char *path) {
+    FILE *fp = fopen(path, "r");
+    if (!fp) {
+        perror(path);
+        exit(1);
+    }
+    intern(w, "default");
+
+    char line[MAX_LINE_LEN];
+    int line_no = 0;
+    while (fgets(line, sizeof(line), fp)) {
+        line_no++;
+        char *hash = strchr(line, '#');
+        if (hash) *hash = '\0';
+
+        char *save;
+        char *tok = strtok_r(line, " \t\r\n", &save);
+        if (!tok) continue;
+
+        int fields[3];
+        for (int f = 0; f < 3; f++) {
+            char *end;
+            if (!tok) {
+                fprintf(stderr, "%s:%d: expected <arrival> <burst> <nice>\n", path, line_no);
+                exit(1);
+            }
+            fields[f] = (int)strtol(tok, &end, 10);
+            if (*end != '\0') {
+                fprintf(stderr, "%s:%d: bad number '%s'\n", path, line_no, tok);
+                exit(1);
+            }
+            tok = strtok_r(NULL, " \t\r\n", &save);
+        }
+        if (fields[0] < 0) {
+            fprintf(stderr, "%s:%d: arrival must not be negative\n", path, line_no);
+            exit(1);
+        }
+        if (fields[1] <= 0) {
+            fprintf(stderr, "%s:%d: burst must be positive\n", path, line_no);
+            exit(1);
+        }
+        if (fields[2] < -20 || fields[2] > 19) {
+            fprintf(stderr, "%s:%d: nice must be in -20..19\n", path, line_no);
+            exit(1);
+        }
+
+        wl_task_t *t = add_task(w);
+        t->arrival_ms = fields[0];
+        t->burst_ms = fields[1];
+        t->nice = fields[2];
+
+        for (; tok; tok = strtok_r(NULL, " \t\r\n", &save)) {
+            int ok = 1;
+            if (strncmp(tok, "deps=", 5) == 0) {
+                char *p = tok + 5;
+                while (*p) {
+                    char *end;
+                    long parent = strtol(p, &end, 10);
+                    if (end == p) {
+                        fprintf(stderr, "%s:%d: bad deps list '%s'\n", path, line_no, tok);
+                        exit(1);
+                    }
+                    add_dep(w, t, parent, path, line_no);
+                    p = (*end == ',') ? end + 1 : end;
+                }
+            } else if (strncmp(tok, "slo=", 4) == 0) {
+                t->slo_ms = (uint32_t)atoi(tok + 4);
+            } else if (strncmp(tok, "io=", 3) == 0) {
+                ok = pair(tok, 3, &t->io_run_ms, &t->io_sleep_ms);
+            } else if (strncmp(tok, "warm=", 5) == 0) {
+                ok = atoi(tok + 5) >= 0;
+                t->warm_ms = (uint32_t)atoi(tok + 5);
+            } else if (strncmp(tok, "lock=", 5) == 0) {
+                ok = pair(tok, 5, &t->lock_hold_ms, &t->lock_period_ms);
+            } else if (strncmp(tok, "disk=", 5) == 0) {
+                ok = positive(tok, 5, &t->disk_kb);
+            } else if (strncmp(tok, "mem=", 4) == 0) {
+                ok = positive(tok, 4, &t->mem_mb);
+            } else if (strncmp(tok, "group=", 6) == 0) {
+                t->group = intern(w, tok + 6);
+            } else {
+                fprintf(stderr, "%s:%d: unknown key '%s'\n", path, line_no, tok);
+                exit(1);
+            }
+            if (!ok) {
+                fprintf(stderr, "%s:%d: bad value '%s'\n", path, line_no, tok);
+                exit(1);
+            }
+        }
+        if (t->disk_kb > 0 && t->io_run_ms == 0) {
+            fprintf(stderr, "%s:%d: disk= needs io=\n", path, line_no);
+            exit(1);
+        }
+    }
+    fclose(fp);
+    if (w->num_tasks == 0) {
+        fprintf(stderr, "%s: no tasks\n", path);
+        exit(1);
+    }
+}
+
+static void print_text(const char *path) {
+    wl_view_t wl;
+    if (wl_open(path, &wl) < 0) {
+        fprintf(stderr, "%s: %s\n", path, errno == EPROTO ? "not a binary workload" : strerror(errno));
+        exit(1);
+    }
+    printf("# %llu tasks from %s, in release order\n", (unsigned long long)wl.hdr->num_tasks, path);
+    for (uint64_t i = 0; i < wl.hdr->num_tasks; i++) {
+        const wl_task_t *t = &wl.tasks[i];
+        printf("%u %u %d", t->arrival_ms, t->burst_ms, t->nice);
+        for (uint32_t d = 0; d < t->deps_count; d++) {
+            printf("%s%u", d ? "," : " deps=", wl.deps[t->deps_first + d]);
+        }
+        if (t->slo_ms) printf(" slo=%u", t->slo_ms);
+        if (t->io_run_ms) printf(" io=%u:%u", t->io_run_ms, t->io_sleep_ms);
+        if (t->warm_ms) printf(" warm=%u", t->warm_ms);
+        if (t->lock_hold_ms) printf(" lock=%u:%u", t->lock_hold_ms, t->lock_period_ms);
+        if (t->disk_kb) printf(" disk=%u", t->disk_kb);
+        if (t->mem_mb) printf(" mem=%u", t->mem_mb);
+        if (t->group) printf(" group=%s", wl_string(&wl, t->group));
+        printf("\n");
+    }
+    wl_close(&wl);
+}
+
+/* ---- binary format ---- */
+
+static const wl_task_t *sort_base;
+
+static int cmp_release(const void *a, const void *b) {
+    const wl_task_t *x = &sort_base[*(const uint32_t *)a], *y = &sort_base[*(const uint32_t *)b];
+    if (x->release_ms != y->release_ms) return x->release_ms < y->release_ms ? -1 : 1;
+    return x->line < y->line ? -1 : x->line > y->line;
+}
+
+static void put(FILE *fp, const void *p, size_t n, const char *path) {
+    static const char zeros[8];
+    if ((n && fwrite(p, 1, n, fp) != n) || fwrite(zeros, 1, -n & 7, fp) != (-n & 7)) {
+        perror(path);
+        exit(1);
+    }
+}
+
+// release times, stable sort by release, renumbering. a parent releases no
+// later than its child and precedes it in the text, so it stays ahead
+static void write_binary(workload_t *w, const char *path) {
+    size_t n = w->num_tasks;
+    int sorted = 1;
+    for (size_t i = 0; i < n; i++) {
+        wl_task_t *t = &w->tasks[i];
+        t->release_ms = t->arrival_ms;
+        for (uint32_t d = t->deps_first; d < t->deps_first + t->deps_count; d++) {
+            uint32_t parent = w->tasks[w->deps[d]].release_ms;
+            if (parent > t->release_ms) t->release_ms = parent;
+        }
+        if (i > 0 && t->release_ms < w->tasks[i - 1].release_ms) sorted = 0;
+    }
+
+    uint32_t *order = xrealloc(NULL, n * sizeof(uint32_t));
+    uint32_t *new_id = xrealloc(NULL, n * sizeof(uint32_t));
+    for (size_t i = 0; i < n; i++) order[i] = (uint32_t)i;
+    if (!sorted) {
+        sort_base = w->tasks;
+        qsort(order, n, sizeof(uint32_t), cmp_release);
+    }
+    for (size_t i = 0; i < n; i++) new_id[order[i]] = (uint32_t)i;
+
+    wl_task_t *out = xrealloc(NULL, n * sizeof(wl_task_t));
+    uint32_t *deps = xrealloc(NULL, (w->num_deps ? w->num_deps : 1) * sizeof(uint32_t));
+    size_t num_deps = 0;
+    for (size_t i = 0; i < n; i++) {
+        const wl_task_t *t = &w->tasks[order[i]];
+        out[i] = *t;
+        out[i].deps_first = (uint32_t)num_deps;
+        for (uint32_t d = t->deps_first; d < t->deps_first + t->deps_count; d++) {
+            deps[num_deps++] = new_id[w->deps[d]];
+        }
+    }
+
+    wl_hdr_t hdr = {0};
+    memcpy(hdr.magic, WL_MAGIC, sizeof(hdr.magic));
+    hdr.version = WL_VERSION;
+    hdr.record_size = sizeof(wl_task_t);
+    hdr.num_tasks = n;
+    hdr.tasks_offset = sizeof(hdr);
+    hdr.deps_offset = hdr.tasks_offset + n * sizeof(wl_task_t);
+    hdr.num_deps = num_deps;
+    hdr.strings_offset = hdr.deps_offset + (num_deps * sizeof(uint32_t) + 7) / 8 * 8;
+    hdr.strings_size = w->strings_size;
+
+    FILE *fp = fopen(path, "wb");
+    if (!fp) {
+        perror(path);
+        exit(1);
+    }
+    put(fp, &hdr, sizeof(hdr), path);
+    put(fp, out, n * sizeof(wl_task_t), path);
+    put(fp, deps, num_deps * sizeof(uint32_t), path);
+    put(fp, w->strings, w->strings_size, path);
+    if (fclose(fp) != 0) {
+        perror(path);
+        exit(1);
+    }
+    free(order);
+    free(new_id);
+    free(out);
+    free(deps);
+}
+
+static void free_workload(workload_t *w) {
+    free(w->tasks);
+    free(w->deps);
+    free(w->strings);
+    memset(w, 0, sizeof(*w));
+}
+
+/* ---- startup benchmark ---- */
+
+// what a loader does with each task: read every field once
+static uint64_t iterate(const wl_view_t *wl) {
+    uint64_t sum = 0;
+    for (uint64_t i = 0; i < wl->hdr->num_tasks; i++) {
+        const wl_task_t *t = &wl->tasks[i];
+        sum += t->arrival_ms + t->burst_ms + t->nice + t->slo_ms + t->io_run_ms + t->io_sleep_ms +
+               t->warm_ms + t->lock_hold_ms + t->mem_mb + t->deps_count + (uint8_t)*wl_string(wl, t->group);
+        for (uint32_t d = 0; d < t->deps_count; d++) sum += wl->deps[t->deps_first + d];
+    }
+    return sum;
+}
+
+static int benchmark(long tasks, const char *bin_path) {
+    char text_path[4096];
+    snprintf(text_path, sizeof(text_path), "%s.txt", bin_path);
+    FILE *fp = fopen(text_path, "w");
+    if (!fp) {
+        perror(text_path);
+        return 1;
+    }
+    // arrivals mostly increasing with jitter, a mix of the keyed features
+    srand(42);
+    for (long i = 0; i < tasks; i++) {
+        long arrival = i / 10 + rand() % 50;
+        fprintf(fp, "%ld %d %d", arrival, 1 + rand() % 200, rand() % 40 - 20);
+        if (i > 0 && rand() % 20 == 0) fprintf(fp, " deps=%ld", i - 1 - rand() % (i < 100 ? i : 100));
+        if (rand() % 10 == 0) fprintf(fp, " slo=%d", 5 + rand() % 50);
+        if (rand() % 10 == 0) fprintf(fp, " io=%d:%d", 1 + rand() % 20, rand() % 50);
+        if (rand() % 4 == 0) fprintf(fp, " group=tenant%d", rand() % BENCH_GROUPS);
+        fprintf(fp, "\n");
+    }
+    if (fclose(fp) != 0) {
+        perror(text_path);
+        return 1;
+    }
+
+    workload_t w = {0};
+    double t0 = now_s();
+    parse_text(&w, text_path);
+    double t1 = now_s();
+    write_binary(&w, bin_path);
+    double t2 = now_s();
+    free_workload(&w);
+
+    wl_view_t wl;
+    double t3 = now_s();
+    if (wl_open(bin_path, &wl) < 0) {
+        perror(bin_path);
+        return 1;
+    }
+    uint64_t sum = iterate(&wl);
+    double t4 = now_s();
+    size_t bin_size = wl.size;
+    wl_close(&wl);
+
+    struct stat st;
+    stat(text_path, &st);
+    printf("tasks            %ld\n", tasks);
+    printf("text             %.1f MB, parsed in %.3f s (%.1f M tasks/s)\n",
+           st.st_size / 1e6, t1 - t0, tasks / (t1 - t0) / 1e6);
+    printf("convert          sorted and written in %.3f s\n", t2 - t1);
+    printf("binary           %.1f MB, mapped and iterated in %.3f s (%.1f M tasks/s)\n",
+           bin_size / 1e6, t4 - t3, tasks / (t4 - t3) / 1e6);
+    printf("startup speedup  %.0fx  (checksum %llu)\n", (t1 - t0) / (t4 - t3), (unsigned long long)sum);
+    unlink(text_path);
+    unlink(bin_path);
+    return 0;
+}
+
+static void print_usage(const char *prog) {
+    fprintf(stderr,
+            "usage: %s [-o out] workload.txt\n"
+            "       %s -d workload.wl\n"
+            "       %s -B tasks [-o out]\n"
+            "  -o FILE  binary output (default: the input name with .wl)\n"
+            "  -d       print a binary workload in the text format, in release order\n"
+            "  -B N     time text parsing against the binary format on N synthetic tasks\n"
+            "           (writes FILE and FILE.txt, default wlbench.wl, and removes them)\n",
+            prog, prog, prog);
+}
+
+int main(int argc, char **argv) {
+    int opt, dump = 0;
+    long bench = 0;
+    const char *out = NULL;
+    while ((opt = getopt(argc, argv, "o:dB:h")) != -1) {
+        switch (opt) {
+        case 'o': out = optarg; break;
+        case 'd': dump = 1; break;
+        case 'B': bench = atol(optarg); break;
+        default:
+            print_usage(argv[0]);
+            return opt == 'h' ? 0 : 1;
+        }
+    }
+    if (bench > 0) return benchmark(bench, out ? out : "wlbench.wl");
+    if (optind != argc - 1 || bench < 0) {
+        print_usage(argv[0]);
+        return 1;
+    }
+    const char *path = argv[optind];
+    if (dump) {
+        print_text(path);
+        return 0;
+    }
+
+    char out_path[4096];
+    if (!out) {
+        const char *dot = strrchr(path, '.');
+        int stem = dot && !strchr(dot, '/') ? (int)(dot - path) : (int)strlen(path);
+        snprintf(out_path, sizeof(out_path), "%.*s.wl", stem, path);
+        out = out_path;
+    }
+    workload_t w = {0};
+    parse_text(&w, path);
+    write_binary(&w, out);
+    printf("%s: %zu tasks, %zu dependencies, %d groups\n", out, w.num_tasks, w.num_deps, w.num_groups);
+    free_workload(&w);
+    return 0;
+}